@@ -106,7 +106,7 @@ extern "C" {
  *  The most significant 2 bytes indicate the original Genivi library initialization IF version (major and minor version).
  *  The rest of the bytes indicate the patch version created over the original Genivi version.
 */
-#define  PERSIST_API_INTERFACE_VERSION   (0x01040200U) /* 1.3.3 over 1.4.0 */
+#define  PERSIST_API_INTERFACE_VERSION   (0x01040400U) /* 1.3.3 over 1.4.0 */
 
 /** \} */
 
@@ -271,6 +271,39 @@ int pclDeinitLibrary(void);
 int pclLifecycleSet(int shutdown);
 
 
+
+/**
+ * @brief information about a loaded resource configuration table, see ::pclSetRctLoadHook
+ */
+typedef struct _pclRctLoadInfo_s
+{
+   unsigned int ldbid;                       /// logical database id of the table: ::PCL_LDBID_LOCAL, ::PCL_LDBID_PUBLIC or the group id
+   unsigned int numResources;                /// number of resources in the in-memory index
+   unsigned int memSize;                     /// memory used by the in-memory index [bytes], 0 if the table is read resource by resource
+   unsigned int mapped;                      /// 1 if the index is a precompiled index file mapped read-only, 0 if created in memory
+   unsigned long long loadTimeUs;            /// time needed to open the table and to create the index [us]
+} pclRctLoadInfo_s;
+
+
+/**
+ * @brief instrumentation hook called when a resource configuration table has been loaded
+ *
+ * @param info information about the loaded table, only valid during the call
+ */
+typedef void (*pclRctLoadHook_t)(const pclRctLoadInfo_s* info);
+
+
+/**
+ * @brief set the instrumentation hook called when a resource configuration table has been loaded.
+ *        The hook is called by the thread accessing the table first, it can be set before ::pclInitLibrary.
+ *
+ * @param hook the hook, NULL to remove it
+ *
+ * @return 0
+ */
+int pclSetRctLoadHook(pclRctLoadHook_t hook);
+
+
 /** \} */
 
 #ifdef __cplusplus
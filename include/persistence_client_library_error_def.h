@@ -127,6 +127,8 @@ extern "C" {
 #define EPERS_NO_PLUGIN_VAR       (-46)
 /// requested handle is not valid. \since PCL v7.0.3
 #define EPERS_NO_REG_TO_PAS       (-47)
+/// asynchronous write queue is full
+#define EPERS_QUEUE_FULL          (-48)
 /// requested handle is not valid. \since PCL v7.0.3
 #define EPERS_INVALID_HANDLE     (-1000)
 
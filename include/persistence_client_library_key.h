@@ -40,7 +40,7 @@ extern "C" {
  * \{
  */
 
-#define  PERSIST_KEYVALUEAPI_INTERFACE_VERSION   (0x06010000U)
+#define  PERSIST_KEYVALUEAPI_INTERFACE_VERSION   (0x060A0000U)
 
 #include "persistence_client_library.h"
 
@@ -73,6 +73,94 @@ typedef struct _pclNotification_s
 
 
 
+/**
+* descriptor of one key of a batch read or write, see ::pclKeyReadBatch and ::pclKeyWriteBatch
+*/
+typedef struct _pclKeyBatchItem_s
+{
+   unsigned int ldbid;                       /// logical db id
+   const char * resource_id;                 /// resource id
+   unsigned int user_no;                     /// user id
+   unsigned int seat_no;                     /// seat id
+   unsigned char * buffer;                   /// buffer to read the data into or holding the data to write
+   int buffer_size;                          /// size of the buffer / number of bytes to write
+   int status;                               /// result: the bytes read/written or a negative error code
+} pclKeyBatchItem_s;
+
+
+
+/**
+* key returned by the key iterator, see ::pclKeyIterateNext
+*/
+typedef struct _pclKeyIterateItem_s
+{
+   const char * resource_id;                 /// resource id, valid until the next call of the iterator
+   unsigned char * value;                    /// value of the key within the value buffer, NULL if not read
+   int value_size;                           /// size of the value or a negative error code
+} pclKeyIterateItem_s;
+
+
+
+/**
+* statistics of the asynchronous key write queue, see ::pclKeyWriteAsyncGetStats
+*/
+typedef struct _pclKeyWriteAsyncStats_s
+{
+   unsigned int queueDepth;                  /// number of currently queued writes
+   unsigned int maxQueueDepth;               /// max number of queued writes
+   unsigned int queueSize;                   /// size of the queue
+   unsigned long long numCompleted;          /// number of completed writes
+   unsigned long long numFailed;             /// number of completed writes which failed
+   unsigned long long avgLatencyUs;          /// average time from queuing until completion [us]
+   unsigned long long maxLatencyUs;          /// max time from queuing until completion [us]
+} pclKeyWriteAsyncStats_s;
+
+
+
+/**
+* counters of the open databases, see ::pclKeyGetDbHandleStats
+*/
+typedef struct _pclKeyDbHandleStats_s
+{
+   unsigned int maxOpen;                     /// max number of open databases, 0 if not limited (environment variable PERS_CLIENT_LIB_MAX_OPEN_DB)
+   unsigned int numOpen;                     /// number of currently open databases
+   unsigned long long numOpened;             /// number of times a database has been opened
+   unsigned long long numEvicted;            /// number of times an idle database has been closed to stay within maxOpen
+} pclKeyDbHandleStats_s;
+
+
+
+/**
+* counters of the boot access manifest, see ::pclKeyGetBootManifestStats
+*/
+typedef struct _pclKeyBootManifestStats_s
+{
+   unsigned int windowSec;                   /// recording window after pclInitLibrary [s], 0 if disabled (environment variable PERS_CLIENT_LIB_BOOT_MANIFEST)
+   unsigned int numRecorded;                 /// number of keys read within the window, prefetched on the next start
+   unsigned int numPrefetched;               /// number of values prefetched from the manifest of the previous start
+   unsigned int numWasted;                   /// number of prefetched values which have not been read (yet)
+   unsigned long long numHits;               /// number of reads served from a prefetched value of the read cache
+   unsigned long long numMisses;             /// number of reads within the window not served from a prefetched value
+} pclKeyBootManifestStats_s;
+
+
+
+/**
+* counters of the change notifications, see ::pclKeyGetNotifyStats
+*/
+typedef struct _pclKeyNotifyStats_s
+{
+   unsigned int defaultWindowMs;             /// coalescing window of keys without own window [ms], 0 if disabled (environment variable PERS_CLIENT_LIB_NOTIFY_COALESCE)
+   unsigned int queueDepth;                  /// number of queued notifications not yet sent
+   unsigned int numPending;                  /// number of notifications held back until the end of their coalescing window
+   unsigned long long numQueued;             /// number of changes notified
+   unsigned long long numSent;               /// number of notifications sent, one signal per notification or within a batched signal
+   unsigned long long numSuppressed;         /// number of changes merged into a held back notification of the same key
+   unsigned long long numBatchSignals;       /// number of batched signals (environment variable PERS_CLIENT_LIB_NOTIFY_BATCH)
+} pclKeyNotifyStats_s;
+
+
+
 /** \} */
 
 
@@ -86,6 +174,17 @@ typedef struct _pclNotification_s
 typedef int(* pclChangeNotifyCallback_t)(pclNotification_s * notifyStruct);
 
 
+/** definition of the completion callback of an asynchronous write
+ *
+ * @param ldbid logical database ID
+ * @param resource_id the resource ID
+ * @param user_no  the user ID
+ * @param seat_no  the seat number
+ * @param result the result of the write, see ::pclKeyWriteData
+*/
+typedef void(* pclKeyWriteAsyncCallback_t)(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no, int result);
+
+
 /** \defgroup PCL_KEYVALUE functions Key-Value access
  * \{
  */
@@ -287,6 +386,54 @@ int pclKeyUnRegisterNotifyOnChange( unsigned int  ldbid, const char *  resource_
 
 
 
+/**
+ * @brief wait until the change notifications of all previous writes have been sent.
+ *
+ * Change notifications of shared data are queued and sent in the order of the writes,
+ * the write returns without waiting until the notification has been sent.
+ * Use this function if the notification must have been sent before continuing.
+ *
+ * @note must not be called from a notification callback
+ *
+ * @return positive value (0 or greater): success;
+ * On error a negative value will be returned with the following error codes: ::EPERS_NOT_INITIALIZED ::EPERS_COMMON
+ */
+int pclKeyNotificationFlush(void);
+
+
+
+/**
+ * @brief set the coalescing window of the change notifications of a resource or of a logical database.
+ *
+ * The first change of a key (ldbid, user, seat, resource) is notified at once. Further changes
+ * within the window are held back and notified with one signal carrying the latest status
+ * when the window ends. The window of a resource wins over the window of its logical database,
+ * which wins over the default window (environment variable PERS_CLIENT_LIB_NOTIFY_COALESCE [ms]).
+ * The windows are reset by ::pclDeinitLibrary.
+ *
+ * @param ldbid logical database ID
+ * @param resource_id the resource ID, NULL to set the window of the whole logical database
+ * @param windowMs the window [ms], 0 to notify every change
+ *
+ * @return positive value (0 or greater): success;
+ * On error a negative value will be returned with the following error codes: ::EPERS_NOT_INITIALIZED ::EPERS_COMMON
+ */
+int pclKeySetNotifyCoalescing(unsigned int ldbid, const char* resource_id, unsigned int windowMs);
+
+
+
+/**
+ * @brief get the counters of the change notifications
+ *
+ * @param stats the structure the counters will be stored in
+ *
+ * @return positive value (0 or greater): success;
+ * On error a negative value will be returned with the following error codes: ::EPERS_NOT_INITIALIZED ::EPERS_COMMON
+ */
+int pclKeyGetNotifyStats(pclKeyNotifyStats_s* stats);
+
+
+
 /**
  * @brief writes persistent data identified by ldbid and resource_id
  *
@@ -298,6 +445,9 @@ int pclKeyUnRegisterNotifyOnChange( unsigned int  ldbid, const char *  resource_
  * @param buffer_size the number of bytes to write (default max size is set to 16kB)
  *                    use environment variable PERS_MAX_KEY_VAL_DATA_SIZE to modify default size in bytes
  *
+ * @note with the environment variable PERS_CLIENT_LIB_SKIP_UNCHANGED=1 set, writing the same data
+ *       a local key has been written with before returns without writing and without change notification
+ *
  * @return positive value (0 or greater): the bytes written;
  * On error a negative value will be returned with the following error codes:
  * ::EPERS_LOCKFS ::EPERS_BADPOL ::EPERS_BUFLIMIT ::EPERS_DB_VALUE_SIZE ::EPERS_DB_KEY_SIZE
@@ -306,6 +456,250 @@ int pclKeyUnRegisterNotifyOnChange( unsigned int  ldbid, const char *  resource_
 int pclKeyWriteData(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no, unsigned char* buffer, int buffer_size);
 
 
+
+/**
+ * @brief start to iterate over the keys of a logical database, user and seat whose resource ID starts with a prefix
+ *
+ * @param ldbid logical database ID
+ * @param user_no  the user ID; user_no=0 can not be used as user-ID because ‘0’ is defined as System/node
+ * @param seat_no  the seat number
+ * @param prefix the resource ID prefix, NULL or "" for all keys
+ *
+ * @return positive value (0 or greater): the iterator handle;
+ * On error a negative value will be returned with the following error codes:
+ * ::EPERS_NOT_INITIALIZED ::EPERS_MAXHANDLE ::EPERS_SHUTDOWN_NO_TRUSTED ::EPERS_COMMON
+ */
+int pclKeyIterateBegin(unsigned int ldbid, unsigned int user_no, unsigned int seat_no, const char* prefix);
+
+
+
+/**
+ * @brief get the next chunk of matching keys
+ *
+ * The returned resource IDs are valid until the next call of the iterator.
+ * If a value buffer is passed, the values of the keys are read into it one after the other,
+ * a chunk ends early when the next value does not fit into the buffer.
+ *
+ * @param iterator iterator handle returned by ::pclKeyIterateBegin
+ * @param items array the keys will be stored in
+ * @param maxItems size of the items array (max 64 keys are returned at once)
+ * @param valueBuffer buffer the values will be read into, NULL if the values are not needed
+ * @param valueBufferSize size of the value buffer
+ *
+ * @return positive value (0 or greater): the number of keys returned, 0 if there are no more keys;
+ * On error a negative value will be returned with the following error codes:
+ * ::EPERS_NOT_INITIALIZED ::EPERS_MAXHANDLE ::EPERS_LOCKFS ::EPERS_NO_PLUGIN_FUNCT ::EPERS_COMMON
+ */
+int pclKeyIterateNext(int iterator, pclKeyIterateItem_s* items, unsigned int maxItems,
+                      unsigned char* valueBuffer, unsigned int valueBufferSize);
+
+
+
+/**
+ * @brief end the iteration and release the iterator
+ *
+ * @param iterator iterator handle returned by ::pclKeyIterateBegin
+ *
+ * @return positive value (0 or greater): success;
+ * On error a negative value will be returned with the following error codes: ::EPERS_NOT_INITIALIZED ::EPERS_MAXHANDLE
+ */
+int pclKeyIterateEnd(int iterator);
+
+
+
+/**
+ * @brief writes persistent data identified by ldbid and resource_id asynchronously
+ *
+ * The data is copied into a queue and the function returns immediately.
+ * The queued writes are written by a worker thread in the order they have been queued.
+ * The result of each write is reported by the callback (called from the worker thread)
+ * and completed writes are signaled by the file descriptor returned by ::pclKeyWriteAsyncGetFd.
+ *
+ * @param ldbid logical database ID
+ * @param resource_id the resource ID
+ * @param user_no  the user ID; user_no=0 can not be used as user-ID because ‘0’ is defined as System/node
+ * @param seat_no  the seat number
+ * @param buffer the buffer containing the persistent data to write
+ * @param buffer_size the number of bytes to write
+ * @param callback completion callback, may be NULL
+ *
+ * @return positive value (0 or greater): the bytes queued;
+ * On error a negative value will be returned with the following error codes:
+ * ::EPERS_NOT_INITIALIZED ::EPERS_BUFLIMIT ::EPERS_QUEUE_FULL ::EPERS_COMMON
+ */
+int pclKeyWriteDataAsync(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no,
+                         unsigned char* buffer, int buffer_size, pclKeyWriteAsyncCallback_t callback);
+
+
+
+/**
+ * @brief wait until all asynchronous writes queued so far have been written
+ *
+ * @note must not be called from a completion callback
+ *
+ * @return positive value (0 or greater): success;
+ * On error a negative value will be returned with the following error codes: ::EPERS_NOT_INITIALIZED ::EPERS_COMMON
+ */
+int pclKeyWriteAsyncFlush(void);
+
+
+
+/**
+ * @brief get a pollable file descriptor (eventfd) signaling completed asynchronous writes,
+ *        reading from it returns the number of writes completed since the last read
+ *
+ * @return positive value (0 or greater): the file descriptor;
+ * On error a negative value will be returned with the following error codes: ::EPERS_NOT_INITIALIZED ::EPERS_COMMON
+ */
+int pclKeyWriteAsyncGetFd(void);
+
+
+
+/**
+ * @brief get the statistics of the asynchronous write queue
+ *
+ * @param stats the structure the statistics will be stored in
+ *
+ * @return positive value (0 or greater): success;
+ * On error a negative value will be returned with the following error codes: ::EPERS_NOT_INITIALIZED ::EPERS_COMMON
+ */
+int pclKeyWriteAsyncGetStats(pclKeyWriteAsyncStats_s* stats);
+
+
+
+/**
+ * @brief get the counters of the open databases.
+ *        Databases not used for a while are closed when more than maxOpen databases are needed,
+ *        they will be opened again on the next access.
+ *        A database stays open as long as a key handle refers to it.
+ *
+ * @param stats the structure the counters will be stored in
+ *
+ * @return positive value (0 or greater): success;
+ * On error a negative value will be returned with the following error codes: ::EPERS_NOT_INITIALIZED ::EPERS_COMMON
+ */
+int pclKeyGetDbHandleStats(pclKeyDbHandleStats_s* stats);
+
+
+
+/**
+ * @brief get the counters of the boot access manifest.
+ *        The keys read within the first seconds after pclInitLibrary are recorded and their values
+ *        are prefetched in the background into the read cache on the next start (environment variable
+ *        PERS_CLIENT_LIB_READ_CACHE). A read of a prefetched value is counted as a hit once.
+ *
+ * @param stats the structure the counters will be stored in
+ *
+ * @return positive value (0 or greater): success;
+ * On error a negative value will be returned with the following error codes: ::EPERS_NOT_INITIALIZED ::EPERS_COMMON
+ */
+int pclKeyGetBootManifestStats(pclKeyBootManifestStats_s* stats);
+
+
+
+/**
+ * @brief reads the persistent data of several keys at once
+ *
+ * The keys are resolved and grouped by database, the access to each database is locked only once.
+ * The result of each key is returned in the status member of the item: the bytes read
+ * or one of the error codes of ::pclKeyReadData.
+ *
+ * @param items array of key descriptors
+ * @param numItems number of key descriptors
+ *
+ * @return positive value (0 or greater): the number of keys successfully read;
+ * On error a negative value will be returned with the following error codes:
+ * ::EPERS_LOCKFS ::EPERS_NOT_INITIALIZED ::EPERS_SHUTDOWN_NO_TRUSTED ::EPERS_COMMON
+ */
+int pclKeyReadBatch(pclKeyBatchItem_s* items, unsigned int numItems);
+
+
+
+/**
+ * @brief writes the persistent data of several keys at once
+ *
+ * The keys are resolved and grouped by database, the access to each database is locked only once.
+ * The change notifications of all written shared keys are sent at once after the data has been written.
+ * The result of each key is returned in the status member of the item: the bytes written
+ * or one of the error codes of ::pclKeyWriteData.
+ *
+ * @param items array of key descriptors
+ * @param numItems number of key descriptors
+ *
+ * @return positive value (0 or greater): the number of keys successfully written;
+ * On error a negative value will be returned with the following error codes:
+ * ::EPERS_LOCKFS ::EPERS_NOT_INITIALIZED ::EPERS_SHUTDOWN_NO_TRUSTED ::EPERS_COMMON
+ */
+int pclKeyWriteBatch(pclKeyBatchItem_s* items, unsigned int numItems);
+
+
+
+/**
+ * @brief begin a key transaction
+ *
+ * A transaction is scoped to one database: all keys written within the transaction
+ * must be stored in the same database, this is the database of the first written key.
+ * The data is staged in memory and written with ::pclKeyTransactionCommit;
+ * write through databases are synced only once for all keys of the transaction.
+ *
+ * @param ldbid logical database ID
+ * @param user_no  the user ID; user_no=0 can not be used as user-ID because ‘0’ is defined as System/node
+ * @param seat_no  the seat number
+ *
+ * @return positive value (0 or greater): the transaction handle;
+ * On error a negative value will be returned with the following error codes:
+ * ::EPERS_NOT_INITIALIZED ::EPERS_MAXHANDLE ::EPERS_SHUTDOWN_NO_TRUSTED
+ */
+int pclKeyTransactionBegin(unsigned int ldbid, unsigned int user_no, unsigned int seat_no);
+
+
+
+/**
+ * @brief stage persistent data of a key in a transaction, the data will be written on commit
+ *
+ * @param transaction transaction handle returned by ::pclKeyTransactionBegin
+ * @param resource_id the resource ID
+ * @param buffer the buffer containing the persistent data to write
+ * @param buffer_size the number of bytes to write
+ *
+ * @return positive value (0 or greater): the bytes staged;
+ * On error a negative value will be returned with the following error codes:
+ * ::EPERS_NOT_INITIALIZED ::EPERS_MAXHANDLE ::EPERS_BADPOL (key not in the database of the transaction)
+ * ::EPERS_BUFLIMIT ::EPERS_RESOURCE_READ_ONLY ::EPERS_NOT_RESP_APP ::EPERS_COMMON
+ */
+int pclKeyTransactionWrite(int transaction, const char* resource_id, unsigned char* buffer, int buffer_size);
+
+
+
+/**
+ * @brief commit a transaction: write all staged keys at once,
+ *        the change notifications are sent after all keys have been written
+ *
+ * The keys are written in the order they have been staged. Writing stops at the first key
+ * which can't be written, the keys staged before it have been applied and are notified.
+ *
+ * @param transaction transaction handle returned by ::pclKeyTransactionBegin
+ *
+ * @return positive value (0 or greater): the number of keys written;
+ * On error a negative value will be returned with the following error codes:
+ * ::EPERS_NOT_INITIALIZED ::EPERS_MAXHANDLE ::EPERS_LOCKFS ::EPERS_NOTIFY_SIG ::EPERS_NOPRCTABLE ::EPERS_COMMON
+ */
+int pclKeyTransactionCommit(int transaction);
+
+
+
+/**
+ * @brief abort a transaction, the staged data will be discarded
+ *
+ * @param transaction transaction handle returned by ::pclKeyTransactionBegin
+ *
+ * @return positive value (0 or greater): success;
+ * On error a negative value will be returned with the following error codes:
+ * ::EPERS_NOT_INITIALIZED ::EPERS_MAXHANDLE
+ */
+int pclKeyTransactionAbort(int transaction);
+
+
 /** \} */
 
 #ifdef __cplusplus
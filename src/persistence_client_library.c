@@ -25,7 +25,12 @@
 #include "persistence_client_library.h"
 #include "persistence_client_library_backup_filelist.h"
 #include "persistence_client_library_db_access.h"
+#include "persistence_client_library_key_async.h"
+#include "persistence_client_library_notify_queue.h"
+#include "persistence_client_library_prewarm.h"
+#include "persistence_client_library_key_manifest.h"
 #include "persistence_client_library_dbus_cmd.h"
+#include "persistence_client_library_prct_access.h"
 
 #if USE_FILECACHE
    #include <persistence_file_cache.h>
@@ -255,6 +260,11 @@ static int private_pclInitLibrary(const char* appName, int shutdownMode)
 
    gShutdownMode = shutdownMode;
 
+   persistence_init_unchanged_write_detection();
+   persistence_init_db_handle_limit();
+   persistence_init_read_cache();
+   notify_queue_init();
+
 #if USE_FSYNC
    DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("Using fsync version"));
 #else
@@ -301,6 +311,7 @@ static int private_pclInitLibrary(const char* appName, int shutdownMode)
 
    strncpy(gAppId, appName, PERS_RCT_MAX_LENGTH_RESPONSIBLE);  // assign application name
    gAppId[PERS_RCT_MAX_LENGTH_RESPONSIBLE-1] = '\0';
+   invalidate_path_templates();      // the database paths contain the application name
 
    if(strcmp(appName, gNsmAppId)  != 0)   // check for NodeStateManager
    {
@@ -351,8 +362,12 @@ static int private_pclInitLibrary(const char* appName, int shutdownMode)
    doInitAppcheck(appName);      // check if we have a trusted application
 #endif
 
+   prewarm_start(appName);       // open the databases needed soon in the background
+
    pers_unlock_access();
 
+   key_manifest_start(appName);  // prefetch the keys read during the last start
+
    return rval;
 }
 
@@ -402,6 +417,11 @@ static int private_pclDeinitLibrary(void)
 
    MainLoopData_u data;
 
+   key_async_deinit();     // write queued data while the dbus mainloop is still running
+   notify_queue_deinit();  // send the queued change notifications of these writes
+   prewarm_deinit();
+   key_manifest_deinit();
+
    if(gShutdownMode != PCL_SHUTDOWN_TYPE_NONE)  // unregister for lifecycle dbus messages
    {
       rval = unregister_lifecycle(gShutdownMode);
@@ -436,6 +456,7 @@ static int private_pclDeinitLibrary(void)
 
    pthread_join(gMainLoopThread, (void**)&retval);    // wait until the dbus mainloop has ended
 
+   database_free_all();                               // the databases have been closed by the mainloop
    deleteHandleTrees();                               // delete allocated trees
    deleteBackupTree();
    deleteNotifyTree();
@@ -381,6 +381,16 @@ int load_default_library(void* handle)
       {
          DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("load_default_library - error:"), DLT_STRING(error));
       }
+      *(void **) (&plugin_persComRctGetSizeResourcesList) = dlsym(handle, "persComRctGetSizeResourcesList");
+      if ((error = dlerror()) != NULL)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("load_default_library - error:"), DLT_STRING(error));
+      }
+      *(void **) (&plugin_persComRctGetResourcesList) = dlsym(handle, "persComRctGetResourcesList");
+      if ((error = dlerror()) != NULL)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("load_default_library - error:"), DLT_STRING(error));
+      }
 
       /// V A R I A B L E S
       // it is an error if varaibles coulr not be loaded, and will cause an error
@@ -139,6 +139,12 @@ signed int (*plugin_persComRctClose)(signed int handlerRCT) ;
 /// read a resourceID's configuration from RCT
 signed int (*plugin_persComRctRead)(signed int handlerRCT, char const * resourceID, PersistenceConfigurationKey_s const * psConfig_out) ;
 
+/// Find the buffer's size needed to accomodate the list of resourceIDs in RCT
+signed int (*plugin_persComRctGetSizeResourcesList)(signed int handlerRCT) ;
+
+/// Obtain the list of resourceIDs in RCT
+signed int (*plugin_persComRctGetResourcesList)(signed int handlerRCT, char* listBuffer_out, signed int listBufferSize) ;
+
 
 /**
  * @brief definition of async init callback function.
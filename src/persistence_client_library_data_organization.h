@@ -148,12 +148,34 @@ enum _PersistenceConstantDef
    DbusMatchRuleSize       = 300,
    /// persistence resource config table max value size
    PrctValueSize           = sizeof(PersistenceConfigurationKey_s),
-   /// number of persistence resource config tables to store
+   /// number of persistence resource config tables to store (combinations of table type and group, power of 2)
    PrctDbTableSize         = 1024,
+   /// identifies a resource configuration table index ("PRIX")
+   RctIndexMagic           = 0x58495250,
+   /// version of the resource configuration table index layout
+   RctIndexVersion         = 2,
+   /// number of seeds tried per bucket when the resource configuration table index is created
+   RctIndexMaxSeeds        = 65536,
    /// write buffer size
    RDRWBufferSize          = 1024,
-   /// database table size
-   DbTableSize             = 1024,
+   /// initial number of slots of the open database map (must be a power of 2)
+   DbHandleMapInitialSize  = 64,
+   /// default max number of open databases, idle databases are closed when more are needed (0: no limit)
+   DbMaxOpenDefault        = 128,
+   /// pin count of a database which is not open
+   DbHandleClosed          = -1,
+   /// pin count of a database which is being opened
+   DbHandleOpening         = -2,
+   /// max time closing all databases waits for the pins of running calls to be released [ms]
+   DbCloseWaitMs           = 1000,
+   /// number of threads opening databases in parallel at startup
+   PrewarmThreads          = 4,
+   /// max number of databases remembered for the next startup
+   PrewarmMaxEntries       = 64,
+   /// max number of keys recorded in the boot access manifest
+   BootManifestMaxEntries  = 512,
+   /// number of slots of the boot access manifest tables (must be a power of 2, at least twice BootManifestMaxEntries)
+   BootManifestTableSize   = 1024,
    /// persistence administration service block access
    PasMsg_Block            = 0x0001,
    /// persistence administration service unblock access
@@ -168,6 +190,51 @@ enum _PersistenceConstantDef
    PasErrorStatus_FAIL     = 0x8000,
    /// max number of parallel open persistence handles
    MaxPersHandle = 512,
+   /// number of reader/writer locks the key API access is sharded into
+   KeyApiLockShards        = 16,
+   /// number of entries of the resolved resource cache (must be a power of 2)
+   ResolvedCacheSize       = 128,
+   /// number of entries of the thread local resolved resource cache of every thread (must be a power of 2)
+   TlsResolvedCacheSize    = 8,
+   /// number of entries of the cache of resources missing in the resource configuration table (must be a power of 2)
+   NegativeCacheSize       = 256,
+   /// min interval between two logged resource configuration table misses [s]
+   RctMissLogInterval      = 10,
+   /// number of entries of the written data hash cache (must be a power of 2)
+   WriteHashCacheSize      = 512,
+   /// number of hash buckets of the read cache (must be a power of 2)
+   ReadCacheBuckets        = 512,
+   /// max number of parallel open key transactions
+   MaxKeyTransactions      = 16,
+   /// number of entries of the asynchronous key write queue
+   AsyncWriteQueueSize     = 256,
+   /// data up to this size is stored in the asynchronous key write queue without allocation
+   AsyncWriteInlineSize    = 256,
+   /// max time the shutdown waits for the queued asynchronous key writes [ms]
+   AsyncFlushWaitMs        = 1000,
+   /// number of commands of the dbus mainloop command ring (must be a power of 2)
+   MainLoopRingSize        = 512,
+   /// first and max sleep of a producer waiting for a free slot of the full command ring [us]
+   MainLoopRingWaitMinUs   = 50,
+   MainLoopRingWaitMaxUs   = 2000,
+   /// max number of events handled per wake-up of the dbus mainloop
+   MainLoopEpollEvents     = 16,
+   /// initial number of entries of the dbus mainloop timer heap, grows on demand
+   MainLoopTimerHeapSize   = 8,
+   /// number of entries of the change notification queue
+   NotifyQueueSize         = 256,
+   /// number of keys whose last notification is remembered for coalescing (must be a power of 2)
+   NotifyCoalesceSize      = 256,
+   /// max number of coalescing windows set with pclKeySetNotifyCoalescing
+   MaxNotifyWindows        = 32,
+   /// max number of parallel open key iterators
+   MaxKeyIterators         = 16,
+   /// max number of keys returned by one call of the key iterator
+   MaxKeyIterateChunk      = 64,
+   /// number of bits per key of the default database key filters
+   KeyFilterBitsPerKey     = 16,
+   /// number of hash functions of the default database key filters
+   KeyFilterNumHashes      = 7,
    /// length of the config key responsible name
    MaxConfKeyLengthResp    = 32,
    /// length of the config key custom name
@@ -22,6 +22,8 @@
 #include "persistence_client_library_dbus_service.h"
 #include "persistence_client_library_prct_access.h"
 #include "persistence_client_library_tree_helper.h"
+#include "persistence_client_library_prewarm.h"
+#include "persistence_client_library_notify_queue.h"
 #include "crc32.h"
 
 #include <persComErrors.h>
@@ -33,13 +35,170 @@ DLT_IMPORT_CONTEXT(gPclDLTContext);
 
 
 
-/// btree array
-static int gHandlesDB[DbTableSize][PersistenceDB_LastEntry];
-static int gHandlesDBCreated[DbTableSize][PersistenceDB_LastEntry] = { {0} };
+/// Bloom filter over the keys of a default database
+typedef struct _PersKeyFilter_s
+{
+   /// number of bits - 1 (number of bits is a power of 2)
+   unsigned int mask;
+   /// the filter bits
+   unsigned char bits[];
+} PersKeyFilter_s;
+
+/// database known to the handle map, the entry stays in the map when the database is evicted
+typedef struct _PersDbHandle_s
+{
+   /// hash of storage, ldbid, database type and path
+   unsigned int hash;
+   /// storage type
+   unsigned int storage;
+   /// logical database id
+   unsigned int ldbid;
+   /// database type (policy or default database)
+   int dbType;
+   /// the database handle, only valid while the entry is pinned
+   int handle;
+   /// companion handle of a write through database opened in cached mode to commit transactions,
+   /// -1 if not open; only used while the key access lock of the database is write locked
+   int txHandle;
+   /// number of pins (users of the handle), DbHandleClosed if the database is not open, DbHandleOpening while it is opened
+   volatile int users;
+   /// number of the pins held by key handles and iterators (gDbOpenMtx must be locked), dropped when the databases are closed
+   int keyHandles;
+   /// set on access, cleared by the eviction (second chance)
+   volatile int referenced;
+   /// flag to indicate if the use of the database has been recorded for the prewarm of the next run
+   int recorded;
+   /// key filter of a default database, NULL if not available
+   PersKeyFilter_s* filter;
+   /// database path
+   char dbPath[];
+} PersDbHandle_s;
+
+/// hash map of the open databases (open addressing, linear probing)
+typedef struct _PersDbHandleMap_s
+{
+   /// number of slots - 1 (number of slots is a power of 2)
+   unsigned int mask;
+   /// number of used slots
+   unsigned int count;
+   /// the map this map has replaced when growing, lookups may still read it until the library is deinitialized
+   struct _PersDbHandleMap_s* retired;
+   /// the slots
+   PersDbHandle_s* volatile slot[];
+} PersDbHandleMap_s;
+
+/// the open databases, NULL if no database has been opened
+static PersDbHandleMap_s* gDbHandleMap = NULL;
+/// protects changes of the handle map, lookup of already open databases is lock free
+static pthread_mutex_t gDbOpenMtx = PTHREAD_MUTEX_INITIALIZER;
+/// signaled when a database has been opened (or failed to open)
+static pthread_cond_t gDbOpenCond = PTHREAD_COND_INITIALIZER;
+/// number of databases currently being opened (gDbOpenMtx is not held while opening)
+static unsigned int gDbNumOpening = 0;
+/// database generation, incremented every time the open databases are closed
+static unsigned int gDbGeneration = 0;
+
+/// max number of open databases, 0 if not limited
+static unsigned int gDbMaxOpen = DbMaxOpenDefault;
+/// number of open databases
+static unsigned int gDbNumOpen = 0;
+/// number of opened and evicted databases
+static unsigned long long gDbNumOpened = 0, gDbNumEvicted = 0;
+/// next slot of the handle map to be checked by the eviction
+static unsigned int gDbEvictHand = 0;
 
 /// tree to store notification information
 static jsw_rbtree_t *gNotificationTree = NULL;
 
+/// entry of the written data hash cache, used to detect writes of unchanged data
+typedef struct _PersWriteHash_s
+{
+   /// flag to indicate if the entry is valid
+   int valid;
+   /// database type (policy or default database)
+   int dbType;
+   /// hash of the database path
+   unsigned int pathHash;
+   /// size of the data last written
+   int size;
+   /// hash of the data last written
+   unsigned int dataHash;
+   /// database key
+   char key[PERS_DB_MAX_LENGTH_KEY_NAME];
+} PersWriteHash_s;
+
+/// flag to indicate if writes of unchanged data will be skipped
+static int gSkipUnchangedWrites = 0;
+/// hash of the data written last per key
+static PersWriteHash_s gWriteHash[WriteHashCacheSize];
+/// protects the written data hash cache
+static pthread_mutex_t gWriteHashMtx = PTHREAD_MUTEX_INITIALIZER;
+
+/// cached value of a key
+typedef struct _PersReadCacheEntry_s
+{
+   /// next entry of the hash bucket
+   struct _PersReadCacheEntry_s* next;
+   /// more recently used entry
+   struct _PersReadCacheEntry_s* lruPrev;
+   /// less recently used entry
+   struct _PersReadCacheEntry_s* lruNext;
+   /// hash of database path, database type and key
+   unsigned int hash;
+   /// database type (policy)
+   int dbType;
+   /// flag to indicate if the key is a shared key
+   int shared;
+   /// flag to indicate that the value has been prefetched and not been read yet
+   int prefetched;
+   /// logical database id
+   unsigned int ldbid;
+   /// memory used by the entry
+   size_t cost;
+   /// size of the value
+   int size;
+   /// database key, stored behind the database path
+   char* key;
+   /// resource id, stored behind the database key
+   char* resource_id;
+   /// the value, stored behind the resource id
+   unsigned char* data;
+   /// database path
+   char name[];
+} PersReadCacheEntry_s;
+
+/// shared key this process is notified about
+typedef struct _PersReadCacheWatch_s
+{
+   /// next watched key
+   struct _PersReadCacheWatch_s* next;
+   /// logical database id
+   unsigned int ldbid;
+   /// user number
+   unsigned int user_no;
+   /// seat number
+   unsigned int seat_no;
+   /// resource id
+   char resource_id[PERS_DB_MAX_LENGTH_KEY_NAME];
+} PersReadCacheWatch_s;
+
+/// max memory used by the read cache [bytes], 0 if the read cache is disabled
+static size_t gReadCacheLimit = 0;
+/// memory used by the read cache [bytes]
+static size_t gReadCacheUsed = 0;
+/// the cached values (hash buckets)
+static PersReadCacheEntry_s* gReadCache[ReadCacheBuckets] = {NULL};
+/// most and least recently used cached values
+static PersReadCacheEntry_s *gReadCacheLruHead = NULL, *gReadCacheLruTail = NULL;
+/// shared keys this process is notified about
+static PersReadCacheWatch_s* gReadCacheWatches = NULL;
+/// protects the read cache
+static pthread_mutex_t gReadCacheMtx = PTHREAD_MUTEX_INITIALIZER;
+/// set while the calling thread prefetches values
+static __thread int gReadCachePrefetching = 0;
+/// set if the last value the calling thread got from the read cache has been prefetched
+static __thread int gReadCachePrefetchHit = 0;
+
 
 void deleteNotifyTree(void)
 {
@@ -48,98 +207,1131 @@ void deleteNotifyTree(void)
       jsw_rbdelete(gNotificationTree);
       gNotificationTree = NULL;
    }
+
+   pthread_mutex_lock(&gReadCacheMtx);
+   while(gReadCacheWatches != NULL)
+   {
+      PersReadCacheWatch_s* watch = gReadCacheWatches;
+      gReadCacheWatches = watch->next;
+      free(watch);
+   }
+   pthread_mutex_unlock(&gReadCacheMtx);
 }
 
 
-static int database_get(PersistenceInfo_s* info, const char* dbPath, int dbType)
+/**
+ * @brief get the written data hash cache entry of a key
+ *
+ * @param dbPath the database location path
+ * @param dbType the database type
+ * @param key the database key
+ * @param pathHash returns the hash of the database path
+ *
+ * @return the cache entry the key is mapped to
+ */
+static PersWriteHash_s* get_write_hash_entry(const char* dbPath, int dbType, const char* key, unsigned int* pathHash)
 {
-   unsigned int arrayIdx = 0;
-   int handleDB = -1;
+   unsigned int hash = pclCrc32(0, (const unsigned char*)dbPath, strlen(dbPath));
+
+   *pathHash = hash;
+   hash = pclCrc32(hash, (const unsigned char*)key, strlen(key)) + (unsigned int)dbType;
+
+   return &gWriteHash[hash & (WriteHashCacheSize-1)];
+}
 
-   // create array index: index is a combination of resource configuration table type and group
-   arrayIdx = info->configKey.storage + info->context.ldbid ;
 
-   if(arrayIdx < DbTableSize)
+
+/**
+ * @brief check if the data to write is identical to the data written last to the key
+ *
+ * @return 1 if the data is unchanged; 0 if not or if it is unknown
+ */
+static int write_hash_unchanged(const char* dbPath, int dbType, const char* key, const unsigned char* buffer, int buffer_size)
+{
+   int rval = 0;
+   unsigned int pathHash = 0;
+   PersWriteHash_s* entry = get_write_hash_entry(dbPath, dbType, key, &pathHash);
+   unsigned int dataHash = pclCrc32(0, buffer, (size_t)buffer_size);
+
+   pthread_mutex_lock(&gWriteHashMtx);
+   if(   (entry->valid != 0)
+      && (entry->dbType == dbType)
+      && (entry->pathHash == pathHash)
+      && (entry->size == buffer_size)
+      && (entry->dataHash == dataHash)
+      && (0 == strncmp(entry->key, key, PERS_DB_MAX_LENGTH_KEY_NAME)) )
    {
-      unsigned char openFlags = 0x01;   // by default create file if not existing
+      rval = 1;
+   }
+   pthread_mutex_unlock(&gWriteHashMtx);
+
+   return rval;
+}
 
-      if(gHandlesDBCreated[arrayIdx][dbType] == 0)
+
+
+/**
+ * @brief remember the hash of the data written to a key, or forget it if buffer is NULL
+ */
+static void write_hash_update(const char* dbPath, int dbType, const char* key, const unsigned char* buffer, int buffer_size)
+{
+   if(gSkipUnchangedWrites != 0)
+   {
+      unsigned int pathHash = 0;
+      PersWriteHash_s* entry = get_write_hash_entry(dbPath, dbType, key, &pathHash);
+      unsigned int dataHash = (buffer != NULL) ? pclCrc32(0, buffer, (size_t)buffer_size) : 0;
+
+      pthread_mutex_lock(&gWriteHashMtx);
+      if(buffer != NULL)
       {
-         char path[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+         entry->valid    = 1;
+         entry->dbType   = dbType;
+         entry->pathHash = pathHash;
+         entry->size     = buffer_size;
+         entry->dataHash = dataHash;
+         strncpy(entry->key, key, PERS_DB_MAX_LENGTH_KEY_NAME-1);
+         entry->key[PERS_DB_MAX_LENGTH_KEY_NAME-1] = '\0';
+      }
+      else if(   (entry->dbType == dbType)
+              && (entry->pathHash == pathHash)
+              && (0 == strncmp(entry->key, key, PERS_DB_MAX_LENGTH_KEY_NAME)) )
+      {
+         entry->valid = 0;
+      }
+      pthread_mutex_unlock(&gWriteHashMtx);
+   }
+}
+
+
+
+void persistence_init_unchanged_write_detection(void)
+{
+   const char* skipUnchanged = getenv("PERS_CLIENT_LIB_SKIP_UNCHANGED");
+
+   gSkipUnchangedWrites = (skipUnchanged != NULL && atoi(skipUnchanged) != 0) ? 1 : 0;
+   persistence_invalidate_write_hash();
+
+   if(gSkipUnchangedWrites != 0)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("initUnchangedWrite - writes of unchanged data will be skipped"));
+   }
+}
+
 
-         if(PersistencePolicy_wt == dbType)				/// write through database
+
+void persistence_invalidate_write_hash(void)
+{
+   pthread_mutex_lock(&gWriteHashMtx);
+   memset(gWriteHash, 0, sizeof(gWriteHash));
+   pthread_mutex_unlock(&gWriteHashMtx);
+}
+
+
+
+int persistence_data_unchanged(char* dbPath, char* key, const char* resource_id, PersistenceInfo_s* info, unsigned char* buffer, int buffer_size)
+{
+   int rval = 0;
+
+   // shared keys can be changed by other applications, only the local value is known to this process
+   if(   (gSkipUnchangedWrites != 0)
+      && (PersistenceStorage_local == info->configKey.storage) )
+   {
+      if(info->context.user_no ==  (int)PCL_USER_DEFAULTDATA)
+      {
+         rval = write_hash_unchanged(dbPath, PersistenceDB_confdefault, resource_id, buffer, buffer_size);
+      }
+      else
+      {
+         rval = write_hash_unchanged(dbPath, info->configKey.policy, key, buffer, buffer_size);
+      }
+   }
+
+   return rval;
+}
+
+
+
+/**
+ * @brief get the hash of a read cache key
+ */
+static unsigned int read_cache_hash(const char* dbPath, int dbType, const char* key)
+{
+   unsigned int hash = pclCrc32(0, (const unsigned char*)dbPath, strlen(dbPath));
+
+   return pclCrc32(hash, (const unsigned char*)key, strlen(key)) + (unsigned int)dbType;
+}
+
+
+
+/**
+ * @brief find a value in the read cache, gReadCacheMtx must be locked
+ *
+ * @return the entry or NULL if the value is not cached
+ */
+static PersReadCacheEntry_s* read_cache_find(unsigned int hash, const char* dbPath, int dbType, const char* key)
+{
+   PersReadCacheEntry_s* entry = gReadCache[hash & (ReadCacheBuckets-1)];
+
+   while(entry != NULL)
+   {
+      if(   entry->hash == hash && entry->dbType == dbType
+         && strcmp(entry->key, key) == 0 && strcmp(entry->name, dbPath) == 0)
+      {
+         break;
+      }
+      entry = entry->next;
+   }
+
+   return entry;
+}
+
+
+
+static void read_cache_lru_unlink(PersReadCacheEntry_s* entry)
+{
+   if(entry->lruPrev != NULL)
+   {
+      entry->lruPrev->lruNext = entry->lruNext;
+   }
+   else
+   {
+      gReadCacheLruHead = entry->lruNext;
+   }
+
+   if(entry->lruNext != NULL)
+   {
+      entry->lruNext->lruPrev = entry->lruPrev;
+   }
+   else
+   {
+      gReadCacheLruTail = entry->lruPrev;
+   }
+}
+
+
+
+static void read_cache_lru_push(PersReadCacheEntry_s* entry)
+{
+   entry->lruPrev = NULL;
+   entry->lruNext = gReadCacheLruHead;
+   if(gReadCacheLruHead != NULL)
+   {
+      gReadCacheLruHead->lruPrev = entry;
+   }
+   gReadCacheLruHead = entry;
+   if(gReadCacheLruTail == NULL)
+   {
+      gReadCacheLruTail = entry;
+   }
+}
+
+
+
+/**
+ * @brief remove an entry from the read cache and free it, gReadCacheMtx must be locked
+ */
+static void read_cache_free(PersReadCacheEntry_s* entry)
+{
+   PersReadCacheEntry_s** link = &gReadCache[entry->hash & (ReadCacheBuckets-1)];
+
+   while(*link != entry)
+   {
+      link = &(*link)->next;
+   }
+   *link = entry->next;
+
+   read_cache_lru_unlink(entry);
+   gReadCacheUsed -= entry->cost;
+   free(entry);
+}
+
+
+
+/**
+ * @brief check if this process is notified about changes of a shared key, gReadCacheMtx must be locked
+ */
+static int read_cache_watched(const PersistenceInfo_s* info, const char* resource_id)
+{
+   const PersReadCacheWatch_s* watch = gReadCacheWatches;
+
+   while(watch != NULL)
+   {
+      if(   watch->ldbid == info->context.ldbid
+         && watch->user_no == info->context.user_no
+         && watch->seat_no == info->context.seat_no
+         && strcmp(watch->resource_id, resource_id) == 0)
+      {
+         return 1;
+      }
+      watch = watch->next;
+   }
+
+   return 0;
+}
+
+
+
+/**
+ * @brief get a value from the read cache
+ *
+ * @return the size of the value, or -1 if the value is not cached
+ */
+static int read_cache_get(const char* dbPath, int dbType, const char* key, unsigned char* buffer, int buffer_size)
+{
+   int rval = -1;
+
+   if(gReadCacheLimit != 0)
+   {
+      unsigned int hash = read_cache_hash(dbPath, dbType, key);
+      PersReadCacheEntry_s* entry = NULL;
+
+      gReadCachePrefetchHit = 0;
+
+      pthread_mutex_lock(&gReadCacheMtx);
+      entry = read_cache_find(hash, dbPath, dbType, key);
+      if(entry != NULL && entry->size <= buffer_size)
+      {
+         memcpy(buffer, entry->data, (size_t)entry->size);
+         rval = entry->size;
+
+         if(gReadCachePrefetching != 0)      // already cached, the next read is served from a prefetched value
          {
-            /// 0x02 ==> open database in write through mode,keep bit 1 set in order to create db if not existing
-            openFlags |= 0x02;
-            snprintf(path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", dbPath, plugin_gLocalWt);
+            entry->prefetched = 1;
          }
-         else if(PersistencePolicy_wc == dbType)		// cached database
+         else if(entry->prefetched != 0)
          {
-            snprintf(path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", dbPath, plugin_gLocalCached);
+            entry->prefetched = 0;
+            gReadCachePrefetchHit = 1;
          }
-         else if(PersistenceDB_confdefault == dbType)	// configurable default database
-			{
-			  snprintf(path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", dbPath, plugin_gLocalConfigurableDefault);
-			}
-			else if(PersistenceDB_default == dbType)		// default database
-			{
-			  snprintf(path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", dbPath, plugin_gLocalFactoryDefault);
-			}
-         else
+
+         read_cache_lru_unlink(entry);
+         read_cache_lru_push(entry);
+      }
+      pthread_mutex_unlock(&gReadCacheMtx);
+   }
+
+   return rval;
+}
+
+
+
+/**
+ * @brief store the value of a key in the read cache, or remove the key if buffer is NULL.
+ *        Shared keys are only stored while this process is notified about their changes.
+ */
+static void read_cache_put(const char* dbPath, int dbType, const char* key, const char* resource_id, const PersistenceInfo_s* info,
+                           const unsigned char* buffer, int buffer_size)
+{
+   if(gReadCacheLimit != 0)
+   {
+      unsigned int hash = read_cache_hash(dbPath, dbType, key);
+      size_t pathLen = strlen(dbPath) + 1, keyLen = strlen(key) + 1, resLen = strlen(resource_id) + 1;
+      size_t cost = sizeof(PersReadCacheEntry_s) + pathLen + keyLen + resLen + ((buffer != NULL) ? (size_t)buffer_size : 0);
+      PersReadCacheEntry_s* entry = NULL;
+
+      pthread_mutex_lock(&gReadCacheMtx);
+
+      entry = read_cache_find(hash, dbPath, dbType, key);
+      if(entry != NULL)
+      {
+         read_cache_free(entry);
+      }
+
+      if(   buffer != NULL && cost <= gReadCacheLimit
+         && (PersistenceStorage_shared != info->configKey.storage || read_cache_watched(info, resource_id) == 1) )
+      {
+         while(gReadCacheUsed + cost > gReadCacheLimit && gReadCacheLruTail != NULL)
+         {
+            read_cache_free(gReadCacheLruTail);    // least recently used
+         }
+
+         entry = malloc(cost);
+         if(entry != NULL)
+         {
+            entry->hash   = hash;
+            entry->dbType = dbType;
+            entry->shared = (PersistenceStorage_shared == info->configKey.storage) ? 1 : 0;
+            entry->prefetched = gReadCachePrefetching;
+            entry->ldbid  = info->context.ldbid;
+            entry->cost   = cost;
+            entry->size   = buffer_size;
+            memcpy(entry->name, dbPath, pathLen);
+            entry->key = entry->name + pathLen;
+            memcpy(entry->key, key, keyLen);
+            entry->resource_id = entry->key + keyLen;
+            memcpy(entry->resource_id, resource_id, resLen);
+            entry->data = (unsigned char*)(entry->resource_id + resLen);
+            memcpy(entry->data, buffer, (size_t)buffer_size);
+
+            entry->next = gReadCache[hash & (ReadCacheBuckets-1)];
+            gReadCache[hash & (ReadCacheBuckets-1)] = entry;
+            read_cache_lru_push(entry);
+            gReadCacheUsed += cost;
+         }
+      }
+
+      pthread_mutex_unlock(&gReadCacheMtx);
+   }
+}
+
+
+
+/**
+ * @brief start or stop caching a shared key, called when change notifications are (un)registered
+ */
+static void read_cache_watch(const char* resource_id, unsigned int ldbid, unsigned int user_no, unsigned int seat_no,
+                             PersNotifyRegPolicy_e regPolicy)
+{
+   PersReadCacheWatch_s** link = &gReadCacheWatches;
+
+   pthread_mutex_lock(&gReadCacheMtx);
+
+   while(*link != NULL)
+   {
+      PersReadCacheWatch_s* watch = *link;
+
+      if(   watch->ldbid == ldbid && watch->user_no == user_no && watch->seat_no == seat_no
+         && strncmp(watch->resource_id, resource_id, PERS_DB_MAX_LENGTH_KEY_NAME) == 0)
+      {
+         break;
+      }
+      link = &watch->next;
+   }
+
+   if(regPolicy == Notify_register && *link == NULL)
+   {
+      PersReadCacheWatch_s* watch = malloc(sizeof(PersReadCacheWatch_s));
+      if(watch != NULL)
+      {
+         watch->ldbid   = ldbid;
+         watch->user_no = user_no;
+         watch->seat_no = seat_no;
+         strncpy(watch->resource_id, resource_id, PERS_DB_MAX_LENGTH_KEY_NAME-1);
+         watch->resource_id[PERS_DB_MAX_LENGTH_KEY_NAME-1] = '\0';
+         watch->next = NULL;
+         *link = watch;
+      }
+   }
+   else if(regPolicy == Notify_unregister && *link != NULL)
+   {
+      PersReadCacheWatch_s* watch = *link;
+
+      *link = watch->next;
+      free(watch);
+   }
+
+   pthread_mutex_unlock(&gReadCacheMtx);
+
+   if(regPolicy == Notify_unregister)
+   {
+      persistence_read_cache_invalidate_key(ldbid, resource_id);    // changes are not notified anymore
+   }
+}
+
+
+
+void persistence_init_read_cache(void)
+{
+   const char* limit = getenv("PERS_CLIENT_LIB_READ_CACHE");
+
+   persistence_read_cache_clear();
+   gReadCacheLimit = (limit != NULL) ? (size_t)strtoul(limit, NULL, 0) : 0;
+
+   if(gReadCacheLimit != 0)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("initReadCache - size [bytes]:"), DLT_UINT((unsigned int)gReadCacheLimit));
+   }
+}
+
+
+
+void persistence_read_cache_clear(void)
+{
+   pthread_mutex_lock(&gReadCacheMtx);
+   while(gReadCacheLruTail != NULL)
+   {
+      read_cache_free(gReadCacheLruTail);
+   }
+   pthread_mutex_unlock(&gReadCacheMtx);
+}
+
+
+
+int persistence_read_cache_enabled(void)
+{
+   return (gReadCacheLimit != 0) ? 1 : 0;
+}
+
+
+
+void persistence_read_cache_set_prefetch(int prefetch)
+{
+   gReadCachePrefetching = (prefetch != 0) ? 1 : 0;
+}
+
+
+
+int persistence_read_cache_prefetch_hit(void)
+{
+   int rval = gReadCachePrefetchHit;
+
+   gReadCachePrefetchHit = 0;
+
+   return rval;
+}
+
+
+
+void persistence_read_cache_invalidate_key(unsigned int ldbid, const char* resource_id)
+{
+   if(gReadCacheLimit != 0)
+   {
+      PersReadCacheEntry_s* entry = NULL;
+
+      pthread_mutex_lock(&gReadCacheMtx);
+      entry = gReadCacheLruHead;
+      while(entry != NULL)
+      {
+         PersReadCacheEntry_s* next = entry->lruNext;
+
+         if(entry->shared != 0 && entry->ldbid == ldbid && strcmp(entry->resource_id, resource_id) == 0)
          {
-            handleDB = -2;
+            read_cache_free(entry);    // all users and seats, the key may not depend on them
          }
+         entry = next;
+      }
+      pthread_mutex_unlock(&gReadCacheMtx);
+   }
+}
+
+
+
+/**
+ * @brief get the two base hashes of a key used to address the bits of a key filter
+ */
+static void key_filter_hash(const char* key, unsigned int* h1, unsigned int* h2)
+{
+   size_t len = strlen(key);
+   unsigned int fnv = 2166136261u;
+   size_t i = 0;
+
+   for(i = 0; i < len; i++)
+   {
+      fnv = (fnv ^ (unsigned char)key[i]) * 16777619u;
+   }
+
+   *h1 = pclCrc32(0, (const unsigned char*)key, len);
+   *h2 = fnv | 1u;      // odd, so all probes differ
+}
+
+
+
+static void key_filter_add(PersKeyFilter_s* filter, const char* key)
+{
+   unsigned int h1 = 0, h2 = 0, i = 0;
+
+   key_filter_hash(key, &h1, &h2);
+   for(i = 0; i < KeyFilterNumHashes; i++)
+   {
+      unsigned int bit = (h1 + i * h2) & filter->mask;
+      (void)__sync_fetch_and_or(&filter->bits[bit >> 3], (unsigned char)(1u << (bit & 7u)));
+   }
+}
+
 
-         if (handleDB == -1)
+
+/**
+ * @return 0 if the key is definitely not in the database; 1 if it may be in the database
+ */
+static int key_filter_may_contain(const PersKeyFilter_s* filter, const char* key)
+{
+   unsigned int h1 = 0, h2 = 0, i = 0;
+
+   key_filter_hash(key, &h1, &h2);
+   for(i = 0; i < KeyFilterNumHashes; i++)
+   {
+      unsigned int bit = (h1 + i * h2) & filter->mask;
+      if((__sync_fetch_and_or((unsigned char*)&filter->bits[bit >> 3], 0) & (1u << (bit & 7u))) == 0)
+      {
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+
+/**
+ * @brief build the key filter of a default database from its key list
+ *
+ * @param handleDB the database handle
+ *
+ * @return the filter or NULL if the key list is not available
+ */
+static PersKeyFilter_s* key_filter_create(int handleDB)
+{
+   PersKeyFilter_s* filter = NULL;
+
+   if(*plugin_persComDbGetSizeKeysList != NULL && *plugin_persComDbGetKeysList != NULL)
+   {
+      int listSize = plugin_persComDbGetSizeKeysList(handleDB);
+      char* keyList = (listSize > 0) ? malloc((size_t)listSize + 1) : NULL;
+
+      if(listSize == 0 || keyList != NULL)
+      {
+         int numKeys = 0, pos = 0;
+
+         if(keyList != NULL)
          {
-            if(*plugin_persComDbOpen != NULL)
+            listSize = plugin_persComDbGetKeysList(handleDB, keyList, listSize);
+            if(listSize >= 0)
             {
-               handleDB = plugin_persComDbOpen(path, openFlags);
-               if(handleDB >= 0)
+               keyList[listSize] = '\0';
+               for(pos = 0; pos < listSize; pos += (int)strlen(&keyList[pos]) + 1)
                {
-                  gHandlesDB[arrayIdx][dbType] = handleDB ;
-                  gHandlesDBCreated[arrayIdx][dbType] = 1;
+                  numKeys++;
                }
-               else
+            }
+         }
+
+         if(listSize >= 0)
+         {
+            unsigned int numBits = 1024;
+
+            while(numBits < (unsigned int)numKeys * KeyFilterBitsPerKey)
+            {
+               numBits <<= 1;
+            }
+
+            filter = calloc(1, sizeof(PersKeyFilter_s) + numBits / 8);
+            if(filter != NULL)
+            {
+               filter->mask = numBits - 1;
+               for(pos = 0; pos < listSize; pos += (int)strlen(&keyList[pos]) + 1)
+               {
+                  if(keyList[pos] != '\0')
+                  {
+                     key_filter_add(filter, &keyList[pos]);
+                  }
+               }
+            }
+         }
+         free(keyList);
+      }
+   }
+
+   return filter;
+}
+
+
+
+static unsigned int db_map_hash(const PersistenceInfo_s* info, const char* dbPath, int dbType)
+{
+   unsigned int hash = pclCrc32(0, (const unsigned char*)dbPath, strlen(dbPath));
+
+   hash ^= info->context.ldbid * 2654435761u;
+   hash ^= ((unsigned int)info->configKey.storage << 24) ^ ((unsigned int)dbType << 28);
+
+   return hash ^ (hash >> 16);
+}
+
+
+
+/**
+ * @brief find an open database in a handle map
+ *
+ * @return the entry or NULL if the database is not in the map
+ */
+static PersDbHandle_s* db_map_find(const PersDbHandleMap_s* map, unsigned int hash,
+                                   const PersistenceInfo_s* info, const char* dbPath, int dbType)
+{
+   if(map != NULL)
+   {
+      unsigned int i = hash & map->mask;
+      PersDbHandle_s* entry = NULL;
+
+      while((entry = map->slot[i]) != NULL)
+      {
+         if(   entry->hash == hash
+            && entry->dbType == dbType
+            && entry->ldbid == info->context.ldbid
+            && entry->storage == (unsigned int)info->configKey.storage
+            && strcmp(entry->dbPath, dbPath) == 0)
+         {
+            return entry;
+         }
+         i = (i + 1) & map->mask;
+      }
+   }
+
+   return NULL;
+}
+
+
+
+static void db_map_put(PersDbHandleMap_s* map, PersDbHandle_s* entry)
+{
+   unsigned int i = entry->hash & map->mask;
+
+   while(map->slot[i] != NULL)
+   {
+      i = (i + 1) & map->mask;
+   }
+   map->slot[i] = entry;
+   map->count++;
+}
+
+
+
+/**
+ * @brief add an open database to the handle map, the map grows when it is half full
+ *        (gDbOpenMtx must be locked)
+ *
+ * @return 0 on success, EPERS_COMMON if no memory is available
+ */
+static int db_map_insert(PersDbHandle_s* entry)
+{
+   PersDbHandleMap_s* map = gDbHandleMap;
+
+   if(map == NULL || (map->count + 1) * 2 > map->mask + 1)
+   {
+      unsigned int size = (map != NULL) ? (map->mask + 1) * 2 : DbHandleMapInitialSize;
+      PersDbHandleMap_s* newMap = calloc(1, sizeof(PersDbHandleMap_s) + size * sizeof(PersDbHandle_s*));
+      unsigned int i = 0;
+
+      if(newMap == NULL)
+      {
+         return EPERS_COMMON;
+      }
+
+      newMap->mask = size - 1;
+      newMap->retired = map;     // lookups may still read the old map, it is freed by database_free_all
+      for(i = 0; map != NULL && i <= map->mask; i++)
+      {
+         if(map->slot[i] != NULL)
+         {
+            db_map_put(newMap, map->slot[i]);
+         }
+      }
+      __sync_synchronize();      // publish the content before the map
+      gDbHandleMap = newMap;
+      map = newMap;
+   }
+
+   __sync_synchronize();         // publish the entry before it can be found
+   db_map_put(map, entry);
+
+   return 0;
+}
+
+
+
+/**
+ * @brief pin an entry of the handle map, a pinned database will not be evicted
+ *
+ * @return 1 if the entry has been pinned; 0 if the database is not open
+ */
+static int database_pin(PersDbHandle_s* entry)
+{
+   int users = entry->users;
+
+   while(users >= 0)
+   {
+      int prev = __sync_val_compare_and_swap(&entry->users, users, users + 1);
+      if(prev == users)
+      {
+         if(entry->referenced == 0)
+         {
+            entry->referenced = 1;
+         }
+         return 1;
+      }
+      users = prev;
+   }
+
+   return 0;
+}
+
+
+
+static void database_release(PersDbHandle_s* entry)
+{
+   if(entry != NULL)
+   {
+      (void)__sync_sub_and_fetch(&entry->users, 1);
+   }
+}
+
+
+
+/**
+ * @brief close the least recently used database which is not pinned (second chance algorithm),
+ *        nothing is closed if all databases are pinned (gDbOpenMtx must be locked)
+ */
+static void database_evict_idle(void)
+{
+   PersDbHandleMap_s* map = gDbHandleMap;
+   unsigned int n = 0;
+
+   for(n = 0; map != NULL && n < 2 * (map->mask + 1); n++)
+   {
+      PersDbHandle_s* entry = map->slot[gDbEvictHand++ & map->mask];
+
+      if(entry != NULL && entry->users == 0)
+      {
+         if(entry->referenced != 0)
+         {
+            entry->referenced = 0;
+         }
+         else if(__sync_bool_compare_and_swap(&entry->users, 0, DbHandleClosed))
+         {
+            int iErrorCode = plugin_persComDbClose(entry->handle);
+            if(iErrorCode < 0)
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbEvict - Err close db:"), DLT_INT(iErrorCode));
+               __sync_synchronize();
+               entry->users = 0;      // still open
+            }
+            else
+            {
+               gDbNumOpen--;
+               gDbNumEvicted++;
+               return;
+            }
+         }
+      }
+   }
+}
+
+
+
+/**
+ * @brief create the file name of a database
+ *
+ * @param dbPath the path to the database
+ * @param dbType the database type (policy or default database)
+ * @param path the array where the file name will be stored
+ * @param openFlags the flags to open the database with
+ *
+ * @return 0 on success, -2 if the database type is invalid
+ */
+static int database_file_name(const char* dbPath, int dbType, char path[], unsigned char* openFlags)
+{
+   int rval = 0;
+
+   *openFlags = 0x01;   // by default create file if not existing
+
+   if(PersistencePolicy_wt == dbType)				/// write through database
+   {
+      /// 0x02 ==> open database in write through mode,keep bit 1 set in order to create db if not existing
+      *openFlags |= 0x02;
+      snprintf(path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", dbPath, plugin_gLocalWt);
+   }
+   else if(PersistencePolicy_wc == dbType)		// cached database
+   {
+      snprintf(path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", dbPath, plugin_gLocalCached);
+   }
+   else if(PersistenceDB_confdefault == dbType)	// configurable default database
+   {
+      snprintf(path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", dbPath, plugin_gLocalConfigurableDefault);
+   }
+   else if(PersistenceDB_default == dbType)		// default database
+   {
+      snprintf(path, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", dbPath, plugin_gLocalFactoryDefault);
+   }
+   else
+   {
+      rval = -2;
+   }
+
+   return rval;
+}
+
+
+
+/**
+ * @brief get the handle of a database and pin it, the database will be opened if necessary.
+ *        Different databases are opened in parallel, a caller needing a database which is
+ *        currently opened by another thread waits until it is open.
+ *
+ * @param info the persistence context information
+ * @param dbPath the path to the database
+ * @param dbType the database type (policy or default database)
+ * @param pinned the pinned entry, must be released with database_release when the handle is not used anymore
+ * @param record 1 if the use of the database shall be recorded for the prewarm of the next run
+ *
+ * @return the database handle or a negative value on error
+ */
+static int database_get_entry(PersistenceInfo_s* info, const char* dbPath, int dbType, PersDbHandle_s** pinned, int record)
+{
+   int handleDB = -1;
+   unsigned int hash = db_map_hash(info, dbPath, dbType);
+   PersDbHandle_s* entry = db_map_find(__sync_add_and_fetch(&gDbHandleMap, 0), hash, info, dbPath, dbType);
+
+   *pinned = NULL;
+
+   if(entry != NULL && database_pin(entry) == 1)
+   {
+      if(record != 0 && entry->recorded == 0)
+      {
+         entry->recorded = 1;
+         prewarm_record(entry->storage, entry->ldbid, dbType, dbPath);
+      }
+      *pinned = entry;
+      return entry->handle;   // fast path, database already open
+   }
+
+   if(pthread_mutex_lock(&gDbOpenMtx) != 0)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbGet - mutex lock failed"));
+      return EPERS_COMMON;
+   }
+
+   entry = db_map_find(gDbHandleMap, hash, info, dbPath, dbType);
+   while(entry != NULL && entry->users == DbHandleOpening)     // opened by another thread, wait for it
+   {
+      pthread_cond_wait(&gDbOpenCond, &gDbOpenMtx);
+      entry = db_map_find(gDbHandleMap, hash, info, dbPath, dbType);
+   }
+
+   if(entry != NULL && database_pin(entry) == 1)
+   {
+      handleDB = entry->handle;
+      *pinned = entry;
+   }
+   else
+   {
+      unsigned char openFlags = 0x01;
+      char path[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+
+      if(database_file_name(dbPath, dbType, path, &openFlags) != 0)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbGet - wrong policy! Cannot extend dbPath wit db."));
+         handleDB = -2;
+      }
+      else if(*plugin_persComDbOpen == NULL || *plugin_persComDbClose == NULL)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbGet - EPERS_NO_PLUGIN_FUNCT"));
+         handleDB = EPERS_NO_PLUGIN_FUNCT;
+      }
+      else
+      {
+         if(entry == NULL)
+         {
+            size_t pathLen = strlen(dbPath);
+
+            entry = malloc(sizeof(PersDbHandle_s) + pathLen + 1);
+            if(entry != NULL)
+            {
+               entry->hash    = hash;
+               entry->storage = (unsigned int)info->configKey.storage;
+               entry->ldbid   = info->context.ldbid;
+               entry->dbType  = dbType;
+               entry->handle  = -1;
+               entry->txHandle = -1;
+               entry->users   = DbHandleOpening;
+               entry->keyHandles = 0;
+               entry->referenced = 1;
+               entry->filter  = NULL;
+               memcpy(entry->dbPath, dbPath, pathLen + 1);
+
+               entry->recorded = 0;
+               if(db_map_insert(entry) != 0)
+               {
+                  free(entry);
+                  entry = NULL;
+               }
+            }
+         }
+         else
+         {
+            entry->users = DbHandleOpening;     // reopen of an evicted database
+         }
+
+         if(entry != NULL)
+         {
+            PersKeyFilter_s* filter = NULL;
+
+            if(gDbMaxOpen > 0 && gDbNumOpen >= gDbMaxOpen)
+            {
+               database_evict_idle();
+            }
+
+            // open without holding the lock, other databases can be opened in the meantime
+            gDbNumOpening++;
+            pthread_mutex_unlock(&gDbOpenMtx);
+
+            handleDB = plugin_persComDbOpen(path, openFlags);
+            if(handleDB >= 0 && dbType >= (int)PersistenceDB_confdefault && entry->filter == NULL)
+            {
+               // default databases are not changed by others at runtime: remember which keys they contain
+               filter = key_filter_create(handleDB);
+            }
+
+            pthread_mutex_lock(&gDbOpenMtx);
+            gDbNumOpening--;
+
+            if(handleDB >= 0)
+            {
+               entry->handle = handleDB;
+               if(filter != NULL)
                {
-                  DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbGet - persComDbOpen() failed"));
+                  entry->filter = filter;
                }
+               entry->referenced = 1;
+               __sync_synchronize();      // publish the handle before the entry can be pinned
+               entry->users = 1;
+
+               gDbNumOpen++;
+               gDbNumOpened++;
+               *pinned = entry;
             }
             else
             {
-               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbGet - EPERS_NO_PLUGIN_FUNCT"));
-               handleDB = EPERS_NO_PLUGIN_FUNCT;
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbGet - persComDbOpen() failed"));
+               entry->users = DbHandleClosed;      // will be tried again with the next access
             }
+            pthread_cond_broadcast(&gDbOpenCond);
          }
          else
          {
-            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbGet - wrong policy! Cannot extend dbPath wit db."));
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbGet - no memory for db handle"));
+            handleDB = EPERS_COMMON;
          }
       }
-      else
+   }
+   pthread_mutex_unlock(&gDbOpenMtx);
+
+   if(record != 0 && *pinned != NULL && entry->recorded == 0)
+   {
+      entry->recorded = 1;
+      prewarm_record(entry->storage, entry->ldbid, dbType, dbPath);
+   }
+
+   return handleDB;
+}
+
+
+
+static int database_get(PersistenceInfo_s* info, const char* dbPath, int dbType, PersDbHandle_s** pinned)
+{
+   return database_get_entry(info, dbPath, dbType, pinned, 1);
+}
+
+
+
+int persistence_acquire_db_handle(PersistenceInfo_s* info, const char* dbPath)
+{
+   PersDbHandle_s* entry = NULL;
+   int handleDB = database_get(info, dbPath, info->configKey.policy, &entry);
+
+   if(entry != NULL)
+   {
+      pthread_mutex_lock(&gDbOpenMtx);
+      entry->keyHandles++;       // until then the pin is waited for like the pin of a running call
+      pthread_mutex_unlock(&gDbOpenMtx);
+   }
+
+   return handleDB;
+}
+
+
+
+void persistence_release_db_handle(PersistenceInfo_s* info, const char* dbPath, unsigned int dbGeneration)
+{
+   pthread_mutex_lock(&gDbOpenMtx);
+
+   if(dbGeneration == gDbGeneration)    // pins of an older generation have been dropped
+   {
+      int dbType = info->configKey.policy;
+      PersDbHandle_s* entry = db_map_find(gDbHandleMap, db_map_hash(info, dbPath, dbType), info, dbPath, dbType);
+
+      if(entry != NULL && entry->keyHandles > 0)
       {
-         handleDB = gHandlesDB[arrayIdx][dbType];
+         entry->keyHandles--;
+         database_release(entry);
       }
    }
-   else
+
+   pthread_mutex_unlock(&gDbOpenMtx);
+}
+
+
+
+int persistence_prewarm_db(PersistenceInfo_s* info, const char* dbPath, int dbType)
+{
+   int rval = 0;
+   unsigned char openFlags = 0x01;
+   char path[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+
+   if(database_file_name(dbPath, dbType, path, &openFlags) != 0)
    {
-      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbGet - inval storage type"), DLT_STRING(dbPath));
+      rval = EPERS_COMMON;
    }
-   return handleDB;
+   else if(access(path, F_OK) == 0)      // don't create databases which have not been used yet
+   {
+      PersDbHandle_s* entry = NULL;
+
+      rval = database_get_entry(info, dbPath, dbType, &entry, 0);
+      database_release(entry);
+      rval = (rval >= 0) ? 1 : rval;
+   }
+
+   return rval;
+}
+
+
+
+void persistence_init_db_handle_limit(void)
+{
+   const char* maxOpen = getenv("PERS_CLIENT_LIB_MAX_OPEN_DB");
+
+   gDbMaxOpen = (maxOpen != NULL) ? (unsigned int)atoi(maxOpen) : DbMaxOpenDefault;
+}
+
+
+
+void persistence_get_db_handle_stats(unsigned int* maxOpen, unsigned int* numOpen,
+                                     unsigned long long* numOpened, unsigned long long* numEvicted)
+{
+   pthread_mutex_lock(&gDbOpenMtx);
+   *maxOpen    = gDbMaxOpen;
+   *numOpen    = gDbNumOpen;
+   *numOpened  = gDbNumOpened;
+   *numEvicted = gDbNumEvicted;
+   pthread_mutex_unlock(&gDbOpenMtx);
+}
+
+
+
+unsigned int persistence_get_db_generation(void)
+{
+   return __sync_add_and_fetch(&gDbGeneration, 0);
 }
 
 
+
 int pers_get_defaults(char* dbPath, char* key, PersistenceInfo_s* info, unsigned char* buffer, unsigned int buffer_size, PersGetDefault_e job)
 {
    PersDefaultType_e i = PersDefaultType_Configurable;
-   int handleDefaultDB = -1, read_size = EPERS_NOKEY;
+   int handleDefaultDB = -1, read_size = EPERS_NOKEY, probed = 0, found = 0;
    char dltMessage[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+   PersDbHandle_s* dbEntry = NULL;
 
-   for(i=(int)PersistenceDB_confdefault; i<(int)PersistenceDB_LastEntry; i++)
+   for(i=(int)PersistenceDB_confdefault; i<(int)PersistenceDB_LastEntry && found == 0; i++)
    {
-   	handleDefaultDB = database_get(info, dbPath, i);
+   	handleDefaultDB = database_get(info, dbPath, i, &dbEntry);
       if(handleDefaultDB >= 0)
       {
+         if(dbEntry->filter != NULL && key_filter_may_contain(dbEntry->filter, key) == 0)
+         {
+            read_size = EPERS_NOKEY;      // known miss, no need to ask the database
+            database_release(dbEntry);
+            continue;
+         }
+         probed = 1;
+
          if (PersGetDefault_Data == job)
          {
             if(*plugin_persComDbReadKey != NULL)
@@ -163,7 +1355,7 @@ int pers_get_defaults(char* dbPath, char* key, PersistenceInfo_s* info, unsigned
          else
          {
             DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("getDefaults - unknown job"));
-            break;
+            found = 1;
          }
 
          if(read_size < 0) // check read_size
@@ -185,12 +1377,13 @@ int pers_get_defaults(char* dbPath, char* key, PersistenceInfo_s* info, unsigned
             }
             DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("getDefaults - default data will be used for Key"), DLT_STRING(key),
                                                   DLT_STRING("from"), DLT_STRING(dltMessage));
-            break;
+            found = 1;
          }
+         database_release(dbEntry);
       }
    }
 
-   if (read_size < 0)
+   if (read_size < 0 && probed != 0)
    {
        DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("getDefaults - default data not available for Key"), DLT_STRING(key),
                                              DLT_STRING("Path:"), DLT_STRING(dbPath));
@@ -201,35 +1394,135 @@ int pers_get_defaults(char* dbPath, char* key, PersistenceInfo_s* info, unsigned
 
 
 
+/**
+ * @brief close a database as soon as only key handles and iterators pin it, their pins are dropped.
+ *        Waits for running calls to release their pins (gDbOpenMtx must be locked, it is unlocked while waiting).
+ */
+static void database_close_entry(PersDbHandle_s* entry)
+{
+   unsigned int waitMs = 0;
+
+   for(;;)
+   {
+      int keyHandles = entry->keyHandles;
+
+      if(entry->users == DbHandleOpening)
+      {
+         pthread_cond_wait(&gDbOpenCond, &gDbOpenMtx);
+      }
+      else if(entry->users == DbHandleClosed)
+      {
+         break;      // not open
+      }
+      else if(__sync_bool_compare_and_swap(&entry->users, keyHandles, DbHandleClosed))
+      {
+         // no running call uses the handle and it can't be pinned anymore
+         int iErrorCode = EPERS_NO_PLUGIN_FUNCT;
+
+         entry->keyHandles = 0;
+         if(*plugin_persComDbClose != NULL)
+         {
+            iErrorCode = plugin_persComDbClose(entry->handle);
+         }
+
+         if(iErrorCode < 0)
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbCloseAll - Err close db:"), DLT_INT(iErrorCode));
+            __sync_synchronize();
+            entry->users = 0;    // still open, closing is tried again next time
+         }
+         else
+         {
+            free(entry->filter);    // default databases may be changed while access is locked
+            entry->filter = NULL;
+            gDbNumOpen--;
+         }
+         break;
+      }
+      else if(waitMs < DbCloseWaitMs)
+      {
+         pthread_mutex_unlock(&gDbOpenMtx);     // the pins are released without the lock, poll them
+         usleep(1000);
+         pthread_mutex_lock(&gDbOpenMtx);
+         waitMs++;
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbCloseAll - db still in use, not closed:"), DLT_STRING(entry->dbPath));
+         break;
+      }
+   }
+}
+
+
+
 void database_close_all()
 {
-   int i = 0, j = 0;
+   PersDbHandleMap_s* map = NULL;
+   unsigned int i = 0;
+
+   persistence_invalidate_write_hash();
+   persistence_read_cache_clear();
+
+   pthread_mutex_lock(&gDbOpenMtx);
+
+   (void)__sync_add_and_fetch(&gDbGeneration, 1);   // database handles stored elsewhere (key handles) are now stale
 
-   for(i=0; i<DbTableSize; i++)
+   // entries and maps are not freed: running calls may still look them up without the lock
+   while(map != gDbHandleMap)    // once more if the map has grown while waiting
    {
-   	for(j=0; j < PersistenceDB_LastEntry; j++)
-   	{
-			if(gHandlesDBCreated[i][j] == 1)
-			{
-			   if(*plugin_persComDbClose != NULL)
-			   {
-               int iErrorCode = plugin_persComDbClose(gHandlesDB[i][j]);
-               if (iErrorCode < 0)
-               {
-                  DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbCloseAll - Err close db"));
-               }
-               else
-               {
-                   gHandlesDBCreated[i][j] = 0;
-               }
-			   }
-			   else
-			   {
-			      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("dbCloseAll - plugin function NULL"));
-			   }
-			}
-   	}
+      map = gDbHandleMap;
+      for(i = 0; i <= map->mask; i++)
+      {
+         PersDbHandle_s* entry = map->slot[i];
+
+         if(entry != NULL)
+         {
+            database_close_entry(entry);
+         }
+      }
+   }
+
+   pthread_mutex_unlock(&gDbOpenMtx);
+}
+
+
+
+void database_free_all(void)
+{
+   PersDbHandleMap_s* map = NULL;
+   unsigned int i = 0;
+
+   database_close_all();
+
+   pthread_mutex_lock(&gDbOpenMtx);
+
+   map = gDbHandleMap;
+   gDbHandleMap = NULL;
+   gDbNumOpen = 0;
+   for(i = 0; map != NULL && i <= map->mask; i++)
+   {
+      PersDbHandle_s* entry = map->slot[i];
+
+      if(entry != NULL)
+      {
+         if(entry->users >= 0 && *plugin_persComDbClose != NULL)
+         {
+            (void)plugin_persComDbClose(entry->handle);     // could not be closed before, the library is not used anymore
+         }
+         free(entry->filter);
+         free(entry);
+      }
+   }
+
+   while(map != NULL)
+   {
+      PersDbHandleMap_s* retired = map->retired;
+      free(map);
+      map = retired;
    }
+
+   pthread_mutex_unlock(&gDbOpenMtx);
 }
 
 
@@ -241,19 +1534,34 @@ int persistence_get_data(char* dbPath, char* key, const char* resourceID, Persis
    if(   PersistenceStorage_shared == info->configKey.storage
       || PersistenceStorage_local == info->configKey.storage)
    {
-      int handleDB = database_get(info, dbPath, info->configKey.policy);
+      PersDbHandle_s* dbEntry = NULL;
+      int handleDB = -1;
+
+      read_size = read_cache_get(dbPath, info->configKey.policy, key, buffer, buffer_size);
+      if(read_size >= 0)
+      {
+         return read_size;
+      }
+
+      handleDB = database_get(info, dbPath, info->configKey.policy, &dbEntry);
       if(handleDB >= 0)
       {
          if(*plugin_persComDbReadKey != NULL)
          {
             read_size = plugin_persComDbReadKey(handleDB, key, (char*)buffer, buffer_size);
+            database_release(dbEntry);
             if(read_size < 0)
             {
                read_size = pers_get_defaults(dbPath, (char*)resourceID, info, buffer, (unsigned int)buffer_size, PersGetDefault_Data); /* 0 ==> Get data */
             }
+            else if(read_size < buffer_size)    // a value filling the buffer may be truncated
+            {
+               read_cache_put(dbPath, info->configKey.policy, key, resourceID, info, buffer, read_size);
+            }
          }
          else
          {
+            database_release(dbEntry);
             DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("getData - EPERS_NO_PLUGIN_FUNCT"));
             read_size = EPERS_NO_PLUGIN_FUNCT;
          }
@@ -345,6 +1653,19 @@ int persistence_get_data(char* dbPath, char* key, const char* resourceID, Persis
 
 
 int persistence_set_data(char* dbPath, char* key, const char* resource_id, PersistenceInfo_s* info, unsigned char* buffer, int buffer_size)
+{
+   if(persistence_data_unchanged(dbPath, key, resource_id, info, buffer, buffer_size) == 1)
+   {
+      return buffer_size;     // nothing to write, nothing to notify
+   }
+
+   return persistence_set_data_notify(dbPath, key, resource_id, info, buffer, buffer_size, 1);
+}
+
+
+
+int persistence_set_data_notify(char* dbPath, char* key, const char* resource_id, PersistenceInfo_s* info, unsigned char* buffer, int buffer_size,
+                                int sendNotification)
 {
    int write_size = -1;
 
@@ -354,6 +1675,7 @@ int persistence_set_data(char* dbPath, char* key, const char* resource_id, Persi
       int handleDB = -1 ;
       int dbType = info->configKey.policy;      // assign default policy
       const char* dbInput = key;                // assign default key
+      PersDbHandle_s* dbEntry = NULL;
 
       if(info->context.user_no ==  (int)PCL_USER_DEFAULTDATA)
       {
@@ -361,7 +1683,7 @@ int persistence_set_data(char* dbPath, char* key, const char* resource_id, Persi
          dbInput = resource_id;                 // change database key when writing configurable default data
       }
 
-      handleDB = database_get(info, dbPath, dbType);
+      handleDB = database_get(info, dbPath, dbType, &dbEntry);
 
       if(handleDB >= 0)
       {
@@ -371,10 +1693,22 @@ int persistence_set_data(char* dbPath, char* key, const char* resource_id, Persi
             if(write_size < 0)
             {
                DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("setData - persComDbWriteKey() failure"));
+               write_hash_update(dbPath, dbType, dbInput, NULL, 0);
+               read_cache_put(dbPath, dbType, dbInput, resource_id, info, NULL, 0);
             }
             else
             {
-               if(PersistenceStorage_shared == info->configKey.storage)
+               write_hash_update(dbPath, dbType, dbInput, buffer, buffer_size);
+               if(dbEntry->filter != NULL)
+               {
+                  key_filter_add(dbEntry->filter, dbInput);    // the key filter must know the new default
+               }
+               if(dbType != PersistenceDB_confdefault)
+               {
+                  read_cache_put(dbPath, dbType, dbInput, resource_id, info, buffer, buffer_size);
+               }
+
+               if(PersistenceStorage_shared == info->configKey.storage && sendNotification != 0)
                {
                   int rval = pers_send_Notification_Signal(resource_id, &info->context, pclNotifyStatus_changed);
                   if(rval <= 0)
@@ -390,6 +1724,7 @@ int persistence_set_data(char* dbPath, char* key, const char* resource_id, Persi
             DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("setData - EPERS_NO_PLUGIN_FUNCT"));
             write_size = EPERS_NO_PLUGIN_FUNCT;
          }
+         database_release(dbEntry);
       }
       else
       {
@@ -449,7 +1784,7 @@ int persistence_set_data(char* dbPath, char* key, const char* resource_id, Persi
 				}
 				write_size = gPersCustomFuncs[idx].custom_plugin_set_data(pathKeyString, (char*)buffer, buffer_size);
 
-				if ((0 < write_size) && ((unsigned int)write_size == buffer_size)) /* Check return value and send notification if OK */
+				if ((0 < write_size) && ((unsigned int)write_size == buffer_size) && (sendNotification != 0)) /* Check return value and send notification if OK */
 				{
 					int rval = pers_send_Notification_Signal(resource_id, &info->context, pclNotifyStatus_changed);
 					if(rval <= 0)
@@ -474,6 +1809,127 @@ int persistence_set_data(char* dbPath, char* key, const char* resource_id, Persi
 
 
 
+int persistence_commit_data(char* dbPath, PersistenceInfo_s* info, const char* keys[], const char* resource_ids[],
+                            unsigned char* buffers[], const int sizes[], int results[], unsigned int count, unsigned int* numApplied)
+{
+   int rval = 0;
+
+   *numApplied = 0;
+
+   if(   PersistenceStorage_local == info->configKey.storage
+      || PersistenceStorage_shared == info->configKey.storage )
+   {
+      int handleDB = -1;
+      int dbType = info->configKey.policy;      // assign default policy
+      int useResourceId = 0;
+      unsigned int i = 0, numWritten = 0;
+      PersDbHandle_s* dbEntry = NULL;
+
+      if(info->context.user_no ==  (int)PCL_USER_DEFAULTDATA)
+      {
+         dbType = PersistenceDB_confdefault;    // change policy when writing configurable default data
+         useResourceId = 1;                     // change database key when writing configurable default data
+      }
+
+      if(*plugin_persComDbWriteKey == NULL || *plugin_persComDbOpen == NULL || *plugin_persComDbClose == NULL)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("commitData - EPERS_NO_PLUGIN_FUNCT"));
+         return EPERS_NO_PLUGIN_FUNCT;
+      }
+
+      handleDB = database_get(info, dbPath, dbType, &dbEntry);
+
+      if(handleDB >= 0)
+      {
+         unsigned char openFlags = 0x01;
+         char path[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+
+         // a write through database syncs every key, the keys are written to the cached mode companion
+         // handle instead and are synced once when it is closed. Cached databases are synced on close anyway.
+         if(   dbEntry != NULL
+            && database_file_name(dbPath, dbType, path, &openFlags) == 0
+            && (openFlags & 0x02) != 0)
+         {
+            dbEntry->txHandle = plugin_persComDbOpen(path, (unsigned char)(openFlags & ~0x02));
+            if(dbEntry->txHandle >= 0)
+            {
+               handleDB = dbEntry->txHandle;
+            }
+            else
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("commitData - no cached handle, keys are synced one by one"), DLT_STRING(dbPath));
+               dbEntry->txHandle = -1;
+            }
+         }
+
+         // the keys are written in order, writing stops at the first failure
+         for(i = 0; i < count && rval >= 0; i++)
+         {
+            const char* dbInput = (useResourceId != 0) ? resource_ids[i] : keys[i];
+
+            results[i] = plugin_persComDbWriteKey(handleDB, dbInput, (char*)buffers[i], sizes[i]);
+            if(results[i] < 0)
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("commitData - persComDbWriteKey() failure"), DLT_STRING(dbInput));
+               rval = results[i];
+            }
+            else
+            {
+               numWritten++;
+            }
+         }
+
+         if(dbEntry != NULL && dbEntry->txHandle >= 0)
+         {
+            // the single sync of the transaction, the keys written before a failure are applied as well
+            int iErrorCode = plugin_persComDbClose(dbEntry->txHandle);
+            dbEntry->txHandle = -1;
+            if(iErrorCode < 0)
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("commitData - Err close cached handle:"), DLT_INT(iErrorCode));
+               rval = (rval < 0) ? rval : iErrorCode;
+               numWritten = 0;
+            }
+         }
+
+         for(i = 0; i < count; i++)
+         {
+            const char* dbInput = (useResourceId != 0) ? resource_ids[i] : keys[i];
+
+            if(i < numWritten)
+            {
+               write_hash_update(dbPath, dbType, dbInput, buffers[i], sizes[i]);
+               if(dbEntry != NULL && dbEntry->filter != NULL)
+               {
+                  key_filter_add(dbEntry->filter, dbInput);
+               }
+            }
+            else
+            {
+               write_hash_update(dbPath, dbType, dbInput, NULL, 0);    // content not known anymore
+            }
+            read_cache_put(dbPath, dbType, dbInput, resource_ids[i], info, NULL, 0);
+         }
+         *numApplied = numWritten;
+
+         database_release(dbEntry);
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("commitData - no RCT"), DLT_STRING(dbPath));
+         rval = EPERS_NOPRCTABLE;
+      }
+   }
+   else
+   {
+      rval = EPERS_BADPOL;   // custom storage doesn't support transactions
+   }
+
+   return rval;
+}
+
+
+
 int persistence_get_data_size(char* dbPath, char* key, const char* resourceID, PersistenceInfo_s* info)
 {
    int read_size = -1, ret_defaults = -1;
@@ -481,12 +1937,14 @@ int persistence_get_data_size(char* dbPath, char* key, const char* resourceID, P
    if(   PersistenceStorage_shared == info->configKey.storage
       || PersistenceStorage_local == info->configKey.storage)
    {
-      int handleDB = database_get(info, dbPath, info->configKey.policy);
+      PersDbHandle_s* dbEntry = NULL;
+      int handleDB = database_get(info, dbPath, info->configKey.policy, &dbEntry);
       if(handleDB >= 0)
       {
          if(*plugin_persComDbGetKeySize != NULL)
          {
             read_size = plugin_persComDbGetKeySize(handleDB, key);
+            database_release(dbEntry);
             if(read_size < 0)
             {
                read_size = pers_get_defaults( dbPath, (char*)resourceID, info, NULL, 0, PersGetDefault_Size);
@@ -494,6 +1952,7 @@ int persistence_get_data_size(char* dbPath, char* key, const char* resourceID, P
          }
          else
          {
+            database_release(dbEntry);
             DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("getDataSize - EPERS_NO_PLUGIN_FUNCT"));
             read_size = EPERS_NO_PLUGIN_FUNCT;
          }
@@ -585,12 +2044,15 @@ int persistence_delete_data(char* dbPath, char* key, const char* resource_id, Pe
    int ret = 0;
    if(PersistenceStorage_custom != info->configKey.storage)
    {
-      int handleDB = database_get(info, dbPath, info->configKey.policy);
+      PersDbHandle_s* dbEntry = NULL;
+      int handleDB = database_get(info, dbPath, info->configKey.policy, &dbEntry);
       if(handleDB >= 0)
       {
          if(*plugin_persComDbDeleteKey != NULL)
          {
+            write_hash_update(dbPath, info->configKey.policy, key, NULL, 0);
             ret = plugin_persComDbDeleteKey(handleDB, key) ;
+            read_cache_put(dbPath, info->configKey.policy, key, resource_id, info, NULL, 0);
             if(ret < 0)
             {
                DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("deleteData - failed: "), DLT_STRING(key));
@@ -614,6 +2076,7 @@ int persistence_delete_data(char* dbPath, char* key, const char* resource_id, Pe
             DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("deleteData - EPERS_NO_PLUGIN_FUNCT"));
             ret = EPERS_NO_PLUGIN_FUNCT;
          }
+         database_release(dbEntry);
       }
       else
       {
@@ -714,6 +2177,8 @@ int persistence_notify_on_change(const char* resource_id, const char* dbKey, uns
 
    	snprintf(data.string, PERS_DB_MAX_LENGTH_KEY_NAME, "%s", resource_id);
 
+      read_cache_watch(resource_id, ldbid, user_no, seat_no, regPolicy);
+
       // check if the tree has already been created
    	if(gNotificationTree == NULL)
    	{
@@ -791,6 +2256,54 @@ int persistence_notify_on_change(const char* resource_id, const char* dbKey, uns
 
 
 
+int pers_send_Notification_Signal_Batch(const char* keys[], PersistenceDbContext_s* contexts[], unsigned int count, pclNotifyStatus_e reason)
+{
+   int rval = 1;
+
+   if(reason < pclNotifyStatus_lastEntry)
+   {
+      if(count > 0)
+      {
+         MainLoopData_u* data = malloc(count * sizeof(MainLoopData_u));
+         if(data != NULL)
+         {
+            unsigned int i = 0;
+
+            memset(data, 0, count * sizeof(MainLoopData_u));
+            for(i = 0; i < count; i++)
+            {
+               data[i].cmd = (uint32_t)CMD_SEND_NOTIFY_SIGNAL;
+               data[i].params[0] = contexts[i]->ldbid;
+               data[i].params[1] = contexts[i]->user_no;
+               data[i].params[2] = contexts[i]->seat_no;
+               data[i].params[3] = reason;
+
+               snprintf(data[i].string, PERS_DB_MAX_LENGTH_KEY_NAME, "%s", keys[i]);
+            }
+
+            if(-1 == notify_queue_push(data, count) )
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("sendNotifySigBatch - Queue notification"));
+               rval = EPERS_NOTIFY_SIG;
+            }
+            free(data);
+         }
+         else
+         {
+            rval = EPERS_NOTIFY_SIG;
+         }
+      }
+   }
+   else
+   {
+      rval = EPERS_NOTIFY_SIG;
+   }
+
+   return rval;
+}
+
+
+
 int pers_send_Notification_Signal(const char* key, PersistenceDbContext_s* context, pclNotifyStatus_e reason)
 {
    int rval = 1;
@@ -807,9 +2320,9 @@ int pers_send_Notification_Signal(const char* key, PersistenceDbContext_s* conte
 
    	snprintf(data.string, PERS_DB_MAX_LENGTH_KEY_NAME, "%s", key);
 
-      if(-1 == deliverToMainloop(&data) )
+      if(-1 == notify_queue_push(&data, 1) )
       {
-         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("sendNotifySig - Write to pipe"), DLT_INT(errno));
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("sendNotifySig - Queue notification"));
          rval = EPERS_NOTIFY_SIG;
       }
    }
@@ -832,11 +2345,7 @@ void pers_rct_close_all()
    	{
    	   if(*plugin_persComRctClose != NULL)
    	   {
-            if(plugin_persComRctClose(get_resource_cfg_table_by_idx(i)) != 0)
-            {
-               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("prepShtdwn - Close db => index:"), DLT_INT(i));
-            }
-            invalidate_resource_cfg_table(i);
+            invalidate_resource_cfg_table(i);     // closes the table when the running lookups are done
    	   }
    	   else
    	   {
@@ -844,5 +2353,7 @@ void pers_rct_close_all()
    	   }
    	}
    }
+
+   invalidate_resolved_cache();  // resolved resources are only valid as long as the RCT is open
 }
 
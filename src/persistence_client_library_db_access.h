@@ -58,6 +58,73 @@ char* pers_get_raw_key(char *key);
 
 
 
+/**
+ * @brief get the handle of the database a resolved resource is stored in, the database will be opened if necessary.
+ *        The database is pinned (it will not be evicted) until it is released with ::persistence_release_db_handle
+ *
+ * @param info the persistence context information of the resolved resource
+ * @param dbPath the path to the database
+ *
+ * @return the database handle or a negative value on error
+ */
+int persistence_acquire_db_handle(PersistenceInfo_s* info, const char* dbPath);
+
+
+
+/**
+ * @brief release a database handle acquired with ::persistence_acquire_db_handle
+ *
+ * @param info the persistence context information of the resolved resource
+ * @param dbPath the path to the database
+ * @param dbGeneration the database generation the handle has been acquired with
+ */
+void persistence_release_db_handle(PersistenceInfo_s* info, const char* dbPath, unsigned int dbGeneration);
+
+
+
+/**
+ * @brief open a database in advance, a database which doesn't exist will not be created
+ *
+ * @param info the persistence context information
+ * @param dbPath the path to the database
+ * @param dbType the database type (policy or default database)
+ *
+ * @return 1 if the database is open; 0 if it doesn't exist; a negative value on error
+ */
+int persistence_prewarm_db(PersistenceInfo_s* info, const char* dbPath, int dbType);
+
+
+
+/**
+ * @brief read the max number of open databases (environment variable PERS_CLIENT_LIB_MAX_OPEN_DB, 0: no limit)
+ */
+void persistence_init_db_handle_limit(void);
+
+
+
+/**
+ * @brief get the open database counters
+ *
+ * @param maxOpen the max number of open databases, 0 if not limited
+ * @param numOpen the number of currently open databases
+ * @param numOpened the number of times a database has been opened
+ * @param numEvicted the number of times an idle database has been closed to stay within the limit
+ */
+void persistence_get_db_handle_stats(unsigned int* maxOpen, unsigned int* numOpen,
+                                     unsigned long long* numOpened, unsigned long long* numEvicted);
+
+
+
+/**
+ * @brief get the database generation, it changes every time the open databases are closed.
+ *        A database handle retrieved with an older generation must not be used anymore.
+ *
+ * @return the current database generation
+ */
+unsigned int persistence_get_db_generation(void);
+
+
+
 /**
  * @brief tries to get default values for a key from the configurable and factory default databases.
  *
@@ -93,6 +160,136 @@ int persistence_set_data(char* dbPath, char* key, const char* resource_id, Persi
 
 
 
+/**
+ * @brief check if the data to write to a key is identical to the data written last to this key.
+ *        Only available for local keys if enabled with the environment variable PERS_CLIENT_LIB_SKIP_UNCHANGED=1,
+ *        otherwise the data is always reported as changed. Shared keys can be changed by other applications
+ *        and are always written.
+ *
+ * @param dbPath the path to the database where the key is in
+ * @param key the database key
+ * @param resource_id the resource identifier
+ * @param info persistence information
+ * @param buffer the buffer holding the data
+ * @param buffer_size the size of the buffer
+ *
+ * @return 1 if the data is unchanged and doesn't need to be written; 0 otherwise
+ */
+int persistence_data_unchanged(char* dbPath, char* key, const char* resource_id, PersistenceInfo_s* info, unsigned char* buffer, int buffer_size);
+
+
+
+/**
+ * @brief read the configuration of the unchanged write detection (environment variable PERS_CLIENT_LIB_SKIP_UNCHANGED)
+ */
+void persistence_init_unchanged_write_detection(void);
+
+
+
+/**
+ * @brief forget the hashes of the written data, must be called when the data may have been changed by others
+ */
+void persistence_invalidate_write_hash(void);
+
+
+
+/**
+ * @brief read the size of the read cache (environment variable PERS_CLIENT_LIB_READ_CACHE [bytes], 0: disabled).
+ *        Values read from or written to local databases are kept in memory; shared values only
+ *        while this process is registered for their change notifications.
+ */
+void persistence_init_read_cache(void);
+
+
+
+/**
+ * @brief drop all cached values, must be called when the data may have been changed by others
+ */
+void persistence_read_cache_clear(void);
+
+
+
+/**
+ * @brief check if the read cache is enabled (environment variable PERS_CLIENT_LIB_READ_CACHE)
+ *
+ * @return 1 if values are cached; 0 if not
+ */
+int persistence_read_cache_enabled(void);
+
+
+
+/**
+ * @brief mark the values the calling thread reads from now on as prefetched, used by the boot access manifest
+ *
+ * @param prefetch 1 to start marking the values, 0 to stop
+ */
+void persistence_read_cache_set_prefetch(int prefetch);
+
+
+
+/**
+ * @brief check if the last value the calling thread got from the read cache had been prefetched,
+ *        each prefetched value is reported once
+ *
+ * @return 1 if the value had been prefetched; 0 if not
+ */
+int persistence_read_cache_prefetch_hit(void);
+
+
+
+/**
+ * @brief drop the cached values of a shared key for all users and seats, called when a change notification arrives
+ *
+ * @param ldbid logical database ID
+ * @param resource_id the resource ID
+ */
+void persistence_read_cache_invalidate_key(unsigned int ldbid, const char* resource_id);
+
+
+
+/**
+ * @brief write data to a key, the change notification can be suppressed
+ *        to be able to send the notifications of several keys at once
+ *
+ * @param dbPath the path to the database where the key is in
+ * @param key the database key
+ * @param resource_id the resource identifier
+ * @param info persistence information
+ * @param buffer the buffer holding the data
+ * @param buffer_size the size of the buffer
+ * @param sendNotification 1 to send the change notification; 0 if the caller sends it
+ *
+ * @return the number of bytes written or a negative value if an error occured, see ::persistence_set_data
+ */
+int persistence_set_data_notify(char* dbPath, char* key, const char* resource_id, PersistenceInfo_s* info, unsigned char* buffer, int buffer_size,
+                                int sendNotification);
+
+
+
+/**
+ * @brief write several keys of one database at once, the key access lock of the database must be write locked.
+ *        The keys of a write through database are written to a companion handle opened in cached mode,
+ *        the database is synced once for all keys when it is closed.
+ *
+ * @param dbPath the path to the database the keys are in
+ * @param info persistence information, must be the same for all keys
+ * @param keys the database keys
+ * @param resource_ids the resource identifiers of the keys
+ * @param buffers the buffers holding the data of the keys
+ * @param sizes the sizes of the buffers
+ * @param results array where the number of bytes written or the error of each key will be stored
+ * @param count the number of keys
+ * @param numApplied the number of keys applied: the keys are written in order and writing stops
+ *                   at the first failure, keys[0] to keys[numApplied-1] have been written
+ *
+ * @return 0 if all keys have been written or a negative value with the error occured:
+ *   EPERS_NO_PLUGIN_FUNCT, EPERS_NOPRCTABLE, EPERS_BADPOL or an error of the database
+ */
+int persistence_commit_data(char* dbPath, PersistenceInfo_s* info, const char* keys[], const char* resource_ids[],
+                            unsigned char* buffers[], const int sizes[], int results[], unsigned int count, unsigned int* numApplied);
+
+
+
 /**
  * @brief get data of a key
  *
@@ -141,12 +338,21 @@ int persistence_delete_data(char* dbPath, char* key, const char* resource_id, Pe
 
 
 /**
- * @brief close all databases
+ * @brief close all databases, waits until the running calls have released their pins.
+ *        The memory of the open database map stays valid, it is freed with database_free_all.
  */
 void database_close_all();
 
 
 
+/**
+ * @brief close all databases and free the open database map, must only be called
+ *        when the library is not used anymore (pclDeinitLibrary after the mainloop has ended)
+ */
+void database_free_all(void);
+
+
+
 /**
  * @brief register or unregister for change notifications of a key
  *
@@ -165,17 +371,31 @@ int persistence_notify_on_change(const char* resource_id, const char* dbKey, uns
 
 
 /**
- * @brief send a notification signal
+ * @brief queue a notification signal, it is sent by the notification sender thread
  *
  * @param key the database key to register on
  * @param context the database context
  * @param reason the reason of the signal, values see pclNotifyStatus_e.
  *
- * @return 0 of registration was successful; -1 if registration failes
+ * @return 1 if the signal has been queued; EPERS_NOTIFY_SIG on error
  */
 int pers_send_Notification_Signal(const char* key, PersistenceDbContext_s* context, pclNotifyStatus_e reason);
 
 
+
+/**
+ * @brief queue the notification signals of several keys at once, they are sent by the notification sender thread
+ *
+ * @param keys the database keys
+ * @param contexts the database contexts of the keys
+ * @param count the number of keys
+ * @param reason the reason of the signal, values see pclNotifyStatus_e.
+ *
+ * @return 1 if the signals have been queued; EPERS_NOTIFY_SIG on error
+ */
+int pers_send_Notification_Signal_Batch(const char* keys[], PersistenceDbContext_s* contexts[], unsigned int count, pclNotifyStatus_e reason);
+
+
 /**
  * @brief close all open persistence resource configuration tables
  */
@@ -22,7 +22,10 @@
 #include "persistence_client_library_custom_loader.h"
 #include "persistence_client_library_pas_interface.h"
 #include "persistence_client_library_db_access.h"
+#include "persistence_client_library_key_async.h"
 #include "persistence_client_library_file.h"
+#include "persistence_client_library_tree_helper.h"
+#include "crc32.h"
 
 
 #if USE_FILECACHE
@@ -50,6 +53,16 @@ static const char* gChangeSignal = "PersistenceResChange";
 static const char* gDeleteSignal = "PersistenceResDelete";
 /// create signal string
 static const char* gCreateSignal = "PersistenceResCreate";
+/// batched change signal string
+static const char* gChangeBatchSignal = "PersistenceResChangeBatch";
+/// additional argument of a per key signal which has been sent as part of a batched signal too
+static const char* gBatchedMarker = "batched";
+
+/// match rule of the batched change signal, the keys of the signal are checked with gNotifyRegTree
+static const char* gChangeBatchRule = "type='signal',interface='org.genivi.persistence.adminconsumer',member='PersistenceResChangeBatch',path='/org/genivi/persistence/adminconsumer'";
+
+/// the keys registered for change notifications, only used by the dbus mainloop
+static jsw_rbtree_t* gNotifyRegTree = NULL;
 
 /// dbus timeout
 static int gTimeoutMs = 5000;
@@ -59,6 +72,87 @@ static void msg_pending_func(DBusPendingCall *call, void *data);
 
 
 
+static unsigned int notify_reg_hash(unsigned int notifyLdbid, unsigned int notifyUserNo, unsigned int notifySeatNo, const char* notifyKey)
+{
+   unsigned int params[3] = {notifyLdbid, notifyUserNo, notifySeatNo};
+   unsigned int hash = pclCrc32(0, (const unsigned char*)notifyKey, strlen(notifyKey));
+
+   return pclCrc32(hash, (const unsigned char*)params, sizeof(params));
+}
+
+
+
+/**
+ * @brief remember a registered key, the batched change signal is matched as long as a key is registered
+ */
+static void notify_reg_update(DBusConnection* conn, unsigned int notifyLdbid, unsigned int notifyUserNo,
+                                                    unsigned int notifySeatNo, unsigned int notifyPolicy, const char* notifyKey)
+{
+   key_value_s item;
+   key_value_s* foundItem = NULL;
+
+   if(gNotifyRegTree == NULL)
+   {
+      gNotifyRegTree = jsw_rbnew(key_val_cmp, key_val_dup, key_val_rel);
+   }
+
+   if(gNotifyRegTree != NULL)
+   {
+      item.key = notify_reg_hash(notifyLdbid, notifyUserNo, notifySeatNo, notifyKey);
+      item.value = "";
+      foundItem = (key_value_s*)jsw_rbfind(gNotifyRegTree, &item);
+
+      if(notifyPolicy == Notify_register && foundItem == NULL)
+      {
+         (void)jsw_rbinsert(gNotifyRegTree, &item);
+         if(jsw_rbsize(gNotifyRegTree) == 1)
+         {
+            dbus_bus_add_match(conn, gChangeBatchRule, NULL);
+         }
+      }
+      else if(notifyPolicy == Notify_unregister && foundItem != NULL)
+      {
+         jsw_rberase(gNotifyRegTree, foundItem);
+         if(jsw_rbsize(gNotifyRegTree) == 0)
+         {
+            dbus_bus_remove_match(conn, gChangeBatchRule, NULL);
+         }
+      }
+   }
+}
+
+
+
+int process_notification_registered(unsigned int notifyLdbid, unsigned int notifyUserNo,
+                                    unsigned int notifySeatNo, const char* notifyKey)
+{
+   int rval = 0;
+
+   if(gNotifyRegTree != NULL)
+   {
+      key_value_s item;
+
+      item.key = notify_reg_hash(notifyLdbid, notifyUserNo, notifySeatNo, notifyKey);
+      item.value = "";
+      rval = (jsw_rbfind(gNotifyRegTree, &item) != NULL) ? 1 : 0;
+   }
+
+   return rval;
+}
+
+
+
+void process_delete_notification_registry(void)
+{
+   if(gNotifyRegTree != NULL)
+   {
+      jsw_rbdelete(gNotifyRegTree);
+      gNotifyRegTree = NULL;
+   }
+}
+
+
+
 void process_reg_notification_signal(DBusConnection* conn, unsigned int notifyLdbid, unsigned int notifyUserNo,
                                                            unsigned int notifySeatNo, unsigned int notifyPolicy, const char* notifyKey)
 {
@@ -99,13 +193,20 @@ void process_reg_notification_signal(DBusConnection* conn, unsigned int notifyLd
       DLT_LOG(gPclDLTContext, DLT_LOG_VERBOSE, DLT_STRING("unREg for change notify:"), DLT_STRING(ruleChanged));
    }
 
+   notify_reg_update(conn, notifyLdbid, notifyUserNo, notifySeatNo, notifyPolicy, notifyKey);
+
    dbus_connection_flush(conn);  // flush the connection to add the match
 }
 
 
 
-void process_send_notification_signal(DBusConnection* conn, unsigned int notifyLdbid, unsigned int notifyUserNo,
-                                                            unsigned int notifySeatNo, unsigned int notifyReason, const char* notifyKey)
+/**
+ * @brief send a per key notification signal
+ *
+ * @param batched 1 if the notification has been sent with a batched signal too, the signal gets the batched marker
+ */
+static void send_notification_signal(DBusConnection* conn, unsigned int notifyLdbid, unsigned int notifyUserNo,
+                                     unsigned int notifySeatNo, unsigned int notifyReason, const char* notifyKey, int batched)
 {
    dbus_bool_t ret;
    DBusMessage* message;
@@ -152,6 +253,11 @@ void process_send_notification_signal(DBusConnection* conn, unsigned int notifyL
                                               DBUS_TYPE_STRING, &pldbidArra,
                                               DBUS_TYPE_STRING, &puserArray,
                                               DBUS_TYPE_STRING, &pseatArray, DBUS_TYPE_INVALID);
+      if(ret == TRUE && batched != 0)
+      {
+         // listeners matching the first four arguments are not affected by the marker
+         ret = dbus_message_append_args(message, DBUS_TYPE_STRING, &gBatchedMarker, DBUS_TYPE_INVALID);
+      }
       if(ret == TRUE)
       {
          if(conn != NULL)  // Send the signal
@@ -183,12 +289,106 @@ void process_send_notification_signal(DBusConnection* conn, unsigned int notifyL
 
 
 
+void process_send_notification_signal(DBusConnection* conn, unsigned int notifyLdbid, unsigned int notifyUserNo,
+                                                            unsigned int notifySeatNo, unsigned int notifyReason, const char* notifyKey)
+{
+   send_notification_signal(conn, notifyLdbid, notifyUserNo, notifySeatNo, notifyReason, notifyKey, 0);
+}
+
+
+
+void process_send_notification_batch(DBusConnection* conn, const MainLoopData_u* data, unsigned int count, int perKey)
+{
+   DBusMessage* message = NULL;
+
+   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("send notification batch - count:"), DLT_UINT(count));
+
+   message = dbus_message_new_signal(gPersAdminConsumerPath, gDbusPersAdminConsInterface, gChangeBatchSignal);
+   if(message != NULL)
+   {
+      DBusMessageIter iter, array;
+      int ok = 0;
+
+      dbus_message_iter_init_append(message, &iter);
+      if(dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "(suuuu)", &array) == TRUE)
+      {
+         unsigned int i = 0;
+
+         ok = 1;
+         for(i = 0; i < count && ok == 1; i++)
+         {
+            DBusMessageIter entry;
+            const char* pnotifyKey = data[i].string;
+
+            if(   (dbus_message_iter_open_container(&array, DBUS_TYPE_STRUCT, NULL, &entry) == TRUE)
+               && (dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &pnotifyKey) == TRUE)
+               && (dbus_message_iter_append_basic(&entry, DBUS_TYPE_UINT32, &data[i].params[0]) == TRUE)     // ldbid
+               && (dbus_message_iter_append_basic(&entry, DBUS_TYPE_UINT32, &data[i].params[1]) == TRUE)     // user
+               && (dbus_message_iter_append_basic(&entry, DBUS_TYPE_UINT32, &data[i].params[2]) == TRUE)     // seat
+               && (dbus_message_iter_append_basic(&entry, DBUS_TYPE_UINT32, &data[i].params[3]) == TRUE)     // reason
+               && (dbus_message_iter_close_container(&array, &entry) == TRUE) )
+            {
+               ok = 1;
+            }
+            else
+            {
+               ok = 0;
+            }
+         }
+
+         if(dbus_message_iter_close_container(&iter, &array) != TRUE)
+         {
+            ok = 0;
+         }
+      }
+
+      if(ok == 1)
+      {
+         if(conn != NULL)  // Send the signal
+         {
+            if(dbus_connection_send(conn, message, 0) != TRUE)
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("sendNotifyBatch - failed to send msg!!"));
+            }
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("sendNotifyBatch - Con NULL"));
+         }
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("sendNotifyBatch - _append_args"));
+      }
+      dbus_message_unref(message);
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("sendNotifyBatch - DBus No mem"));
+   }
+
+   if(perKey != 0)
+   {
+      unsigned int i = 0;
+
+      for(i = 0; i < count; i++)
+      {
+         send_notification_signal(conn, data[i].params[0], data[i].params[1], data[i].params[2], data[i].params[3], data[i].string, 1);
+      }
+   }
+}
+
+
+
 void process_block_and_write_data_back(unsigned int requestID, unsigned int status)
 {
    (void)requestID;
    (void)status;
    // lock persistence data access
    pers_lock_access();
+   // the data may be modified by the administration service while access is blocked
+   persistence_invalidate_write_hash();
+   persistence_read_cache_clear();
    // sync data back to memory device
 }
 
@@ -200,6 +400,9 @@ void process_prepare_shutdown(unsigned int complete)
 
    DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("prepShtdwn - writing all changed data / closing all handles"));
 
+   // queued asynchronous writes would fail once the access is blocked
+   (void)key_async_flush(AsyncFlushWaitMs);
+
    // block write
    pers_lock_access();
 
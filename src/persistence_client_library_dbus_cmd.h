@@ -45,6 +45,41 @@ void process_send_notification_signal(DBusConnection* conn, unsigned int notifyL
                                                             unsigned int notifySeatNo, unsigned int notifyReason, const char* notifyKey);
 
 
+/**
+ * @brief send several notifications as one batched signal (PersistenceResChangeBatch),
+ *        carrying an array of (key, ldbid, user, seat, reason) entries
+ *
+ * @param conn the dbus connection
+ * @param data the notifications (CMD_SEND_NOTIFY_SIGNAL messages)
+ * @param count the number of notifications
+ * @param perKey 1 to send the per key signals too for listeners not knowing the batched signal,
+ *               they are marked as part of a batch and ignored by listeners handling the batched signal
+ */
+void process_send_notification_batch(DBusConnection* conn, const MainLoopData_u* data, unsigned int count, int perKey);
+
+
+/**
+ * @brief check if a key has been registered for change notifications
+ *        (must be called from the dbus mainloop)
+ *
+ * @param notifyLdbid the ldbid
+ * @param notifyUserNo the user number
+ * @param notifySeatNo the seat
+ * @param notifyKey the notification key
+ *
+ * @return 1 if registered; 0 if not
+ */
+int process_notification_registered(unsigned int notifyLdbid, unsigned int notifyUserNo,
+                                    unsigned int notifySeatNo, const char* notifyKey);
+
+
+/**
+ * @brief delete the keys registered for change notifications
+ *        (must be called from the dbus mainloop)
+ */
+void process_delete_notification_registry(void);
+
+
 /**
  * @brief register for notification signal
  *
@@ -21,9 +21,15 @@
 #include "persistence_client_library_lc_interface.h"
 #include "persistence_client_library_pas_interface.h"
 #include "persistence_client_library_dbus_cmd.h"
+#include "persistence_client_library_db_access.h"
+#include "persistence_client_library_notify_queue.h"
 
 #include <errno.h>
 #include <stdlib.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
 #include <dlt.h>
 
 DLT_IMPORT_CONTEXT(gPclDLTContext);
@@ -32,12 +38,6 @@ pthread_mutex_t gDbusPendingRegMtx   = PTHREAD_MUTEX_INITIALIZER;
 pthread_cond_t  gDbusPendingCond     = PTHREAD_COND_INITIALIZER;
 int gDbusPendingCondValue            = 0;
 
-pthread_mutex_t gMainCondMtx         = PTHREAD_MUTEX_INITIALIZER;
-pthread_cond_t  gMainLoopCond        = PTHREAD_COND_INITIALIZER;
-int gMainLoopCondValue               = 0;
-
-pthread_mutex_t gDeliverpMtx         = PTHREAD_MUTEX_INITIALIZER;
-
 pthread_t gMainLoopThread;
 
 const char* gDbusLcConsDest    = "org.genivi.NodeStateManager";
@@ -55,45 +55,105 @@ const char* gDbusPersAdminPath          = "/org/genivi/persistence/admin";
 const char* gDbusPersAdminInterface     = "org.genivi.persistence.admin";
 const char* gDbusPersAdminConsMsg       = "PersistenceAdminRequest";
 
-/// communication channel into the dbus mainloop
-static int gPipeFd[2] = {-1};
+/// completion of a command the producer waits for
+typedef struct _PersMainLoopDone_s
+{
+   /// posted when the command has been dispatched or dropped
+   sem_t sem;
+   /// 0 if the command has been dispatched, -1 if it has been dropped because the mainloop has stopped
+   int rval;
+} PersMainLoopDone_s;
+
+/// command slot of the mainloop command ring
+typedef struct _PersMainLoopSlot_s
+{
+   /// position + 1 if the command is ready to be dispatched, position + MainLoopRingSize if the slot is free
+   volatile unsigned int sequence;
+   /// completed when the command has been dispatched, NULL if nobody waits for the command
+   PersMainLoopDone_s* done;
+   /// the command
+   MainLoopData_u data;
+} PersMainLoopSlot_s;
+
+/// commands to the dbus mainloop, a bounded lock-free multi producer single consumer ring
+static PersMainLoopSlot_s gMainLoopRing[MainLoopRingSize];
+/// next ring position claimed by a producer
+static volatile unsigned int gMainLoopTail = 0;
+/// next ring position dispatched by the mainloop, only used by the mainloop
+static unsigned int gMainLoopHead = 0;
+/// eventfd to wake up the mainloop, the commands are passed with the ring
+static int gMainLoopEventFd = -1;
+/// set if the mainloop has been woken up and has not started dispatching, saves redundant eventfd writes
+static volatile int gMainLoopWakeup = 0;
+/// set if the mainloop does not accept commands anymore, the eventfd is closed only after all producers have seen it
+static volatile int gMainLoopStopped = 1;
+/// number of producers appending a command to the ring
+static volatile int gMainLoopProducers = 0;
 
 
 typedef enum EDBusObjectType
 {
    OT_NONE = 0,
    OT_WATCH,
-   OT_TIMEOUT
+   OT_TIMEOUT,
+   OT_WAKEUP
 } tDBusObjectType;
 
 
 
-/// object entry
-typedef struct SObjectEntry
+struct SLoopWatch;
+
+/// file descriptor registered with the epoll instance of the mainloop
+typedef struct SLoopFd
 {
-   tDBusObjectType objtype;	/// libdbus' object
-   union
-   {
-      DBusWatch * watch;		/// watch "object"
-      DBusTimeout * timeout;	/// timeout "object"
-   };
-} tObjectEntry;
+   tDBusObjectType objtype;         /// OT_WATCH: libdbus' watches, OT_TIMEOUT: the timerfd, OT_WAKEUP: the wake-up eventfd
+   int fd;                          /// the file descriptor
+   uint32_t events;                 /// events registered with epoll, 0 if not registered
+   struct SLoopWatch* watches;      /// watches of the file descriptor (OT_WATCH)
+   struct SLoopFd* next;            /// next file descriptor with watches
+} tLoopFd;
 
 
 
-/// polling structure
-typedef struct SPollInfo
+/// libdbus' watch "object", libdbus may watch a file descriptor with several watches
+typedef struct SLoopWatch
 {
-   nfds_t nfds;						/// number of polls
-   struct pollfd fds[10];		/// poll file descriptors array
-   tObjectEntry objects[10];	/// poll object
-} tPollInfo;
+   DBusWatch* watch;                /// the watch
+   tLoopFd* loopFd;                 /// the file descriptor of the watch
+   struct SLoopWatch* next;         /// next watch of the same file descriptor
+} tLoopWatch;
 
 
-/// polling information
-static tPollInfo gPollInfo;
 
-#define ARRAY_SIZE(a) (sizeof(a)/sizeof(a[0]))
+/// libdbus' timeout "object", all timeouts share one timerfd
+typedef struct SLoopTimer
+{
+   DBusTimeout* timeout;            /// the timeout
+   unsigned long long expires;      /// expiration time [ns, CLOCK_MONOTONIC]
+   int heapIndex;                   /// position in the timer heap, -1 if the timeout is disabled
+} tLoopTimer;
+
+
+/// epoll instance of the mainloop
+static int gEpollFd = -1;
+/// timerfd of all timeouts, armed for the timeout expiring first
+static int gTimerFd = -1;
+/// expiration time the timerfd has been armed for, 0 if disarmed
+static unsigned long long gTimerArmed = 0;
+
+/// epoll registrations of the wake-up eventfd and the timerfd
+static tLoopFd gWakeupLoopFd = { OT_WAKEUP, -1, 0, NULL, NULL };
+static tLoopFd gTimerLoopFd  = { OT_TIMEOUT, -1, 0, NULL, NULL };
+
+/// file descriptors with watches
+static tLoopFd* gWatchFds = NULL;
+/// changed each time a watch is added, removed or toggled: pending epoll events may refer to released watches
+static unsigned int gWatchGeneration = 0;
+
+/// enabled timeouts, a binary min-heap ordered by expiration time
+static tLoopTimer** gTimerHeap = NULL;
+static unsigned int gTimerHeapCount = 0;
+static unsigned int gTimerHeapCapacity = 0;
 
 
 /* function to unregister ojbect path message handler */
@@ -146,6 +206,79 @@ void* registerToPas(void* data)
 
 
 
+/* call the change callback for the registered keys of a batched change signal */
+static void handleNotificationBatch(DBusMessage * message)
+{
+   DBusMessageIter iter, array;
+
+   if(   (dbus_message_iter_init(message, &iter) == TRUE)
+      && (dbus_message_iter_get_arg_type(&iter) == DBUS_TYPE_ARRAY)
+      && (dbus_message_iter_get_element_type(&iter) == DBUS_TYPE_STRUCT) )
+   {
+      dbus_message_iter_recurse(&iter, &array);
+      while(dbus_message_iter_get_arg_type(&array) == DBUS_TYPE_STRUCT)
+      {
+         DBusMessageIter entry;
+         const char* resource_id = NULL;
+         dbus_uint32_t values[4] = {0};    // ldbid, user, seat, reason
+         int i = 0, valid = 0;
+
+         dbus_message_iter_recurse(&array, &entry);
+         if(dbus_message_iter_get_arg_type(&entry) == DBUS_TYPE_STRING)
+         {
+            dbus_message_iter_get_basic(&entry, &resource_id);
+            valid = 1;
+         }
+         for(i = 0; i < 4 && valid == 1; i++)
+         {
+            if(   (dbus_message_iter_next(&entry) == TRUE)
+               && (dbus_message_iter_get_arg_type(&entry) == DBUS_TYPE_UINT32) )
+            {
+               dbus_message_iter_get_basic(&entry, &values[i]);
+            }
+            else
+            {
+               valid = 0;
+            }
+         }
+
+         if(valid == 1 && values[3] < pclNotifyStatus_lastEntry)
+         {
+            // the batched signal is not filtered by dbus, only keys registered in this process are notified
+            if(process_notification_registered(values[0], values[1], values[2], resource_id) == 1)
+            {
+               pclNotification_s notifyStruct;
+
+               notifyStruct.pclKeyNotify_Status = (pclNotifyStatus_e)values[3];
+               notifyStruct.resource_id = resource_id;
+               notifyStruct.ldbid       = values[0];
+               notifyStruct.user_no     = values[1];
+               notifyStruct.seat_no     = values[2];
+
+               // the value has been changed by another process
+               persistence_read_cache_invalidate_key(notifyStruct.ldbid, notifyStruct.resource_id);
+
+               if(gChangeNotifyCallback != NULL )  // call the registered callback function
+               {
+                  gChangeNotifyCallback(&notifyStruct);
+               }
+            }
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("handleNotifyBatch - invalid entry"));
+         }
+         dbus_message_iter_next(&array);
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("handleNotifyBatch - invalid signature"), DLT_STRING(dbus_message_get_signature(message)));
+   }
+}
+
+
+
 /* catches messages not directed to any registered object path ("garbage collector") */
 static DBusHandlerResult handleObjectPathMessageFallback(DBusConnection * connection, DBusMessage * message, void * user_data)
 {
@@ -177,8 +310,17 @@ static DBusHandlerResult handleObjectPathMessageFallback(DBusConnection * connec
             notifyStruct.pclKeyNotify_Status = pclNotifyStatus_created;
             validMessage = 1;
          }
+         else if((0==strcmp("PersistenceResChangeBatch", dbus_message_get_member(message))))
+         {
+            validMessage = 2;
+         }
 
-         if(validMessage == 1)
+         if(validMessage == 1 && dbus_message_has_signature(message, "sssss") == TRUE)
+         {
+            // per key signal with the batched marker, the notification is delivered with the batched signal
+            result = DBUS_HANDLER_RESULT_HANDLED;
+         }
+         else if(validMessage == 1)
          {
             char *ldbid, *user_no, *seat_no;
 
@@ -209,6 +351,9 @@ static DBusHandlerResult handleObjectPathMessageFallback(DBusConnection * connec
                notifyStruct.user_no     = (unsigned int)atoi(user_no);
                notifyStruct.seat_no     = (unsigned int)atoi(seat_no);
 
+               // the value has been changed by another process
+               persistence_read_cache_invalidate_key(notifyStruct.ldbid, notifyStruct.resource_id);
+
                if(gChangeNotifyCallback != NULL )  // call the registered callback function
                {
                   gChangeNotifyCallback(&notifyStruct);
@@ -221,6 +366,11 @@ static DBusHandlerResult handleObjectPathMessageFallback(DBusConnection * connec
             }
             dbus_connection_flush(connection);
          }
+         else if(validMessage == 2)
+         {
+            handleNotificationBatch(message);
+            result = DBUS_HANDLER_RESULT_HANDLED;
+         }
          else
          {
             result = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
@@ -317,35 +467,109 @@ static void  unregisterObjectPathFallback(DBusConnection *connection, void *user
 
 
 
-static dbus_bool_t addWatch(DBusWatch *watch, void *data)
+/**
+ * @brief register the events of all enabled watches of a file descriptor with epoll,
+ *        the file descriptor is removed from epoll if no watch is enabled
+ *
+ * @return 0 on success, -1 on error
+ */
+static int updateWatchFd(tLoopFd* loopFd)
 {
-   dbus_bool_t result = FALSE;
-   (void)data;
+   int rval = 0;
+   uint32_t events = 0;
+   tLoopWatch* loopWatch = NULL;
 
-   if (ARRAY_SIZE(gPollInfo.fds) > (unsigned int)(gPollInfo.nfds))
+   for(loopWatch = loopFd->watches; loopWatch != NULL; loopWatch = loopWatch->next)
    {
-      unsigned int flags = dbus_watch_get_flags(watch);
-
-      tObjectEntry * const pEntry = &gPollInfo.objects[gPollInfo.nfds];
-      pEntry->objtype = OT_WATCH;
-      pEntry->watch = watch;
-
-      gPollInfo.fds[gPollInfo.nfds].fd = dbus_watch_get_unix_fd(watch);
-
-      if (TRUE==dbus_watch_get_enabled(watch))
+      if (TRUE==dbus_watch_get_enabled(loopWatch->watch))
       {
+         unsigned int flags = dbus_watch_get_flags(loopWatch->watch);
+
          if (flags&DBUS_WATCH_READABLE)
          {
-            gPollInfo.fds[gPollInfo.nfds].events |= POLLIN;
+            events |= EPOLLIN;
          }
          if (flags&DBUS_WATCH_WRITABLE)
          {
-            gPollInfo.fds[gPollInfo.nfds].events |= POLLOUT;
+            events |= EPOLLOUT;
          }
+      }
+   }
+
+   if(events != loopFd->events)
+   {
+      struct epoll_event event;
+      int op = (events == 0) ? EPOLL_CTL_DEL : ((loopFd->events == 0) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD);
+
+      memset(&event, 0, sizeof(event));
+      event.events = events;
+      event.data.ptr = loopFd;
 
-         ++gPollInfo.nfds;
+      if(-1 != epoll_ctl(gEpollFd, op, loopFd->fd, &event))
+      {
+         loopFd->events = events;
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("updateWatchFd - epoll_ctl() failed"), DLT_STRING(strerror(errno)) );
+         rval = -1;
       }
-      result = TRUE;
+   }
+
+   return rval;
+}
+
+
+
+static void removeWatch(DBusWatch *watch, void *data);
+
+static dbus_bool_t addWatch(DBusWatch *watch, void *data)
+{
+   dbus_bool_t result = FALSE;
+   const int fd = dbus_watch_get_unix_fd(watch);
+   tLoopWatch* loopWatch = malloc(sizeof(tLoopWatch));
+   tLoopFd* loopFd = gWatchFds;
+   (void)data;
+
+   while((loopFd != NULL) && (loopFd->fd != fd))
+   {
+      loopFd = loopFd->next;
+   }
+
+   if((loopFd == NULL) && (loopWatch != NULL))
+   {
+      loopFd = calloc(1, sizeof(tLoopFd));
+      if(loopFd != NULL)
+      {
+         loopFd->objtype = OT_WATCH;
+         loopFd->fd = fd;
+         loopFd->next = gWatchFds;
+         gWatchFds = loopFd;
+      }
+   }
+
+   if((loopWatch != NULL) && (loopFd != NULL))
+   {
+      loopWatch->watch = watch;
+      loopWatch->loopFd = loopFd;
+      loopWatch->next = loopFd->watches;
+      loopFd->watches = loopWatch;
+      dbus_watch_set_data(watch, loopWatch, NULL);
+      gWatchGeneration++;
+
+      if(0 == updateWatchFd(loopFd))
+      {
+         result = TRUE;
+      }
+      else
+      {
+         removeWatch(watch, data);
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("addWatch - failed to allocate watch"));
+      free(loopWatch);
    }
 
    return result;
@@ -355,14 +579,43 @@ static dbus_bool_t addWatch(DBusWatch *watch, void *data)
 
 static void removeWatch(DBusWatch *watch, void *data)
 {
-   void* w_data = dbus_watch_get_data(watch);
+   tLoopWatch* loopWatch = dbus_watch_get_data(watch);
 
    (void)data;
 
    DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("removeWatch called "), DLT_INT64( (long)watch) );
 
-   if(w_data)
-      free(w_data);
+   if(loopWatch != NULL)
+   {
+      tLoopFd* loopFd = loopWatch->loopFd;
+      tLoopWatch** link = &loopFd->watches;
+
+      while(*link != loopWatch)
+      {
+         link = &(*link)->next;
+      }
+      *link = loopWatch->next;
+      free(loopWatch);
+
+      if(loopFd->watches == NULL)      // last watch of the file descriptor
+      {
+         tLoopFd** fdLink = &gWatchFds;
+
+         (void)updateWatchFd(loopFd);
+
+         while(*fdLink != loopFd)
+         {
+            fdLink = &(*fdLink)->next;
+         }
+         *fdLink = loopFd->next;
+         free(loopFd);
+      }
+      else
+      {
+         (void)updateWatchFd(loopFd);
+      }
+      gWatchGeneration++;
+   }
 
    dbus_watch_set_data(watch, NULL, NULL);
 }
@@ -371,55 +624,207 @@ static void removeWatch(DBusWatch *watch, void *data)
 
 static void watchToggled(DBusWatch *watch, void *data)
 {
+   tLoopWatch* loopWatch = dbus_watch_get_data(watch);
    (void)data;
    DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("watchToggled called "), DLT_INT64( (long)watch) );
 
-   if(dbus_watch_get_enabled(watch))
-      addWatch(watch, data);
-   else
-      removeWatch(watch, data);
+   if(loopWatch != NULL)
+   {
+      (void)updateWatchFd(loopWatch->loopFd);
+      gWatchGeneration++;
+   }
+}
+
+
+
+static unsigned long long monotonicNs(void)
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return (unsigned long long)now.tv_sec * 1000000000ULL + (unsigned long long)now.tv_nsec;
+}
+
+
+
+/// expiration time of a timeout started now [ns]
+static unsigned long long timeoutExpires(DBusTimeout *timeout)
+{
+   int interval = dbus_timeout_get_interval(timeout);   // [ms]
+
+   return monotonicNs() + (unsigned long long)((interval > 0) ? interval : 1) * 1000000ULL;
+}
+
+
+
+static void timerHeapSet(unsigned int index, tLoopTimer* timer)
+{
+   gTimerHeap[index] = timer;
+   timer->heapIndex = (int)index;
+}
+
+
+
+static void timerHeapUp(unsigned int index)
+{
+   tLoopTimer* timer = gTimerHeap[index];
+
+   while(index > 0)
+   {
+      unsigned int parent = (index - 1) / 2;
+
+      if(gTimerHeap[parent]->expires <= timer->expires)
+      {
+         break;
+      }
+      timerHeapSet(index, gTimerHeap[parent]);
+      index = parent;
+   }
+   timerHeapSet(index, timer);
+}
+
+
+
+static void timerHeapDown(unsigned int index)
+{
+   tLoopTimer* timer = gTimerHeap[index];
+
+   for(;;)
+   {
+      unsigned int child = 2 * index + 1;
+
+      if(child >= gTimerHeapCount)
+      {
+         break;
+      }
+      if((child + 1 < gTimerHeapCount) && (gTimerHeap[child + 1]->expires < gTimerHeap[child]->expires))
+      {
+         child++;
+      }
+      if(timer->expires <= gTimerHeap[child]->expires)
+      {
+         break;
+      }
+      timerHeapSet(index, gTimerHeap[child]);
+      index = child;
+   }
+   timerHeapSet(index, timer);
+}
+
+
+
+/**
+ * @brief add a timeout to the timer heap
+ *
+ * @return 0 on success, -1 if the heap could not be enlarged
+ */
+static int timerHeapInsert(tLoopTimer* timer)
+{
+   if(gTimerHeapCount == gTimerHeapCapacity)
+   {
+      unsigned int capacity = (gTimerHeapCapacity == 0) ? MainLoopTimerHeapSize : 2 * gTimerHeapCapacity;
+      tLoopTimer** heap = realloc(gTimerHeap, capacity * sizeof(tLoopTimer*));
+
+      if(heap == NULL)
+      {
+         return -1;
+      }
+      gTimerHeap = heap;
+      gTimerHeapCapacity = capacity;
+   }
+
+   gTimerHeap[gTimerHeapCount] = timer;
+   timerHeapUp(gTimerHeapCount++);
+
+   return 0;
+}
+
+
+
+static void timerHeapRemove(tLoopTimer* timer)
+{
+   unsigned int index = (unsigned int)timer->heapIndex;
+   tLoopTimer* last = gTimerHeap[--gTimerHeapCount];
+
+   timer->heapIndex = -1;
+
+   if(last != timer)
+   {
+      gTimerHeap[index] = last;
+      if((index > 0) && (last->expires < gTimerHeap[(index - 1) / 2]->expires))
+      {
+         timerHeapUp(index);
+      }
+      else
+      {
+         timerHeapDown(index);
+      }
+   }
+}
+
+
+
+/// arm the timerfd for the timeout expiring first, disarm it if no timeout is enabled
+static void timerRearm(void)
+{
+   unsigned long long expires = (gTimerHeapCount > 0) ? gTimerHeap[0]->expires : 0;
+
+   if(expires != gTimerArmed)
+   {
+      struct itimerspec its;
+
+      memset(&its, 0, sizeof(its));
+      its.it_value.tv_sec  = (time_t)(expires / 1000000000ULL);
+      its.it_value.tv_nsec = (long)(expires % 1000000000ULL);
+
+      if (-1!=timerfd_settime(gTimerFd, TFD_TIMER_ABSTIME, &its, NULL))
+      {
+         gTimerArmed = expires;
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("timerRearm - timerfd_settime()"), DLT_STRING(strerror(errno)) );
+      }
+   }
 }
 
 
 
 static dbus_bool_t addTimeout(DBusTimeout *timeout, void *data)
 {
-   (void)data;
    dbus_bool_t ret = FALSE;
+   tLoopTimer* timer = malloc(sizeof(tLoopTimer));
+   (void)data;
 
-   if(ARRAY_SIZE(gPollInfo.fds) > (unsigned int)(gPollInfo.nfds))
+   if(timer != NULL)
    {
-      const int interval = dbus_timeout_get_interval(timeout);
-      if ((0<interval)&&(TRUE==dbus_timeout_get_enabled(timeout)))
+      timer->timeout = timeout;
+      timer->heapIndex = -1;
+
+      if (TRUE==dbus_timeout_get_enabled(timeout))
       {
-         const int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
-         if (-1!=tfd)
+         timer->expires = timeoutExpires(timeout);
+         if(0 == timerHeapInsert(timer))
          {
-            const struct itimerspec its = { .it_value= {interval/1000, interval%1000} };
-            if (-1!=timerfd_settime(tfd, 0, &its, NULL))
-            {
-               tObjectEntry * const pEntry = &gPollInfo.objects[gPollInfo.nfds];
-               pEntry->objtype = OT_TIMEOUT;
-               pEntry->timeout = timeout;
-               gPollInfo.fds[gPollInfo.nfds].fd = tfd;
-               gPollInfo.fds[gPollInfo.nfds].events |= POLLIN;
-               ++gPollInfo.nfds;
-               ret = TRUE;
-            }
-            else
-            {
-               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("addTimeout - _settime() failed"), DLT_STRING(strerror(errno)) );
-            }
-         }
-         else
-         {
-            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("addTimeout - _create() failed"), DLT_STRING(strerror(errno)) );
+            timerRearm();
+            ret = TRUE;
          }
       }
+      else
+      {
+         ret = TRUE;
+      }
+   }
+
+   if(ret == TRUE)
+   {
+      dbus_timeout_set_data(timeout, timer, NULL);
    }
    else
    {
-      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("addTimeout - cannot create another fd to be poll()'ed"));
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("addTimeout - failed to allocate timeout"));
+      free(timer);
    }
    return ret;
 }
@@ -428,50 +833,219 @@ static dbus_bool_t addTimeout(DBusTimeout *timeout, void *data)
 
 static void removeTimeout(DBusTimeout *timeout, void *data)
 {
-   int i = (int)gPollInfo.nfds;
-  (void)data;
+   tLoopTimer* timer = dbus_timeout_get_data(timeout);
+   (void)data;
 
-   while ((0<i--)&&(timeout!=gPollInfo.objects[i].timeout));
+   if(timer != NULL)
+   {
+      if(timer->heapIndex >= 0)
+      {
+         timerHeapRemove(timer);
+         timerRearm();
+      }
+      free(timer);
+   }
 
-   if (0<i)
+   dbus_timeout_set_data(timeout, NULL, NULL);
+}
+
+
+
+// callback for libdbus' when timeout changed
+static void timeoutToggled(DBusTimeout *timeout, void *data)
+{
+   tLoopTimer* timer = dbus_timeout_get_data(timeout);
+   (void)data;
+
+   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("timeoutToggled") );
+   if(timer != NULL)
    {
-      if (-1==close(gPollInfo.fds[i].fd))
+      if(timer->heapIndex >= 0)
       {
-         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("removeTimeout - close() timerfd"), DLT_STRING(strerror(errno)) );
+         timerHeapRemove(timer);
       }
+      if (TRUE==dbus_timeout_get_enabled(timeout))    // restart the timeout
+      {
+         timer->expires = timeoutExpires(timeout);
+         if(0 != timerHeapInsert(timer))
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("timeoutToggled - failed to enlarge timer heap"));
+         }
+      }
+      timerRearm();
+   }
+}
 
-      --gPollInfo.nfds;
-      while (gPollInfo.nfds>i)
+
+
+/**
+ * @brief handle all expired timeouts, periodic timeouts are restarted before they are handled
+ */
+static void handleTimeouts(void)
+{
+   unsigned long long nExpCount = 0;
+   unsigned long long now = 0;
+
+   if ((ssize_t)sizeof(nExpCount)!=read(gTimerFd, &nExpCount, sizeof(nExpCount)))
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("mainLoop - read failed"));
+   }
+   gTimerArmed = 0;     // the timerfd is disarmed after it has expired
+
+   now = monotonicNs();
+   while((gTimerHeapCount > 0) && (gTimerHeap[0]->expires <= now))
+   {
+      tLoopTimer* timer = gTimerHeap[0];
+
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("mainLoop - timeout"));
+
+      timer->expires = timeoutExpires(timer->timeout);
+      timerHeapDown(0);
+
+      if (FALSE==dbus_timeout_handle(timer->timeout))     // may remove or toggle the timeout
       {
-         gPollInfo.fds[i] = gPollInfo.fds[i+1];
-         gPollInfo.objects[i] = gPollInfo.objects[i+1];
-         ++i;
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("mainLoop - _timeout_handle() failed!?"));
       }
+   }
+
+   timerRearm();
+}
 
-      gPollInfo.fds[gPollInfo.nfds].fd = -1;
-      gPollInfo.objects[gPollInfo.nfds].objtype = OT_NONE;
+
+
+/**
+ * @brief handle the watches of a file descriptor reported by epoll
+ *
+ * @return FALSE if libdbus ran out of memory; TRUE if not
+ */
+static int handleWatches(tLoopFd* loopFd, uint32_t events)
+{
+   int rval = TRUE;
+   unsigned int flags = 0;
+   const unsigned int generation = gWatchGeneration;
+   tLoopWatch* loopWatch = loopFd->watches;
+
+   if (0!=(events & EPOLLIN))
+   {
+      flags |= DBUS_WATCH_READABLE;
+   }
+   if (0!=(events & EPOLLOUT))
+   {
+      flags |= DBUS_WATCH_WRITABLE;
    }
+   if (0!=(events & EPOLLERR))
+   {
+      flags |= DBUS_WATCH_ERROR;
+   }
+   if (0!=(events & EPOLLHUP))
+   {
+      flags |= DBUS_WATCH_HANGUP;
+   }
+
+   while(loopWatch != NULL)
+   {
+      if (TRUE==dbus_watch_get_enabled(loopWatch->watch))
+      {
+         unsigned int watchFlags = flags & (dbus_watch_get_flags(loopWatch->watch) | DBUS_WATCH_ERROR | DBUS_WATCH_HANGUP);
+
+         if(watchFlags != 0)
+         {
+            rval = (int)dbus_watch_handle(loopWatch->watch, watchFlags);
+         }
+      }
+
+      if(generation != gWatchGeneration)
+      {
+         break;      // watches have changed, the remaining ones are reported again by the next epoll_wait
+      }
+      loopWatch = loopWatch->next;
+   }
+
+   return rval;
 }
 
 
 
-// callback for libdbus' when timeout changed
-static void timeoutToggled(DBusTimeout *timeout, void *data)
+static void stopMainLoopRing(void);
+
+/// close the file descriptors of the mainloop, after the dbus connection has been released
+static void closeMainLoopFds(void)
 {
-   int i = (int)gPollInfo.nfds;
-   (void)data;
+   if(gEpollFd != -1)
+   {
+      close(gEpollFd);
+      gEpollFd = -1;
+   }
+   if(gTimerFd != -1)
+   {
+      close(gTimerFd);
+      gTimerFd = -1;
+   }
+   if(gMainLoopEventFd != -1)
+   {
+      close(gMainLoopEventFd);
+      gMainLoopEventFd = -1;
+   }
 
-   while ((0<i--)&&(timeout!=gPollInfo.objects[i].timeout));
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("timeoutToggled") );
-   if (0<i)
+   free(gTimerHeap);
+   gTimerHeap = NULL;
+   gTimerHeapCount = 0;
+   gTimerHeapCapacity = 0;
+   gTimerArmed = 0;
+}
+
+
+
+/**
+ * @brief create the epoll instance of the mainloop, the wake-up eventfd and the timerfd
+ *
+ * @return 0 on success, -1 on error
+ */
+static int createMainLoopFds(void)
+{
+   int rval = -1;
+   struct epoll_event event;
+
+   memset(&event, 0, sizeof(event));
+   event.events = EPOLLIN;
+
+   if (-1 == (gMainLoopEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)))    // create wake-up eventfd of the dbus mainloop
    {
-      const int interval = (TRUE==dbus_timeout_get_enabled(timeout))?dbus_timeout_get_interval(timeout):0;
-      const struct itimerspec its = { .it_value= {interval/1000, interval%1000} };
-      if (-1!=timerfd_settime(gPollInfo.fds[i].fd, 0, &its, NULL))
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("mainLoop - eventfd() failed w/ errno:"), DLT_INT(errno) );
+   }
+   else if (-1 == (gTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)))
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("mainLoop - timerfd_create() failed w/ errno:"), DLT_INT(errno) );
+   }
+   else if (-1 == (gEpollFd = epoll_create1(EPOLL_CLOEXEC)))
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("mainLoop - epoll_create1() failed w/ errno:"), DLT_INT(errno) );
+   }
+   else
+   {
+      gWakeupLoopFd.fd = gMainLoopEventFd;
+      gWakeupLoopFd.events = EPOLLIN;
+      event.data.ptr = &gWakeupLoopFd;
+
+      if(-1 != epoll_ctl(gEpollFd, EPOLL_CTL_ADD, gMainLoopEventFd, &event))
+      {
+         gTimerLoopFd.fd = gTimerFd;
+         gTimerLoopFd.events = EPOLLIN;
+         event.data.ptr = &gTimerLoopFd;
+
+         if(-1 != epoll_ctl(gEpollFd, EPOLL_CTL_ADD, gTimerFd, &event))
+         {
+            rval = 0;
+         }
+      }
+
+      if(rval != 0)
       {
-         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("timeoutToggled - timerfd_settime()"), DLT_STRING(strerror(errno)) );
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("mainLoop - epoll_ctl() failed w/ errno:"), DLT_INT(errno) );
       }
    }
+
+   return rval;
 }
 
 
@@ -527,9 +1101,9 @@ int setup_dbus_mainloop(void)
       }
    }
 
-   if (-1 == (pipe(gPipeFd)))    // create communication pipe with the dbus mainloop
+   if (-1 == createMainLoopFds())    // create epoll instance, wake-up eventfd and timerfd of the dbus mainloop
    {
-      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("mainLoop - eventfd() failed w/ errno:"), DLT_INT(errno) );
+      closeMainLoopFds();
       rval = EPERS_COMMON;
    }
    else
@@ -545,10 +1119,18 @@ int setup_dbus_mainloop(void)
       (void)vtablePersAdmin;
 #endif
 
-      memset(&gPollInfo, 0 , sizeof(gPollInfo));
-      gPollInfo.nfds = 1;
-      gPollInfo.fds[0].fd = gPipeFd[0];
-      gPollInfo.fds[0].events = POLLIN;
+      unsigned int i = 0;
+
+      for(i = 0; i < MainLoopRingSize; i++)     // all slots free
+      {
+         gMainLoopRing[i].sequence = i;
+         gMainLoopRing[i].done = NULL;
+      }
+      gMainLoopTail = 0;
+      gMainLoopHead = 0;
+      gMainLoopWakeup = 0;
+      __sync_synchronize();      // the ring is reset before commands are accepted
+      gMainLoopStopped = 0;
 
       dbus_bus_add_match(conn, "type='signal',interface='org.genivi.persistence.admin',member='PersistenceModeChanged',path='/org/genivi/persistence/admin'", &err);
 #if USE_PASINTERFACE
@@ -591,14 +1173,8 @@ int setup_dbus_mainloop(void)
       }
    }
 
-   if(doCleanup)     // close pipe and close dbus connection if anything goes wrong setting up
+   if(doCleanup)     // close dbus connection and the file descriptors of the mainloop if anything goes wrong setting up
    {
-      if(gPipeFd[0] != -1)
-      {
-         close(gPipeFd[0]);
-         close(gPipeFd[1]);
-      }
-
 #if USE_PASINTERFACE == 1
       dbus_connection_unregister_object_path(conn, gPersAdminConsumerPath);
 #endif
@@ -610,6 +1186,8 @@ int setup_dbus_mainloop(void)
       //dbus_shutdown();   // according to dbus documentation it is not neccessary to call dbus_shutdown:
                            // There is absolutely no requirement to call dbus_shutdown() - in fact, most applications won't bother and should not feel guilty.
 
+      stopMainLoopRing();
+      closeMainLoopFds();
       rval = EPERS_COMMON;
    }
 
@@ -650,6 +1228,10 @@ int dispatchInternalCommand(DBusConnection* conn, MainLoopData_u* readData, int*
                                                 (unsigned int)readData->params[2] /*seat*/,  (unsigned int)readData->params[3], /*reason*/
                                                 readData->string);
          break;
+      case CMD_SEND_NOTIFY_BATCH:
+         process_send_notification_batch(conn, notify_queue_entries((unsigned int)readData->params[0] /*index*/),
+                                               (unsigned int)readData->params[1] /*count*/, (int)readData->params[2] /*perKey*/);
+         break;
       case CMD_REG_NOTIFY_SIGNAL:
          process_reg_notification_signal(conn, (unsigned int)readData->params[0] /*ldbid*/, (unsigned int)readData->params[1], /*user*/
                                                (unsigned int)readData->params[2] /*seat*/,  (unsigned int)readData->params[3], /*,policy*/
@@ -661,6 +1243,8 @@ int dispatchInternalCommand(DBusConnection* conn, MainLoopData_u* readData, int*
       case CMD_SEND_LC_REGISTER:
          process_send_lifecycle_register(conn, (int)readData->params[0] /*regType*/, (int)readData->params[1] /*mode*/);
          break;
+      case CMD_NOP:
+         break;
       case CMD_QUIT:
          rval = 0;
          *quit = TRUE;
@@ -675,9 +1259,93 @@ int dispatchInternalCommand(DBusConnection* conn, MainLoopData_u* readData, int*
 
 
 
+/**
+ * @brief dispatch the commands of the ring in the order they have been claimed,
+ *        stops at the first command not yet completely written by its producer
+ *
+ * @return 0 if the mainloop must stop; 1 if not
+ */
+static int dispatchMainLoopRing(DBusConnection* conn, int* quit)
+{
+   int rval = 1;
+
+   while(*quit == FALSE)
+   {
+      PersMainLoopSlot_s* slot = &gMainLoopRing[gMainLoopHead & (MainLoopRingSize - 1)];
+      PersMainLoopDone_s* done = NULL;
+
+      if((int)(slot->sequence - (gMainLoopHead + 1)) < 0)
+      {
+         break;      // empty, or the producer is still writing the command
+      }
+      __sync_synchronize();   // read the command after the sequence
+
+      rval = dispatchInternalCommand(conn, &slot->data, quit);
+
+      done = slot->done;
+      slot->done = NULL;
+      __sync_synchronize();   // the command has been read before the slot is released
+      slot->sequence = gMainLoopHead + MainLoopRingSize;
+      gMainLoopHead++;
+
+      if(done != NULL)
+      {
+         done->rval = 0;
+         sem_post(&done->sem);
+      }
+   }
+
+   return rval;
+}
+
+
+
+/**
+ * @brief stop accepting commands and drop the commands not dispatched,
+ *        the producers waiting for a dropped command are released with an error
+ */
+static void stopMainLoopRing(void)
+{
+   unsigned int tail = 0, dropped = 0;
+
+   (void)__sync_lock_test_and_set(&gMainLoopStopped, 1);
+   __sync_synchronize();      // stopped before the producers are checked
+
+   while(__sync_add_and_fetch(&gMainLoopProducers, 0) > 0)     // producers not having seen the flag complete their command
+   {
+      (void)sched_yield();
+   }
+
+   tail = gMainLoopTail;
+   while(gMainLoopHead != tail)
+   {
+      PersMainLoopSlot_s* slot = &gMainLoopRing[gMainLoopHead & (MainLoopRingSize - 1)];
+      PersMainLoopDone_s* done = slot->done;
+
+      slot->done = NULL;
+      slot->sequence = gMainLoopHead + MainLoopRingSize;
+      gMainLoopHead++;
+      dropped++;
+
+      if(done != NULL)
+      {
+         done->rval = -1;
+         sem_post(&done->sem);
+      }
+   }
+
+   if(dropped > 0)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("mainLoop - cmds dropped after quit:"), DLT_UINT(dropped));
+   }
+}
+
+
+
 void* mainLoop(void* userData)
 {
    int ret, bContinue = 0;   /// indicator if dbus mainloop shall continue
+   struct epoll_event events[MainLoopEpollEvents];
 
    DBusConnection* conn = (DBusConnection*)userData;
 
@@ -685,95 +1353,57 @@ void* mainLoop(void* userData)
    {
       while(DBUS_DISPATCH_DATA_REMAINS==dbus_connection_dispatch(conn));
 
-      while ((-1==(ret=poll(gPollInfo.fds, gPollInfo.nfds, -1)))&&(EINTR==errno));
+      while ((-1==(ret=epoll_wait(gEpollFd, events, MainLoopEpollEvents, -1)))&&(EINTR==errno));
 
       if (0>ret)
       {
-         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("mainLoop - poll() failed w/ errno "), DLT_INT(errno) );
-      }
-      else if (0==ret)
-      {
-         /* poll time-out */
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("mainLoop - epoll_wait() failed w/ errno "), DLT_INT(errno) );
       }
       else
       {
          int i, bQuit = FALSE;
+         const unsigned int generation = gWatchGeneration;
 
-         for (i=0; gPollInfo.nfds>i && !bQuit; ++i)
+         // only the ready file descriptors are reported; once watches have changed, the remaining
+         // events may refer to released watches, they are reported again by the next epoll_wait
+         for (i=0; ret>i && !bQuit && generation==gWatchGeneration; ++i)
          {
-            if (0!=gPollInfo.fds[i].revents)    // anything to do
+            tLoopFd* loopFd = (tLoopFd*)events[i].data.ptr;
+
+            if (OT_TIMEOUT==loopFd->objtype)
             {
-               if (OT_TIMEOUT==gPollInfo.objects[i].objtype)
+               handleTimeouts();
+               bContinue = TRUE;
+            }
+            else if (OT_WAKEUP==loopFd->objtype)
+            {
+               if (0!=(events[i].events & EPOLLIN))  // dispatch internal commands
                {
-                  unsigned long long nExpCount = 0;   // time-out occured
+                  eventfd_t wakeups = 0;
 
-                  if ((ssize_t)sizeof(nExpCount)!=read(gPollInfo.fds[i].fd, &nExpCount, sizeof(nExpCount)))
-                  {
-                     DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("mainLoop - read failed"));
-                  }
-                  DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("mainLoop - timeout"));
-
-                  if (FALSE==dbus_timeout_handle(gPollInfo.objects[i].timeout))
-                  {
-                     DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("mainLoop - _timeout_handle() failed!?"));
-                  }
                   bContinue = TRUE;
-               }
-               else if (gPollInfo.fds[i].fd == gPipeFd[0])
-               {
-                  if (0!=(gPollInfo.fds[i].revents & POLLIN))  // dispatch internal command
-                  {
-                     MainLoopData_u readData;
-
-                     bContinue = TRUE;
-                     while ((-1==(ret = (int)read((int)(gPollInfo.fds[i].fd), (void*)&readData, (size_t)sizeof(MainLoopData_u))))&&(EINTR == errno));
-                     if(ret < 0)
-                     {
-                        DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("mainLoop - read() failed"), DLT_STRING(strerror(errno)) );
-                     }
-                     else
-                     {
-                        pthread_mutex_lock(&gMainCondMtx);
-
-                        bContinue = dispatchInternalCommand(conn, &readData, &bQuit);
-
-                        gMainLoopCondValue = 1;
-                        pthread_cond_signal(&gMainLoopCond);
-                        pthread_mutex_unlock(&gMainCondMtx);
-                     }
-                  }
-               }
-               else
-               {
-                  unsigned int flags = 0;
+                  (void)eventfd_read(gMainLoopEventFd, &wakeups);
 
-                  if (0!=(gPollInfo.fds[i].revents & POLLIN))
-                  {
-                     flags |= DBUS_WATCH_READABLE;
-                  }
-                  if (0!=(gPollInfo.fds[i].revents & POLLOUT))
-                  {
-                     flags |= DBUS_WATCH_WRITABLE;
-                  }
-                  if (0!=(gPollInfo.fds[i].revents & POLLERR))
-                  {
-                     flags |= DBUS_WATCH_ERROR;
-                  }
-                  if (0!=(gPollInfo.fds[i].revents & POLLHUP))
-                  {
-                     flags |= DBUS_WATCH_HANGUP;
-                  }
-                  bContinue = (int)dbus_watch_handle(gPollInfo.objects[i].watch, flags);
+                  // commands published from now on must wake up the mainloop again
+                  (void)__sync_lock_test_and_set(&gMainLoopWakeup, 0);
+                  __sync_synchronize();
+
+                  bContinue = dispatchMainLoopRing(conn, &bQuit);
                }
             }
+            else
+            {
+               bContinue = handleWatches(loopFd, events[i].events);
+            }
          }
       }
    }
    while (0 != bContinue);
 
+   stopMainLoopRing();     // release the producers of commands behind the quit command
+
    // do some cleanup
-   close(gPipeFd[0]);
-   close(gPipeFd[1]);
+   process_delete_notification_registry();
 
 #if USE_PASINTERFACE == 1
    dbus_connection_unregister_object_path(conn, gPersAdminConsumerPath);
@@ -786,25 +1416,151 @@ void* mainLoop(void* userData)
    //dbus_shutdown();   // according to dbus documentation it is not neccessary to call dbus_shutdown:
                         // There is absolutely no requirement to call dbus_shutdown() - in fact, most applications won't bother and should not feel guilty.
 
+   closeMainLoopFds();     // watches and timeouts have been removed with the connection
+
    return NULL;
 }
 
 
 
+/**
+ * @brief append a command to the mainloop command ring, does not block
+ *
+ * @param payload the command
+ * @param done completed when the command has been dispatched or dropped, may be NULL
+ *
+ * @return 0 on success, -1 if the ring is full, -2 if the mainloop is not running
+ */
+static int ringPush(const MainLoopData_u* payload, PersMainLoopDone_s* done)
+{
+   PersMainLoopSlot_s* slot = NULL;
+   unsigned int pos = 0;
+
+   (void)__sync_add_and_fetch(&gMainLoopProducers, 1);    // the eventfd is not closed until the command is appended
+   if(__sync_add_and_fetch(&gMainLoopStopped, 0) != 0)
+   {
+      (void)__sync_sub_and_fetch(&gMainLoopProducers, 1);
+      return -2;
+   }
+
+   pos = gMainLoopTail;
+   for(;;)     // claim the slot at the tail
+   {
+      int diff = 0;
+
+      slot = &gMainLoopRing[pos & (MainLoopRingSize - 1)];
+      diff = (int)(slot->sequence - pos);
+      if(diff == 0)
+      {
+         if(__sync_bool_compare_and_swap(&gMainLoopTail, pos, pos + 1))
+         {
+            break;
+         }
+      }
+      else if(diff < 0)
+      {
+         (void)__sync_sub_and_fetch(&gMainLoopProducers, 1);
+         return -1;     // the mainloop has not yet released the slot of the previous round
+      }
+      pos = gMainLoopTail;
+   }
+
+   memcpy(&slot->data, payload, sizeof(MainLoopData_u));
+   slot->done = done;
+   __sync_synchronize();   // publish the command before the sequence
+   slot->sequence = pos + 1;
+   __sync_synchronize();
+
+   if(__sync_lock_test_and_set(&gMainLoopWakeup, 1) == 0)
+   {
+      if(-1 == eventfd_write(gMainLoopEventFd, 1))
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("toMainloop => failed write eventfd"), DLT_INT(errno));
+      }
+   }
+
+   (void)__sync_sub_and_fetch(&gMainLoopProducers, 1);
+
+   return 0;
+}
+
+
+
+/**
+ * @brief append a command to the mainloop command ring, waits while the ring is full
+ *
+ * @return 0 on success, -1 if the mainloop is not running
+ */
+static int ringPushWait(const MainLoopData_u* payload, PersMainLoopDone_s* done)
+{
+   int rval = 0;
+   unsigned int waitUs = MainLoopRingWaitMinUs;
+
+   while((rval = ringPush(payload, done)) == -1)
+   {
+      // the mainloop may be blocked in a dbus call, sleep with a growing bound instead of burning the cpu
+      (void)usleep(waitUs);
+      if(waitUs < MainLoopRingWaitMaxUs)
+      {
+         waitUs = (2 * waitUs < MainLoopRingWaitMaxUs) ? 2 * waitUs : MainLoopRingWaitMaxUs;
+      }
+   }
+
+   return (rval == 0) ? 0 : -1;
+}
+
+
+
 int deliverToMainloop(MainLoopData_u* payload)
 {
    int rval = 0;
+   PersMainLoopDone_s done;
 
-   pthread_mutex_lock(&gDeliverpMtx);     // make sure  deliverToMainloop will be used exclusively
-   rval = deliverToMainloop_NM(payload);
+   sem_init(&done.sem, 0, 0);
+   rval = ringPushWait(payload, &done);
+   if(rval == 0)
+   {
+      while((-1 == sem_wait(&done.sem)) && (EINTR == errno));     // wait until the mainloop has dispatched the command
+      rval = done.rval;
+   }
 
-   pthread_mutex_lock(&gMainCondMtx);     // mutex needed for pthread condition used to wait on other thread (mainloop)
-   while(0 == gMainLoopCondValue)
-      pthread_cond_wait(&gMainLoopCond, &gMainCondMtx);
-   pthread_mutex_unlock(&gMainCondMtx);
+   if(rval != 0)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("toMainloop => mainloop not running"));
+   }
+   sem_destroy(&done.sem);
 
-   gMainLoopCondValue = 0;
-   pthread_mutex_unlock(&gDeliverpMtx);
+   return rval;
+}
+
+
+
+int deliverToMainloopBatch(MainLoopData_u* payload, unsigned int count)
+{
+   int rval = 0;
+   unsigned int i = 0;
+   PersMainLoopDone_s done;
+
+   if(count > 0)
+   {
+      sem_init(&done.sem, 0, 0);
+      for(i = 0; i < count && rval == 0; i++)   // the mainloop dispatches in order, wait for the last command only
+      {
+         rval = ringPushWait(&payload[i], (i == count - 1) ? &done : NULL);
+      }
+
+      if(rval == 0)
+      {
+         while((-1 == sem_wait(&done.sem)) && (EINTR == errno));
+         rval = done.rval;
+      }
+
+      if(rval != 0)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("toMainloopBatch => mainloop not running"));
+      }
+      sem_destroy(&done.sem);
+   }
 
    return rval;
 }
@@ -813,11 +1569,11 @@ int deliverToMainloop(MainLoopData_u* payload)
 
 int deliverToMainloop_NM(MainLoopData_u* payload)
 {
-   int rval = 0;
+   int rval = ringPush(payload, NULL);
 
-   if(-1 == write(gPipeFd[1], payload, sizeof(MainLoopData_u)))
+   if(rval != 0)
    {
-     DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("toMainloop => failed write pipe"), DLT_INT(errno));
+     DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("toMainloop => failed to queue cmd:"), DLT_UINT(payload->cmd), DLT_INT(rval));
      rval = -1;
    }
    return rval;
@@ -21,8 +21,8 @@
 
 #include <dbus/dbus.h>
 
-#include <poll.h>
 #include <pthread.h>
+#include <sys/epoll.h>
 #include <sys/eventfd.h>
 #include <sys/timerfd.h>
 
@@ -45,6 +45,10 @@ typedef enum ECmd
    CMD_SEND_PAS_REGISTER,
    /// command send lifecycle register/unregister
    CMD_SEND_LC_REGISTER,
+   /// command send the queued notifications as one batched signal
+   CMD_SEND_NOTIFY_BATCH,
+   /// no operation, wakes up the mainloop (command throughput benchmark)
+   CMD_NOP,
    /// quit command
    CMD_QUIT
 } tCmd;
@@ -68,13 +72,9 @@ extern pthread_mutex_t gDbusPendingRegMtx __attribute__ ((visibility ("hidden"))
 extern pthread_cond_t  gDbusPendingCond;
 extern int gDbusPendingCondValue;
 
-/// dbus mainloop conditional variable => visibility "hidden" to prevent the use outside the library
-extern pthread_mutex_t gMainCondMtx __attribute__ ((visibility ("hidden")));
-/// dbus mainloop mutex => visibility "hidden" to prevent the use outside the library
+/// dbus mainloop thread
 extern pthread_t gMainLoopThread;
 
-extern int gMainLoopCondValue __attribute__ ((visibility ("hidden")));
-
 
 /// lifecycle consumer interface dbus name
 extern const char* gDbusLcConsterface;
@@ -122,23 +122,37 @@ int setup_dbus_mainloop(void);
 /**
  * @brief deliver message to mainloop (blocking)
  *        The function blocks until the message has
- *        been delivered to the mainloop
+ *        been dispatched by the mainloop
  *
  * @param payload the message to deliver to the mainloop (command and data)
  *
- * @return 0
+ * @return 0 or -1 if the mainloop is not running
  */
 int deliverToMainloop(MainLoopData_u* payload);
 
 
+/**
+ * @brief deliver several messages to mainloop (blocking)
+ *        The function blocks until all messages have
+ *        been delivered to the mainloop
+ *
+ * @param payload the array of messages to deliver to the mainloop
+ * @param count the number of messages
+ *
+ * @return 0 or -1 if a message could not be delivered
+ */
+int deliverToMainloopBatch(MainLoopData_u* payload, unsigned int count);
+
+
 /**
  * @brief deliver message to mainloop (non blocking)
  *        The function does N O T  block until the message has
- *        been delivered to the mainloop
+ *        been delivered to the mainloop, the message is appended
+ *        to the lock-free command ring of the mainloop
  *
  * @param payload the message to deliver to the mainloop (command and data)
  *
- * @return 0
+ * @return 0 or -1 if the command ring is full or the mainloop is not running
  */
 int deliverToMainloop_NM(MainLoopData_u* payload);
 
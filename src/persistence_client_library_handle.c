@@ -286,7 +286,7 @@ void close_all_persistence_handle()
 }
 
 
-int set_key_handle_data(int idx, const char* id, unsigned int ldbid,  unsigned int user_no, unsigned int seat_no)
+int set_key_handle_data(int idx, const PersistenceKeyHandle_s* handleStruct)
 {
 	int handle = -1;
 
@@ -304,10 +304,7 @@ int set_key_handle_data(int idx, const char* id, unsigned int ldbid,  unsigned i
       {
          item->key = idx;
 
-         item->value.keyHandle.ldbid   = ldbid;
-         item->value.keyHandle.user_no = user_no;
-         item->value.keyHandle.seat_no = seat_no;
-         strncpy(item->value.keyHandle.resource_id, id, PERS_DB_MAX_LENGTH_KEY_NAME);
+         memcpy(&item->value.keyHandle, handleStruct, sizeof(PersistenceKeyHandle_s));
          item->value.keyHandle.resource_id[PERS_DB_MAX_LENGTH_KEY_NAME-1] = '\0'; // Ensures 0-Termination
 
          jsw_rbinsert(gKeyHandleTree, item);
@@ -340,11 +337,7 @@ int get_key_handle_data(int idx, PersistenceKeyHandle_s* handleStruct)
             foundItem = (KeyHandleTreeItem_s*)jsw_rbfind(gKeyHandleTree, item);
             if(foundItem != NULL)
             {
-               handleStruct->ldbid   = foundItem->value.keyHandle.ldbid;
-               handleStruct->user_no = foundItem->value.keyHandle.user_no;
-               handleStruct->seat_no = foundItem->value.keyHandle.seat_no;
-               strncpy(handleStruct->resource_id, foundItem->value.keyHandle.resource_id, PERS_DB_MAX_LENGTH_KEY_NAME);
-               handleStruct->resource_id[PERS_DB_MAX_LENGTH_KEY_NAME-1] = '\0'; // Ensures 0-Termination
+               memcpy(handleStruct, &foundItem->value.keyHandle, sizeof(PersistenceKeyHandle_s));
                rval = 0;
             }
             free(item);
@@ -358,6 +351,46 @@ int get_key_handle_data(int idx, PersistenceKeyHandle_s* handleStruct)
 }
 
 
+int set_key_handle_db(int idx, int* dbHandle, unsigned int dbGeneration)
+{
+	int rval = -1;
+
+	if(pthread_mutex_lock(&gKeyHandleAccessMtx) == 0)
+	{
+      if(gKeyHandleTree != NULL)
+      {
+         KeyHandleTreeItem_s* item = malloc(sizeof(KeyHandleTreeItem_s));
+         if(item != NULL)
+         {
+            KeyHandleTreeItem_s* foundItem = NULL;
+            item->key = idx;
+            foundItem = (KeyHandleTreeItem_s*)jsw_rbfind(gKeyHandleTree, item);
+            if(foundItem != NULL)
+            {
+               if(   foundItem->value.keyHandle.dbHandle >= 0
+                  && foundItem->value.keyHandle.dbGeneration == dbGeneration)
+               {
+                  *dbHandle = foundItem->value.keyHandle.dbHandle;    // already refreshed by another thread
+                  rval = 1;
+               }
+               else
+               {
+                  foundItem->value.keyHandle.dbHandle     = *dbHandle;
+                  foundItem->value.keyHandle.dbGeneration = dbGeneration;
+                  rval = 0;
+               }
+            }
+            free(item);
+         }
+      }
+
+		pthread_mutex_unlock(&gKeyHandleAccessMtx);
+	}
+
+   return rval;
+}
+
+
 void init_key_handle_array()
 {
 	if(pthread_mutex_lock(&gKeyHandleAccessMtx) == 0)
@@ -34,6 +34,16 @@ typedef struct _PersistenceKeyHandle_s
    unsigned int seat_no;
    /// Resource ID
    char resource_id[PERS_DB_MAX_LENGTH_KEY_NAME];
+   /// resolved persistence information (context and resource configuration)
+   PersistenceInfo_s info;
+   /// resolved database key
+   char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME];
+   /// resolved database location path
+   char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME];
+   /// handle of the database the key is stored in, -1 if not (yet) opened
+   int dbHandle;
+   /// database generation the database handle belongs to
+   unsigned int dbGeneration;
 } PersistenceKeyHandle_s;
 
 
@@ -113,14 +123,24 @@ void close_all_persistence_handle();
  * @brief set data to the key handle
  *
  * @param idx the index
- * @param id the resource id
- * @param ldbid the logical database id
- * @param user_no the user identifier
- * @param seat_no the seat number
+ * @param handleStruct the handle structure (resource id and resolved context)
  *
  * @return a positive value (0 or greather) or -1 on error
  */
-int set_key_handle_data(int idx, const char* id, unsigned int ldbid,  unsigned int user_no, unsigned int seat_no);
+int set_key_handle_data(int idx, const PersistenceKeyHandle_s* handleStruct);
+
+
+/**
+ * @brief update the database handle of the key handle, unless another thread has already
+ *        stored a database handle of the same generation
+ *
+ * @param idx the index
+ * @param dbHandle the database handle, the handle already stored is returned here
+ * @param dbGeneration the database generation the database handle belongs to
+ *
+ * @return 0 if the database handle has been stored, 1 if the handle already stored has been returned, -1 on error
+ */
+int set_key_handle_db(int idx, int* dbHandle, unsigned int dbGeneration);
 
 
 /**
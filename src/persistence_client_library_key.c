@@ -22,6 +22,8 @@
 #include "persistence_client_library_pas_interface.h"
 #include "persistence_client_library_prct_access.h"
 #include "persistence_client_library_db_access.h"
+#include "persistence_client_library_custom_loader.h"
+#include "persistence_client_library_key_manifest.h"
 
 #include <dlt.h>
 
@@ -30,8 +32,84 @@ DLT_IMPORT_CONTEXT(gPclDLTContext);
 /// max key value data size [default 16kB]
 static int gMaxKeyValDataSize = PERS_DB_MAX_SIZE_KEY_DATA;
 
-static pthread_mutex_t gKeyAPIHandleAccessMtx = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t gKeyAPIAccessMtx = PTHREAD_MUTEX_INITIALIZER;
+/// handle open/close is exclusive, access via an open handle is shared
+static pthread_rwlock_t gKeyAPIHandleAccessLock = PTHREAD_RWLOCK_INITIALIZER;
+
+/// key access locks, one shard per resolved database (storage, ldbid, policy); readers don't serialize
+static pthread_rwlock_t gKeyAPIAccessLock[KeyApiLockShards] = { [0 ... KeyApiLockShards-1] = PTHREAD_RWLOCK_INITIALIZER };
+
+/// protects the change notification registration (notification tree and callback)
+static pthread_mutex_t gKeyAPINotifyMtx = PTHREAD_MUTEX_INITIALIZER;
+
+
+/// staged key of a transaction
+typedef struct _PersTransactionKey_s
+{
+   /// resource id
+   char resource_id[PERS_DB_MAX_LENGTH_KEY_NAME];
+   /// resolved database key
+   char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME];
+   /// staged data
+   unsigned char* data;
+   /// size of the staged data
+   int size;
+} PersTransactionKey_s;
+
+/// key transaction, all keys of a transaction are stored in the same database
+typedef struct _PersTransaction_s
+{
+   /// flag to indicate if the transaction is in use
+   int used;
+   /// flag to indicate if the database of the transaction has been resolved (by the first staged key)
+   int resolved;
+   /// resolved persistence information of the database
+   PersistenceInfo_s info;
+   /// database location path
+   char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME];
+   /// staged keys
+   PersTransactionKey_s* keys;
+   /// number of staged keys
+   unsigned int numKeys;
+   /// number of allocated staged keys
+   unsigned int maxKeys;
+} PersTransaction_s;
+
+/// key iterator, iterates over the keys of the write cached and the write through database of a context
+typedef struct _PersKeyIterator_s
+{
+   /// flag to indicate if the iterator is currently used by pclKeyIterateNext
+   int busy;
+   /// persistence information of the database currently iterated
+   PersistenceInfo_s info;
+   /// location path of the database currently iterated
+   char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME];
+   /// database key prefix of the context (node, user, seat), stripped from the keys to get the resource id
+   char contextPrefix[PERS_DB_MAX_LENGTH_KEY_NAME];
+   /// database key prefix to match (context prefix and resource id prefix)
+   char keyPrefix[PERS_DB_MAX_LENGTH_KEY_NAME];
+   /// policy of the database currently iterated, PersistencePolicy_LastEntry if finished
+   int policy;
+   /// key list of the database currently iterated ('\0' separated keys)
+   char* keyList;
+   /// size of the key list
+   int keyListSize;
+   /// position of the next key in the key list
+   int keyListPos;
+   /// database keys returned by the last call (the returned resource ids point into them)
+   char keys[MaxKeyIterateChunk][PERS_DB_MAX_LENGTH_KEY_NAME];
+} PersKeyIterator_s;
+
+/// open key iterators
+static PersKeyIterator_s* gKeyIterator[MaxKeyIterators] = {NULL};
+
+/// protects the key iterators
+static pthread_mutex_t gKeyIteratorMtx = PTHREAD_MUTEX_INITIALIZER;
+
+/// open key transactions
+static PersTransaction_s gKeyTransaction[MaxKeyTransactions];
+
+/// protects the key transactions
+static pthread_mutex_t gKeyTransactionMtx = PTHREAD_MUTEX_INITIALIZER;
 
 // function declaration
 static int handleRegNotifyOnChange(int key_handle, pclChangeNotifyCallback_t callback, PersNotifyRegPolicy_e regPolicy);
@@ -42,6 +120,226 @@ static int regNotifyOnChange(unsigned int ldbid, const char* resource_id, unsign
 extern int doAppcheck(void);
 #endif
 
+
+/**
+ * @brief get the access lock of the database a resolved resource is stored in
+ *
+ * @param dbContext the resolved database context
+ *
+ * @return the reader/writer lock of the database shard
+ */
+static pthread_rwlock_t* get_key_access_lock(const PersistenceInfo_s* dbContext)
+{
+   unsigned int shard = (unsigned int)dbContext->configKey.storage;
+   // local ldbids (0x80 - 0xFF) are name spaces within the same local database
+   unsigned int dbId  = (dbContext->context.ldbid < 0x80) ? dbContext->context.ldbid : PCL_LDBID_LOCAL;
+
+   shard = (shard * 31u) + dbId;
+   shard = (shard * 31u) + (unsigned int)dbContext->configKey.policy;
+
+   return &gKeyAPIAccessLock[shard % KeyApiLockShards];
+}
+
+
+
+/**
+ * @brief get the database handle of a key handle, a stale database handle will be refreshed.
+ *        A refreshed database handle is pinned: by the key handle until it is closed,
+ *        or by the caller if the data doesn't belong to a key handle.
+ *        If several threads refresh the same key handle, only the pin stored first is kept.
+ *
+ * @param key_handle the key handle, -1 if the data doesn't belong to a key handle
+ * @param persHandle the key handle data
+ *
+ * @return the database handle or a negative value on error
+ */
+static int get_key_handle_db(int key_handle, PersistenceKeyHandle_s* persHandle)
+{
+   unsigned int dbGeneration = persistence_get_db_generation();
+
+   if((persHandle->dbHandle < 0) || (persHandle->dbGeneration != dbGeneration))
+   {
+      persHandle->dbHandle = persistence_acquire_db_handle(&persHandle->info, persHandle->dbPath);
+      if(persHandle->dbHandle >= 0)
+      {
+         persHandle->dbGeneration = dbGeneration;
+         if(key_handle >= 0 && set_key_handle_db(key_handle, &persHandle->dbHandle, dbGeneration) == 1)
+         {
+            // refreshed by another thread, its pin is used: drop this one
+            persistence_release_db_handle(&persHandle->info, persHandle->dbPath, dbGeneration);
+         }
+      }
+   }
+
+   return persHandle->dbHandle;
+}
+
+
+
+/**
+ * @brief read data or get the data size of an already resolved key, the caller must hold the access lock
+ *
+ * @param key_handle the key handle, -1 if the data doesn't belong to a key handle
+ * @param persHandle the resolved key data
+ * @param buffer the buffer for the data, NULL if the size should be read
+ * @param buffer_size the size of the buffer
+ * @param job get the data or the size of the data
+ *
+ * @return the number of bytes read or the size of the data, a negative value on error
+ */
+static int get_resolved_data(int key_handle, PersistenceKeyHandle_s* persHandle, unsigned char* buffer, int buffer_size, PersGetDefault_e job)
+{
+   int size = EPERS_COMMON;
+
+   if(   (PersistenceStorage_local  == persHandle->info.configKey.storage)
+      || (PersistenceStorage_shared == persHandle->info.configKey.storage) )
+   {
+      // the key has already been resolved, go directly to the database
+      int handleDB = get_key_handle_db(key_handle, persHandle);
+      if(handleDB >= 0)
+      {
+         if(PersGetDefault_Data == job && *plugin_persComDbReadKey != NULL)
+         {
+            size = plugin_persComDbReadKey(handleDB, persHandle->dbKey, (char*)buffer, buffer_size);
+         }
+         else if(PersGetDefault_Size == job && *plugin_persComDbGetKeySize != NULL)
+         {
+            size = plugin_persComDbGetKeySize(handleDB, persHandle->dbKey);
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("getResolvedData - EPERS_NO_PLUGIN_FUNCT"));
+            size = EPERS_NO_PLUGIN_FUNCT;
+         }
+
+         if(size < 0 && size != EPERS_NO_PLUGIN_FUNCT)
+         {
+            size = pers_get_defaults(persHandle->dbPath, persHandle->resource_id, &persHandle->info,
+                                     buffer, (unsigned int)buffer_size, job);
+         }
+      }
+      else
+      {
+         size = handleDB;
+      }
+   }
+   else if(PersGetDefault_Data == job)    // custom storage, handled by the custom plugin
+   {
+      size = persistence_get_data(persHandle->dbPath, persHandle->dbKey, persHandle->resource_id, &persHandle->info, buffer, buffer_size);
+   }
+   else
+   {
+      size = persistence_get_data_size(persHandle->dbPath, persHandle->dbKey, persHandle->resource_id, &persHandle->info);
+   }
+
+   return size;
+}
+
+
+
+/**
+ * @brief read data or get the data size of a key using the resolved context of a key handle
+ *
+ * @param key_handle the key handle
+ * @param persHandle the key handle data
+ * @param buffer the buffer for the data, NULL if the size should be read
+ * @param buffer_size the size of the buffer
+ * @param job get the data or the size of the data
+ *
+ * @return the number of bytes read or the size of the data, a negative value on error
+ */
+static int key_handle_get_data(int key_handle, PersistenceKeyHandle_s* persHandle, unsigned char* buffer, int buffer_size, PersGetDefault_e job)
+{
+   int size = EPERS_COMMON;
+   pthread_rwlock_t* accessLock = get_key_access_lock(&persHandle->info);
+   int lock = pthread_rwlock_rdlock(accessLock);
+
+   if(lock == 0)
+   {
+      size = get_resolved_data(key_handle, persHandle, buffer, buffer_size, job);
+
+      pthread_rwlock_unlock(accessLock);
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyHandleGetData - rwlock lock failed:"), DLT_INT(lock));
+   }
+
+   return size;
+}
+
+
+
+/**
+ * @brief check if data may be written to an already resolved key
+ *
+ * @param info the resolved key context
+ * @param buffer_size the number of bytes to write
+ *
+ * @return 0 if the data may be written or a negative value with one of the following errors:
+ *         EPERS_BUFLIMIT, EPERS_RESOURCE_READ_ONLY, EPERS_NOT_RESP_APP
+ */
+static int check_write_access(const PersistenceInfo_s* info, int buffer_size)
+{
+   int rval = 0;
+
+   if(buffer_size > gMaxKeyValDataSize)     // check data size
+   {
+      rval = EPERS_BUFLIMIT;
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("checkWriteAccess - buffer_size to big, limit is [bytes]:"), DLT_INT(gMaxKeyValDataSize));
+   }
+   else if(info->configKey.permission == PersistencePermission_ReadOnly)   // don't write to a read only resource
+   {
+      rval = EPERS_RESOURCE_READ_ONLY;
+   }
+   else if(   (info->configKey.storage == PersistenceStorage_shared)
+           && (0 != strncmp(info->configKey.reponsible, gAppId, PERS_RCT_MAX_LENGTH_RESPONSIBLE) ) )
+   {
+      rval = EPERS_NOT_RESP_APP;
+   }
+
+   return rval;
+}
+
+
+
+/**
+ * @brief write data to a key using the resolved context of a key handle
+ *
+ * @param persHandle the key handle data
+ * @param buffer the buffer holding the data
+ * @param buffer_size the size of the buffer
+ *
+ * @return the number of bytes written or a negative value on error
+ */
+static int key_handle_set_data(PersistenceKeyHandle_s* persHandle, unsigned char* buffer, int buffer_size)
+{
+   int size = EPERS_COMMON;
+
+   if(AccessNoLock == isAccessLocked())         // check if access to persistent data is locked
+   {
+      size = EPERS_LOCKFS;
+   }
+   else if((size = check_write_access(&persHandle->info, buffer_size)) == 0)
+   {
+      pthread_rwlock_t* accessLock = get_key_access_lock(&persHandle->info);
+      int lock = pthread_rwlock_wrlock(accessLock);
+      if(lock == 0)
+      {
+         size = persistence_set_data(persHandle->dbPath, persHandle->dbKey, persHandle->resource_id, &persHandle->info, buffer, buffer_size);
+
+         pthread_rwlock_unlock(accessLock);
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyHandleSetData - rwlock lock failed:"), DLT_INT(lock));
+         size = EPERS_COMMON;
+      }
+   }
+
+   return size;
+}
+
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 // function with handle
@@ -56,7 +354,7 @@ int pclKeyHandleOpen(unsigned int ldbid, const char* resource_id, unsigned int u
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
-      int lock = pthread_mutex_lock(&gKeyAPIHandleAccessMtx);
+      int lock = pthread_rwlock_wrlock(&gKeyAPIHandleAccessLock);
       if(lock == 0)
       {
 
@@ -79,8 +377,32 @@ int pclKeyHandleOpen(unsigned int ldbid, const char* resource_id, unsigned int u
             {
                if(dbContext.configKey.storage < PersistenceStorage_LastEntry)    // check if store policy is valid
                {
+                  PersistenceKeyHandle_s persHandle;
+
+                  memset(&persHandle, 0, sizeof(PersistenceKeyHandle_s));
+                  persHandle.ldbid   = ldbid;
+                  persHandle.user_no = user_no;
+                  persHandle.seat_no = seat_no;
+                  strncpy(persHandle.resource_id, resource_id, PERS_DB_MAX_LENGTH_KEY_NAME-1);
+
+                  // keep the resolved context, handle based access doesn't need to resolve it again
+                  memcpy(&persHandle.info, &dbContext, sizeof(PersistenceInfo_s));
+                  strncpy(persHandle.dbKey,  dbKey,  PERS_DB_MAX_LENGTH_KEY_NAME-1);
+                  strncpy(persHandle.dbPath, dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME-1);
+
+                  persHandle.dbHandle = -1;
+                  if(dbContext.configKey.storage != PersistenceStorage_custom)
+                  {
+                     persHandle.dbGeneration = persistence_get_db_generation();
+                     persHandle.dbHandle     = persistence_acquire_db_handle(&persHandle.info, persHandle.dbPath);
+                  }
+
                   // remember data in handle array
-                  handle = set_key_handle_data(get_persistence_handle_idx(), resource_id, ldbid, user_no, seat_no);
+                  handle = set_key_handle_data(get_persistence_handle_idx(), &persHandle);
+                  if(handle < 0 && persHandle.dbHandle >= 0)
+                  {
+                     persistence_release_db_handle(&persHandle.info, persHandle.dbPath, persHandle.dbGeneration);
+                  }
                }
                else
                {
@@ -98,7 +420,7 @@ int pclKeyHandleOpen(unsigned int ldbid, const char* resource_id, unsigned int u
             handle = EPERS_SHUTDOWN_NO_TRUSTED;
          }
 #endif
-         pthread_mutex_unlock(&gKeyAPIHandleAccessMtx);
+         pthread_rwlock_unlock(&gKeyAPIHandleAccessLock);
       }
       else
       {
@@ -125,7 +447,7 @@ int pclKeyHandleClose(int key_handle)
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
-      int lock = pthread_mutex_lock(&gKeyAPIHandleAccessMtx);
+      int lock = pthread_rwlock_wrlock(&gKeyAPIHandleAccessLock);
 
       if(lock == 0)
       {
@@ -139,6 +461,11 @@ int pclKeyHandleClose(int key_handle)
             {
                if ('\0' != persHandle.resource_id[0])
                {
+                  if(persHandle.dbHandle >= 0)
+                  {
+                     persistence_release_db_handle(&persHandle.info, persHandle.dbPath, persHandle.dbGeneration);
+                  }
+
                   /* Invalidate key handle data */
                   set_persistence_handle_close_idx(key_handle);
                   clear_key_handle_array(key_handle);
@@ -160,7 +487,7 @@ int pclKeyHandleClose(int key_handle)
             rval = EPERS_SHUTDOWN_NO_TRUSTED;
          }
 #endif
-         pthread_mutex_unlock(&gKeyAPIHandleAccessMtx);
+         pthread_rwlock_unlock(&gKeyAPIHandleAccessLock);
       }
       else
       {
@@ -187,7 +514,7 @@ int pclKeyHandleGetSize(int key_handle)
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
-      int lock = pthread_mutex_lock(&gKeyAPIHandleAccessMtx);
+      int lock = pthread_rwlock_rdlock(&gKeyAPIHandleAccessLock);
       if( lock == 0)
       {
 #if USE_APPCHECK
@@ -200,8 +527,7 @@ int pclKeyHandleGetSize(int key_handle)
             {
                if ('\0' != persHandle.resource_id[0])
                {
-                size = pclKeyGetSize(persHandle.ldbid, persHandle.resource_id,
-                                     persHandle.user_no, persHandle.seat_no);
+                size = key_handle_get_data(key_handle, &persHandle, NULL, 0, PersGetDefault_Size);
                }
                else
                {
@@ -219,7 +545,7 @@ int pclKeyHandleGetSize(int key_handle)
          size = EPERS_SHUTDOWN_NO_TRUSTED;
       }
 #endif
-         pthread_mutex_unlock(&gKeyAPIHandleAccessMtx);
+         pthread_rwlock_unlock(&gKeyAPIHandleAccessLock);
       }
       else
       {
@@ -246,7 +572,7 @@ int pclKeyHandleReadData(int key_handle, unsigned char* buffer, int buffer_size)
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
-      int lock = pthread_mutex_lock(&gKeyAPIHandleAccessMtx);
+      int lock = pthread_rwlock_rdlock(&gKeyAPIHandleAccessLock);
       if(lock == 0)
       {
 #if USE_APPCHECK
@@ -259,9 +585,14 @@ int pclKeyHandleReadData(int key_handle, unsigned char* buffer, int buffer_size)
             {
                if ('\0' != persHandle.resource_id[0])
                {
-                size = pclKeyReadData(persHandle.ldbid, persHandle.resource_id,
-                                      persHandle.user_no, persHandle.seat_no,
-                                      buffer, buffer_size);
+                  if(AccessNoLock != isAccessLocked() ) // check if access to persistent data is locked
+                  {
+                     size = key_handle_get_data(key_handle, &persHandle, buffer, buffer_size, PersGetDefault_Data);
+                  }
+                  else
+                  {
+                     size = EPERS_LOCKFS;
+                  }
                }
                else
                {
@@ -279,7 +610,7 @@ int pclKeyHandleReadData(int key_handle, unsigned char* buffer, int buffer_size)
             size = EPERS_SHUTDOWN_NO_TRUSTED;
          }
 #endif
-         pthread_mutex_unlock(&gKeyAPIHandleAccessMtx);
+         pthread_rwlock_unlock(&gKeyAPIHandleAccessLock);
       }
       else
       {
@@ -304,21 +635,26 @@ int pclKeyHandleRegisterNotifyOnChange(int key_handle, pclChangeNotifyCallback_t
    int lock = 0;
    DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyHandleRegisterNotifyOnChange - key_handle:"), DLT_INT(key_handle));
 
-   lock = pthread_mutex_lock(&gKeyAPIHandleAccessMtx);
+   lock = pthread_rwlock_rdlock(&gKeyAPIHandleAccessLock);
    if(lock == 0)
    {
-      //DLT_LOG(gDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyHandleRegisterNotifyOnChange: "),
-      //            DLT_INT(gKeyHandleArray[key_handle].info.context.ldbid), DLT_STRING(gKeyHandleArray[key_handle].resourceID) );
-      if((gChangeNotifyCallback == callback) || (gChangeNotifyCallback == NULL))
-      {
-         rval = handleRegNotifyOnChange(key_handle, callback, Notify_register);
-      }
-      else
+      lock = pthread_mutex_lock(&gKeyAPINotifyMtx);
+      if(lock == 0)
       {
-         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyHandleRegNotOnChange - Only one cBack allowed for ch notiy."));
-         rval = EPERS_NOTIFY_NOT_ALLOWED;
+         //DLT_LOG(gDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyHandleRegisterNotifyOnChange: "),
+         //            DLT_INT(gKeyHandleArray[key_handle].info.context.ldbid), DLT_STRING(gKeyHandleArray[key_handle].resourceID) );
+         if((gChangeNotifyCallback == callback) || (gChangeNotifyCallback == NULL))
+         {
+            rval = handleRegNotifyOnChange(key_handle, callback, Notify_register);
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyHandleRegNotOnChange - Only one cBack allowed for ch notiy."));
+            rval = EPERS_NOTIFY_NOT_ALLOWED;
+         }
+         pthread_mutex_unlock(&gKeyAPINotifyMtx);
       }
-      pthread_mutex_unlock(&gKeyAPIHandleAccessMtx);
+      pthread_rwlock_unlock(&gKeyAPIHandleAccessLock);
    }
    else
    {
@@ -337,12 +673,17 @@ int pclKeyHandleUnRegisterNotifyOnChange(int key_handle, pclChangeNotifyCallback
 
    DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyHandleUnRegisterNotifyOnChange - key_handle:"), DLT_INT(key_handle));
 
-   lock = pthread_mutex_lock(&gKeyAPIHandleAccessMtx);
+   lock = pthread_rwlock_rdlock(&gKeyAPIHandleAccessLock);
    if(lock == 0)
    {
-      rval = handleRegNotifyOnChange(key_handle, callback, Notify_unregister);
+      lock = pthread_mutex_lock(&gKeyAPINotifyMtx);
+      if(lock == 0)
+      {
+         rval = handleRegNotifyOnChange(key_handle, callback, Notify_unregister);
 
-      pthread_mutex_unlock(&gKeyAPIHandleAccessMtx);
+         pthread_mutex_unlock(&gKeyAPINotifyMtx);
+      }
+      pthread_rwlock_unlock(&gKeyAPIHandleAccessLock);
    }
    else
    {
@@ -404,7 +745,7 @@ int pclKeyHandleWriteData(int key_handle, unsigned char* buffer, int buffer_size
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
-      int lock = pthread_mutex_lock(&gKeyAPIHandleAccessMtx);
+      int lock = pthread_rwlock_rdlock(&gKeyAPIHandleAccessLock);
       if(lock == 0)
       {
 #if USE_APPCHECK
@@ -417,8 +758,7 @@ int pclKeyHandleWriteData(int key_handle, unsigned char* buffer, int buffer_size
             {
                if ('\0' != persHandle.resource_id[0])
                {
-                size = pclKeyWriteData(persHandle.ldbid,   persHandle.resource_id,
-                                       persHandle.user_no, persHandle.seat_no, buffer, buffer_size);
+                size = key_handle_set_data(&persHandle, buffer, buffer_size);
                }
                else
                {
@@ -436,7 +776,7 @@ int pclKeyHandleWriteData(int key_handle, unsigned char* buffer, int buffer_size
             size = EPERS_SHUTDOWN_NO_TRUSTED;
          }
 #endif
-         pthread_mutex_unlock(&gKeyAPIHandleAccessMtx);
+         pthread_rwlock_unlock(&gKeyAPIHandleAccessLock);
       }
       else
       {
@@ -471,56 +811,59 @@ int pclKeyDelete(unsigned int ldbid, const char* resource_id, unsigned int user_
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
-      int lock = pthread_mutex_lock(&gKeyAPIAccessMtx);
-      if(lock == 0)
-      {
 #if USE_APPCHECK
-         if(doAppcheck() == 1)
-         {
+      if(doAppcheck() == 1)
+      {
 #endif
-            if(AccessNoLock != isAccessLocked() ) // check if access to persistent data is locked
-            {
-               PersistenceInfo_s dbContext;
+         if(AccessNoLock != isAccessLocked() ) // check if access to persistent data is locked
+         {
+            PersistenceInfo_s dbContext;
 
-              char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME]   = {0};     // database key
-              char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};     // database location
-
-              dbContext.context.ldbid   = ldbid;
-              dbContext.context.seat_no = seat_no;
-              dbContext.context.user_no = user_no;
-
-              // get database context: database path and database key
-              rval = get_db_context(&dbContext, resource_id, ResIsNoFile, dbKey, dbPath);
-              if(   (rval >= 0)
-                 && (dbContext.configKey.type == PersistenceResourceType_key) )     // check if type is matching
-              {
-                 if(   dbContext.configKey.storage < PersistenceStorage_LastEntry)  // check if store policy is valid
-                 {
-                    rval = persistence_delete_data(dbPath, dbKey, resource_id, &dbContext);
-                 }
-                 else
-                 {
-                   rval = EPERS_BADPOL;
-                 }
-              }
-            }
-            else
+            char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME]   = {0};     // database key
+            char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};     // database location
+
+            dbContext.context.ldbid   = ldbid;
+            dbContext.context.seat_no = seat_no;
+            dbContext.context.user_no = user_no;
+
+            // get database context: database path and database key
+            rval = get_db_context(&dbContext, resource_id, ResIsNoFile, dbKey, dbPath);
+            if(   (rval >= 0)
+               && (dbContext.configKey.type == PersistenceResourceType_key) )     // check if type is matching
             {
-               rval = EPERS_LOCKFS;
+               if(   dbContext.configKey.storage < PersistenceStorage_LastEntry)  // check if store policy is valid
+               {
+                  pthread_rwlock_t* accessLock = get_key_access_lock(&dbContext);
+                  int lock = pthread_rwlock_wrlock(accessLock);
+                  if(lock == 0)
+                  {
+                     rval = persistence_delete_data(dbPath, dbKey, resource_id, &dbContext);
+
+                     pthread_rwlock_unlock(accessLock);
+                  }
+                  else
+                  {
+                     DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclKeyDelete - rwlock lock failed:"), DLT_INT(lock));
+                     rval = EPERS_COMMON;
+                  }
+               }
+               else
+               {
+                  rval = EPERS_BADPOL;
+               }
             }
-#if USE_APPCHECK
          }
          else
          {
-            rval = EPERS_SHUTDOWN_NO_TRUSTED;
+            rval = EPERS_LOCKFS;
          }
-#endif
-         pthread_mutex_unlock(&gKeyAPIAccessMtx);
+#if USE_APPCHECK
       }
       else
       {
-         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclKeyDelete - mutex lock failed:"), DLT_INT(lock));
+         rval = EPERS_SHUTDOWN_NO_TRUSTED;
       }
+#endif
    }
    else
    {
@@ -542,53 +885,56 @@ int pclKeyGetSize(unsigned int ldbid, const char* resource_id, unsigned int user
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
-      int lock = pthread_mutex_lock(&gKeyAPIAccessMtx);
-      if(lock == 0)
-      {
 #if USE_APPCHECK
-         if(doAppcheck() == 1)
-         {
+      if(doAppcheck() == 1)
+      {
 #endif
-            PersistenceInfo_s dbContext;
+         PersistenceInfo_s dbContext;
 
-            char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME]   = {0};       // database key
-            char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};       // database location
+         char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME]   = {0};       // database key
+         char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};       // database location
 
-            dbContext.context.ldbid   = ldbid;
-            dbContext.context.seat_no = seat_no;
-            dbContext.context.user_no = user_no;
+         dbContext.context.ldbid   = ldbid;
+         dbContext.context.seat_no = seat_no;
+         dbContext.context.user_no = user_no;
 
-            // get database context: database path and database key
-            data_size = get_db_context(&dbContext, resource_id, ResIsNoFile, dbKey, dbPath);
-            if(   (data_size >= 0)
-               && (dbContext.configKey.type == PersistenceResourceType_key) )       // check if type matches
+         // get database context: database path and database key
+         data_size = get_db_context(&dbContext, resource_id, ResIsNoFile, dbKey, dbPath);
+         if(   (data_size >= 0)
+            && (dbContext.configKey.type == PersistenceResourceType_key) )       // check if type matches
+         {
+            if(   dbContext.configKey.storage < PersistenceStorage_LastEntry)    // check if store policy is valid
             {
-               if(   dbContext.configKey.storage < PersistenceStorage_LastEntry)    // check if store policy is valid
+               pthread_rwlock_t* accessLock = get_key_access_lock(&dbContext);
+               int lock = pthread_rwlock_rdlock(accessLock);
+               if(lock == 0)
                {
                   data_size = persistence_get_data_size(dbPath, dbKey, resource_id, &dbContext);
+
+                  pthread_rwlock_unlock(accessLock);
                }
                else
                {
-                 data_size = EPERS_BADPOL;
+                  DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclKeyGetSize - rwlock lock failed:"), DLT_INT(lock));
+                  data_size = EPERS_COMMON;
                }
             }
             else
             {
               data_size = EPERS_BADPOL;
             }
-#if USE_APPCHECK
          }
          else
          {
-            data_size = EPERS_SHUTDOWN_NO_TRUSTED;
+           data_size = EPERS_BADPOL;
          }
-#endif
-         pthread_mutex_unlock(&gKeyAPIAccessMtx);
+#if USE_APPCHECK
       }
       else
       {
-         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclKeyGetSize - mutex lock failed:"), DLT_INT(lock));
+         data_size = EPERS_SHUTDOWN_NO_TRUSTED;
       }
+#endif
    }
    else
    {
@@ -602,179 +948,901 @@ int pclKeyGetSize(unsigned int ldbid, const char* resource_id, unsigned int user
 
 
 
-int pclKeyReadData(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no,
+int key_read_data(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no,
                   unsigned char* buffer, int buffer_size)
 {
-   int data_size = EPERS_NOT_INITIALIZED;
+   int data_size = 0;
+   PersistenceInfo_s dbContext;
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyReadData - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
+   char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME]   = {0};       // database key
+   char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};       // database location
 
-   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   dbContext.context.ldbid   = ldbid;
+   dbContext.context.seat_no = seat_no;
+   dbContext.context.user_no = user_no;
+
+   // get database context: database path and database key
+   data_size = get_db_context(&dbContext, resource_id, ResIsNoFile, dbKey, dbPath);
+   if(   (data_size >= 0)
+      && (dbContext.configKey.type == PersistenceResourceType_key) )
    {
-      int lock = pthread_mutex_lock(&gKeyAPIAccessMtx);
-      if(lock == 0)
+
+      if(dbContext.configKey.storage < PersistenceStorage_LastEntry)   // check if store policy is valid
       {
-#if USE_APPCHECK
-         if(doAppcheck() == 1)
+         pthread_rwlock_t* accessLock = get_key_access_lock(&dbContext);
+         int lock = pthread_rwlock_rdlock(accessLock);
+         if(lock == 0)
          {
-#endif
-            if(AccessNoLock != isAccessLocked() ) // check if access to persistent data is locked
-            {
-               PersistenceInfo_s dbContext;
-
-               char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME]   = {0};       // database key
-               char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};       // database location
-
-               dbContext.context.ldbid   = ldbid;
-               dbContext.context.seat_no = seat_no;
-               dbContext.context.user_no = user_no;
-
-               // get database context: database path and database key
-               data_size = get_db_context(&dbContext, resource_id, ResIsNoFile, dbKey, dbPath);
-               if(   (data_size >= 0)
-                  && (dbContext.configKey.type == PersistenceResourceType_key) )
-               {
+            data_size = persistence_get_data(dbPath, dbKey, resource_id, &dbContext, buffer, buffer_size);
 
-                  if(dbContext.configKey.storage < PersistenceStorage_LastEntry)   // check if store policy is valid
-                  {
-                        data_size = persistence_get_data(dbPath, dbKey, resource_id, &dbContext, buffer, buffer_size);
-                  }
-                  else
-                  {
-                     data_size = EPERS_BADPOL;
-                  }
-               }
-               else
-               {
-                  DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyReadData - no db context or res not a key"));
-               }
-            }
-            else
-            {
-               data_size = EPERS_LOCKFS;
-            }
-#if USE_APPCHECK
+            pthread_rwlock_unlock(accessLock);
          }
          else
          {
-            data_size = EPERS_SHUTDOWN_NO_TRUSTED;
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyReadData - rwlock lock failed:"), DLT_INT(lock));
+            data_size = EPERS_COMMON;
          }
-#endif
-         pthread_mutex_unlock(&gKeyAPIAccessMtx);
       }
       else
       {
-         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclKeyGetSize - mutex lock failed:"), DLT_INT(lock));
+         data_size = EPERS_BADPOL;
       }
    }
    else
    {
-      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("keyReadData - not initialized"));
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyReadData - no db context or res not a key"));
    }
 
-   //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclKeyReadData - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
-
    return data_size;
 }
 
 
 
-int pclKeyWriteData(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no,
-                   unsigned char* buffer, int buffer_size)
+int pclKeyReadData(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no,
+                  unsigned char* buffer, int buffer_size)
 {
    int data_size = EPERS_NOT_INITIALIZED;
 
-   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyWriteData - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
+   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyReadData - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
 
    if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
-      int lock = pthread_mutex_lock(&gKeyAPIAccessMtx);
-      if(lock == 0)
-      {
 #if USE_APPCHECK
-         if(doAppcheck() == 1)
-         {
+      if(doAppcheck() == 1)
+      {
 #endif
-            if(AccessNoLock != isAccessLocked() )     // check if access to persistent data is locked
+         if(AccessNoLock != isAccessLocked() ) // check if access to persistent data is locked
+         {
+            data_size = key_read_data(ldbid, resource_id, user_no, seat_no, buffer, buffer_size);
+            if(data_size >= 0)
             {
-               if(buffer_size <= gMaxKeyValDataSize)  // check data size
-               {
-                  PersistenceInfo_s dbContext;
-
-                  char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME]   = {0};       // database key
-                  char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};       // database location
-
-                  dbContext.context.ldbid   = ldbid;
-                  dbContext.context.seat_no = seat_no;
-                  dbContext.context.user_no = user_no;
+               key_manifest_record(ldbid, resource_id, user_no, seat_no);
+            }
+         }
+         else
+         {
+            data_size = EPERS_LOCKFS;
+         }
+#if USE_APPCHECK
+      }
+      else
+      {
+         data_size = EPERS_SHUTDOWN_NO_TRUSTED;
+      }
+#endif
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("keyReadData - not initialized"));
+   }
+
+   //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclKeyReadData - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
+
+   return data_size;
+}
+
+
+
+int pclKeyWriteData(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no,
+                   unsigned char* buffer, int buffer_size)
+{
+   int data_size = EPERS_NOT_INITIALIZED;
+
+   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyWriteData - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+#if USE_APPCHECK
+      if(doAppcheck() == 1)
+      {
+#endif
+         if(AccessNoLock != isAccessLocked() )     // check if access to persistent data is locked
+         {
+            if(buffer_size <= gMaxKeyValDataSize)  // check data size
+            {
+               PersistenceInfo_s dbContext;
+
+               char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME]   = {0};       // database key
+               char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};       // database location
+
+               dbContext.context.ldbid   = ldbid;
+               dbContext.context.seat_no = seat_no;
+               dbContext.context.user_no = user_no;
+
+               // get database context: database path and database key
+               data_size = get_db_context(&dbContext, resource_id, ResIsNoFile, dbKey, dbPath);
+               if(   (data_size >= 0)
+                  && (dbContext.configKey.type == PersistenceResourceType_key))
+               {
+                  if(dbContext.configKey.permission != PersistencePermission_ReadOnly)    // don't write to a read only resource
+                  {
+                     // store data
+                     if(dbContext.configKey.storage < PersistenceStorage_LastEntry)       // check if store policy is valid
+                     {
+                        if(   (dbContext.configKey.storage == PersistenceStorage_shared)
+                           && (0 != strncmp(dbContext.configKey.reponsible, gAppId, PERS_RCT_MAX_LENGTH_RESPONSIBLE) ) )
+                        {
+                           data_size = EPERS_NOT_RESP_APP;
+                        }
+                        else
+                        {
+                           pthread_rwlock_t* accessLock = get_key_access_lock(&dbContext);
+                           int lock = pthread_rwlock_wrlock(accessLock);
+                           if(lock == 0)
+                           {
+                              data_size = persistence_set_data(dbPath, dbKey, resource_id, &dbContext, buffer, buffer_size);
+
+                              pthread_rwlock_unlock(accessLock);
+                           }
+                           else
+                           {
+                              DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyWriteData - rwlock lock failed:"), DLT_INT(lock));
+                              data_size = EPERS_COMMON;
+                           }
+                        }
+                     }
+                     else
+                     {
+                        data_size = EPERS_BADPOL;
+                     }
+                  }
+                  else
+                  {
+                     data_size = EPERS_RESOURCE_READ_ONLY;
+                  }
+               }
+               else
+               {
+                  DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyWriteData no db context or res is not a key"));
+               }
+            }
+            else
+            {
+               data_size = EPERS_BUFLIMIT;
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyWriteData - buffer_size to big, limit is [bytes]:"), DLT_INT(gMaxKeyValDataSize));
+            }
+         }
+         else
+         {
+            data_size = EPERS_LOCKFS;
+         }
+#if USE_APPCHECK
+      }
+      else
+      {
+         data_size = EPERS_SHUTDOWN_NO_TRUSTED;
+      }
+#endif
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclKeyWriteData - not initialized"));
+   }
+
+   //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclKeyWriteData - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
+
+   return data_size;
+}
+
+
+
+/// sort entry used to group the items of a batch by database
+typedef struct _PersBatchOrder_s
+{
+   /// the access lock of the database
+   pthread_rwlock_t* lock;
+   /// the database handle
+   int dbHandle;
+   /// index of the item in the batch
+   unsigned int idx;
+   /// flag to indicate if the item has been written, unchanged data is not written
+   int written;
+} PersBatchOrder_s;
+
+
+
+static int batch_order_compare(const void* a, const void* b)
+{
+   const PersBatchOrder_s* left  = (const PersBatchOrder_s*)a;
+   const PersBatchOrder_s* right = (const PersBatchOrder_s*)b;
+   int rval = 0;
+
+   if(left->lock != right->lock)
+   {
+      rval = (left->lock < right->lock) ? -1 : 1;
+   }
+   else if(left->dbHandle != right->dbHandle)
+   {
+      rval = (left->dbHandle < right->dbHandle) ? -1 : 1;
+   }
+   else if(left->idx != right->idx)      // keep the order of the caller within a database
+   {
+      rval = (left->idx < right->idx) ? -1 : 1;
+   }
+
+   return rval;
+}
+
+
+
+/**
+ * @brief resolve the items of a batch, items which can't be accessed get their error status assigned
+ *
+ * @param items the batch items
+ * @param numItems the number of batch items
+ * @param resolved array where the resolved context of the items will be stored
+ * @param order array where the sort entries of the accessible items will be stored
+ * @param isWrite 1 if the items will be written; 0 if they will be read
+ *
+ * @return the number of accessible items stored in order
+ */
+static unsigned int batch_resolve(pclKeyBatchItem_s* items, unsigned int numItems, PersistenceKeyHandle_s* resolved,
+                                  PersBatchOrder_s* order, int isWrite)
+{
+   unsigned int i = 0, numOrder = 0;
+
+   for(i = 0; i < numItems; i++)
+   {
+      PersistenceKeyHandle_s* res = &resolved[i];
+      int rval = EPERS_COMMON;
+
+      memset(res, 0, sizeof(PersistenceKeyHandle_s));
+      res->dbHandle = -1;
+
+      if(items[i].resource_id != NULL && items[i].buffer != NULL && items[i].buffer_size >= 0)
+      {
+         res->info.context.ldbid   = items[i].ldbid;
+         res->info.context.user_no = items[i].user_no;
+         res->info.context.seat_no = items[i].seat_no;
+         strncpy(res->resource_id, items[i].resource_id, PERS_DB_MAX_LENGTH_KEY_NAME-1);
+
+         // get database context: database path and database key
+         rval = get_db_context(&res->info, items[i].resource_id, ResIsNoFile, res->dbKey, res->dbPath);
+         if(   (rval >= 0)
+            && (res->info.configKey.type == PersistenceResourceType_key) )
+         {
+            if(res->info.configKey.storage >= PersistenceStorage_LastEntry)   // check if store policy is valid
+            {
+               rval = EPERS_BADPOL;
+            }
+            else if(isWrite != 0)
+            {
+               rval = check_write_access(&res->info, items[i].buffer_size);
+            }
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("batchResolve - no db context or res not a key"), DLT_STRING(items[i].resource_id));
+            if(rval >= 0)
+            {
+               rval = EPERS_BADPOL;    // resource is not a key
+            }
+         }
+      }
+
+      if(rval >= 0)
+      {
+         if(res->info.configKey.storage != PersistenceStorage_custom)
+         {
+            (void)get_key_handle_db(-1, res);
+         }
+         order[numOrder].lock     = get_key_access_lock(&res->info);
+         order[numOrder].dbHandle = res->dbHandle;
+         order[numOrder].idx      = i;
+         order[numOrder].written  = 0;
+         numOrder++;
+      }
+      items[i].status = rval;
+   }
+
+   qsort(order, numOrder, sizeof(PersBatchOrder_s), batch_order_compare);
+
+   return numOrder;
+}
+
+
+
+/**
+ * @brief send the change notifications of the written items of a batch at once
+ *
+ * @param items the batch items
+ * @param resolved the resolved context of the items
+ * @param order the sort entries of the written items
+ * @param numOrder the number of written items
+ */
+static void batch_send_notifications(pclKeyBatchItem_s* items, PersistenceKeyHandle_s* resolved,
+                                     PersBatchOrder_s* order, unsigned int numOrder)
+{
+   const char** keys = malloc(numOrder * sizeof(const char*));
+   PersistenceDbContext_s** contexts = malloc(numOrder * sizeof(PersistenceDbContext_s*));
+   unsigned int* notified = malloc(numOrder * sizeof(unsigned int));
+
+   if(keys != NULL && contexts != NULL && notified != NULL)
+   {
+      unsigned int i = 0, numNotify = 0;
+
+      for(i = 0; i < numOrder; i++)
+      {
+         unsigned int idx = order[i].idx;
+         PersistenceStorage_e storage = resolved[idx].info.configKey.storage;
+
+         // same conditions as persistence_set_data uses to send a notification
+         if(order[i].written == 0)
+         {
+            continue;
+         }
+
+         if(   ((PersistenceStorage_shared == storage) && (items[idx].status >= 0))
+            || ((PersistenceStorage_custom == storage) && (items[idx].status > 0) && (items[idx].status == items[idx].buffer_size)) )
+         {
+            keys[numNotify]     = resolved[idx].resource_id;
+            contexts[numNotify] = &resolved[idx].info.context;
+            notified[numNotify] = idx;
+            numNotify++;
+         }
+      }
+
+      if(pers_send_Notification_Signal_Batch(keys, contexts, numNotify, pclNotifyStatus_changed) <= 0)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("batchSendNotifications - Err to send noty sig"));
+         for(i = 0; i < numNotify; i++)
+         {
+            items[notified[i]].status = EPERS_NOTIFY_SIG;
+         }
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("batchSendNotifications - malloc failed"));
+   }
+
+   free(keys);
+   free(contexts);
+   free(notified);
+}
+
+
+
+/**
+ * @brief read or write the items of a batch
+ *
+ * @param items the batch items
+ * @param numItems the number of batch items
+ * @param isWrite 1 to write the items; 0 to read them
+ *
+ * @return the number of items successfully processed or a negative value on error
+ */
+static int batch_access(pclKeyBatchItem_s* items, unsigned int numItems, int isWrite)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+#if USE_APPCHECK
+      if(doAppcheck() == 1)
+      {
+#endif
+         if(items == NULL)
+         {
+            rval = EPERS_COMMON;
+         }
+         else if(AccessNoLock != isAccessLocked() ) // check if access to persistent data is locked
+         {
+            PersistenceKeyHandle_s* resolved = malloc(numItems * sizeof(PersistenceKeyHandle_s));
+            PersBatchOrder_s* order = malloc(numItems * sizeof(PersBatchOrder_s));
+
+            if(resolved != NULL && order != NULL)
+            {
+               unsigned int i = 0, numOrder = batch_resolve(items, numItems, resolved, order, isWrite);
+
+               // take the access lock of each database once and process all items stored in it
+               while(i < numOrder)
+               {
+                  pthread_rwlock_t* accessLock = order[i].lock;
+                  unsigned int groupEnd = i;
+                  int lock = 0;
+
+                  while(groupEnd < numOrder && order[groupEnd].lock == accessLock)
+                  {
+                     groupEnd++;
+                  }
+
+                  lock = (isWrite != 0) ? pthread_rwlock_wrlock(accessLock) : pthread_rwlock_rdlock(accessLock);
+                  if(lock == 0)
+                  {
+                     for(; i < groupEnd; i++)
+                     {
+                        unsigned int idx = order[i].idx;
+
+                        if(isWrite != 0)
+                        {
+                           if(persistence_data_unchanged(resolved[idx].dbPath, resolved[idx].dbKey, resolved[idx].resource_id,
+                                                         &resolved[idx].info, items[idx].buffer, items[idx].buffer_size) == 1)
+                           {
+                              items[idx].status = items[idx].buffer_size;    // nothing to write, nothing to notify
+                           }
+                           else
+                           {
+                              // notifications will be sent for all items at once
+                              items[idx].status = persistence_set_data_notify(resolved[idx].dbPath, resolved[idx].dbKey, resolved[idx].resource_id,
+                                                                              &resolved[idx].info, items[idx].buffer, items[idx].buffer_size, 0);
+                              order[i].written = 1;
+                           }
+                        }
+                        else
+                        {
+                           items[idx].status = get_resolved_data(-1, &resolved[idx], items[idx].buffer, items[idx].buffer_size, PersGetDefault_Data);
+                        }
+                     }
+
+                     pthread_rwlock_unlock(accessLock);
+                  }
+                  else
+                  {
+                     DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("batchAccess - rwlock lock failed:"), DLT_INT(lock));
+                     for(; i < groupEnd; i++)
+                     {
+                        items[order[i].idx].status = EPERS_COMMON;
+                     }
+                  }
+               }
+
+               if(isWrite != 0 && numOrder > 0)
+               {
+                  batch_send_notifications(items, resolved, order, numOrder);
+               }
+
+               // every item holding a database pin has been resolved, items which failed to resolve have no pin
+               for(i = 0; i < numItems; i++)
+               {
+                  PersistenceKeyHandle_s* res = &resolved[i];
+                  if(res->dbHandle >= 0)
+                  {
+                     persistence_release_db_handle(&res->info, res->dbPath, res->dbGeneration);
+                  }
+               }
+
+               rval = 0;
+               for(i = 0; i < numItems; i++)
+               {
+                  if(items[i].status >= 0)
+                  {
+                     rval++;
+                  }
+               }
+            }
+            else
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("batchAccess - malloc failed"));
+               rval = EPERS_COMMON;
+            }
+
+            free(resolved);
+            free(order);
+         }
+         else
+         {
+            rval = EPERS_LOCKFS;
+         }
+#if USE_APPCHECK
+      }
+      else
+      {
+         rval = EPERS_SHUTDOWN_NO_TRUSTED;
+      }
+#endif
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("batchAccess - not initialized"));
+   }
+
+   return rval;
+}
+
+
+
+int pclKeyReadBatch(pclKeyBatchItem_s* items, unsigned int numItems)
+{
+   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyReadBatch - items:"), DLT_UINT(numItems));
+
+   return batch_access(items, numItems, 0);
+}
+
+
+
+int pclKeyWriteBatch(pclKeyBatchItem_s* items, unsigned int numItems)
+{
+   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyWriteBatch - items:"), DLT_UINT(numItems));
+
+   return batch_access(items, numItems, 1);
+}
+
+
+
+int pclKeyGetDbHandleStats(pclKeyDbHandleStats_s* stats)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      if(stats != NULL)
+      {
+         persistence_get_db_handle_stats(&stats->maxOpen, &stats->numOpen, &stats->numOpened, &stats->numEvicted);
+         rval = 0;
+      }
+      else
+      {
+         rval = EPERS_COMMON;
+      }
+   }
+
+   return rval;
+}
+
+
+
+/**
+ * @brief free the staged keys of a transaction and mark it as unused, gKeyTransactionMtx must be locked
+ *
+ * @param transaction the transaction
+ */
+static void transaction_release(PersTransaction_s* transaction)
+{
+   unsigned int i = 0;
+
+   for(i = 0; i < transaction->numKeys; i++)
+   {
+      free(transaction->keys[i].data);
+   }
+   free(transaction->keys);
+
+   memset(transaction, 0, sizeof(PersTransaction_s));
+}
+
+
+
+int pclKeyTransactionBegin(unsigned int ldbid, unsigned int user_no, unsigned int seat_no)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyTransactionBegin - ldbid:"), DLT_UINT(ldbid));
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+#if USE_APPCHECK
+      if(doAppcheck() == 1)
+      {
+#endif
+         int i = 0;
+
+         rval = EPERS_MAXHANDLE;
+
+         pthread_mutex_lock(&gKeyTransactionMtx);
+         for(i = 0; i < MaxKeyTransactions; i++)
+         {
+            if(gKeyTransaction[i].used == 0)
+            {
+               memset(&gKeyTransaction[i], 0, sizeof(PersTransaction_s));
+               gKeyTransaction[i].used = 1;
+               gKeyTransaction[i].info.context.ldbid   = ldbid;
+               gKeyTransaction[i].info.context.user_no = user_no;
+               gKeyTransaction[i].info.context.seat_no = seat_no;
+               rval = i;
+               break;
+            }
+         }
+         pthread_mutex_unlock(&gKeyTransactionMtx);
+
+         if(rval == EPERS_MAXHANDLE)
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyTransactionBegin - max no of transactions reached"));
+         }
+#if USE_APPCHECK
+      }
+      else
+      {
+         rval = EPERS_SHUTDOWN_NO_TRUSTED;
+      }
+#endif
+   }
+
+   return rval;
+}
+
+
+
+int pclKeyTransactionWrite(int transaction, const char* resource_id, unsigned char* buffer, int buffer_size)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      if(transaction < 0 || transaction >= MaxKeyTransactions || resource_id == NULL || buffer == NULL || buffer_size < 0)
+      {
+         return EPERS_MAXHANDLE;
+      }
+
+      pthread_mutex_lock(&gKeyTransactionMtx);
+
+      if(gKeyTransaction[transaction].used != 0)
+      {
+         PersTransaction_s* tx = &gKeyTransaction[transaction];
+         PersistenceInfo_s dbContext;
+
+         char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME]   = {0};       // database key
+         char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};       // database location
+
+         memset(&dbContext, 0, sizeof(PersistenceInfo_s));
+         dbContext.context = tx->info.context;
+
+         // get database context: database path and database key
+         rval = get_db_context(&dbContext, resource_id, ResIsNoFile, dbKey, dbPath);
+         if(   (rval >= 0)
+            && (dbContext.configKey.type == PersistenceResourceType_key) )
+         {
+            if(   (dbContext.configKey.storage != PersistenceStorage_local)
+               && (dbContext.configKey.storage != PersistenceStorage_shared) )
+            {
+               rval = EPERS_BADPOL;      // transactions are only possible on local and shared databases
+            }
+            else if(   (tx->resolved != 0)
+                    && (   (dbContext.configKey.storage != tx->info.configKey.storage)
+                        || (dbContext.configKey.policy  != tx->info.configKey.policy)
+                        || (0 != strncmp(dbPath, tx->dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME)) ) )
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyTransactionWrite - key in other database:"), DLT_STRING(resource_id));
+               rval = EPERS_BADPOL;      // a transaction is scoped to one database
+            }
+            else if((rval = check_write_access(&dbContext, buffer_size)) == 0)
+            {
+               unsigned int i = 0;
+               unsigned char* data = malloc((size_t)buffer_size + 1);
+
+               for(i = 0; i < tx->numKeys; i++)    // writing a key again replaces the staged data
+               {
+                  if(0 == strncmp(tx->keys[i].dbKey, dbKey, PERS_DB_MAX_LENGTH_KEY_NAME))
+                  {
+                     break;
+                  }
+               }
+
+               if(i == tx->maxKeys)
+               {
+                  unsigned int maxKeys = (tx->maxKeys == 0) ? 16 : tx->maxKeys * 2;
+                  PersTransactionKey_s* keys = realloc(tx->keys, maxKeys * sizeof(PersTransactionKey_s));
+                  if(keys != NULL)
+                  {
+                     tx->keys    = keys;
+                     tx->maxKeys = maxKeys;
+                  }
+               }
+
+               if(data != NULL && i < tx->maxKeys)
+               {
+                  memcpy(data, buffer, (size_t)buffer_size);
+                  if(i == tx->numKeys)
+                  {
+                     memset(&tx->keys[i], 0, sizeof(PersTransactionKey_s));
+                     strncpy(tx->keys[i].resource_id, resource_id, PERS_DB_MAX_LENGTH_KEY_NAME-1);
+                     strncpy(tx->keys[i].dbKey, dbKey, PERS_DB_MAX_LENGTH_KEY_NAME-1);
+                     tx->numKeys++;
+                  }
+                  free(tx->keys[i].data);
+                  tx->keys[i].data = data;
+                  tx->keys[i].size = buffer_size;
+
+                  if(tx->resolved == 0)
+                  {
+                     memcpy(&tx->info, &dbContext, sizeof(PersistenceInfo_s));
+                     strncpy(tx->dbPath, dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME-1);
+                     tx->resolved = 1;
+                  }
+                  rval = buffer_size;
+               }
+               else
+               {
+                  DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyTransactionWrite - malloc failed"));
+                  free(data);
+                  rval = EPERS_COMMON;
+               }
+            }
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyTransactionWrite - no db context or res not a key"));
+         }
+      }
+      else
+      {
+         rval = EPERS_MAXHANDLE;
+      }
+
+      pthread_mutex_unlock(&gKeyTransactionMtx);
+   }
+
+   return rval;
+}
+
+
+
+int pclKeyTransactionCommit(int transaction)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyTransactionCommit - transaction:"), DLT_INT(transaction));
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      PersTransaction_s tx;
+
+      if(transaction < 0 || transaction >= MaxKeyTransactions)
+      {
+         return EPERS_MAXHANDLE;
+      }
+
+      // take the staged keys out of the transaction table, the transaction is finished with the commit
+      pthread_mutex_lock(&gKeyTransactionMtx);
+      memcpy(&tx, &gKeyTransaction[transaction], sizeof(PersTransaction_s));
+      if(tx.used != 0)
+      {
+         memset(&gKeyTransaction[transaction], 0, sizeof(PersTransaction_s));
+      }
+      pthread_mutex_unlock(&gKeyTransactionMtx);
+
+      if(tx.used == 0)
+      {
+         rval = EPERS_MAXHANDLE;
+      }
+      else if(tx.numKeys == 0)
+      {
+         rval = 0;
+      }
+      else if(AccessNoLock == isAccessLocked() )     // check if access to persistent data is locked
+      {
+         rval = EPERS_LOCKFS;
+      }
+      else
+      {
+         const char** keys = malloc(tx.numKeys * sizeof(const char*));
+         const char** resIds = malloc(tx.numKeys * sizeof(const char*));
+         unsigned char** buffers = malloc(tx.numKeys * sizeof(unsigned char*));
+         int* sizes = malloc(tx.numKeys * sizeof(int));
+         int* results = malloc(tx.numKeys * sizeof(int));
+
+         if(keys != NULL && resIds != NULL && buffers != NULL && sizes != NULL && results != NULL)
+         {
+            pthread_rwlock_t* accessLock = get_key_access_lock(&tx.info);
+            int lock = 0;
+            unsigned int i = 0;
+
+            unsigned int numChanged = 0, numApplied = 0;
 
-                  // get database context: database path and database key
-                  data_size = get_db_context(&dbContext, resource_id, ResIsNoFile, dbKey, dbPath);
-                  if(   (data_size >= 0)
-                     && (dbContext.configKey.type == PersistenceResourceType_key))
+            // no other access to the database until all keys have been written
+            lock = pthread_rwlock_wrlock(accessLock);
+            if(lock == 0)
+            {
+               for(i = 0; i < tx.numKeys; i++)
+               {
+                  if(persistence_data_unchanged(tx.dbPath, tx.keys[i].dbKey, tx.keys[i].resource_id, &tx.info,
+                                                tx.keys[i].data, tx.keys[i].size) == 0)
                   {
-                     if(dbContext.configKey.permission != PersistencePermission_ReadOnly)    // don't write to a read only resource
-                     {
-                        // store data
-                        if(dbContext.configKey.storage < PersistenceStorage_LastEntry)       // check if store policy is valid
-                        {
-                           if(   (dbContext.configKey.storage == PersistenceStorage_shared)
-                              && (0 != strncmp(dbContext.configKey.reponsible, gAppId, PERS_RCT_MAX_LENGTH_RESPONSIBLE) ) )
-                           {
-                              data_size = EPERS_NOT_RESP_APP;
-                           }
-                           else
-                           {
-                              data_size = persistence_set_data(dbPath, dbKey, resource_id, &dbContext, buffer, buffer_size);
-                           }
-                        }
-                        else
-                        {
-                           data_size = EPERS_BADPOL;
-                        }
-                     }
-                     else
+                     keys[numChanged]    = tx.keys[i].dbKey;
+                     resIds[numChanged]  = tx.keys[i].resource_id;
+                     buffers[numChanged] = tx.keys[i].data;
+                     sizes[numChanged]   = tx.keys[i].size;
+                     numChanged++;
+                  }
+               }
+
+               rval = (numChanged > 0) ? persistence_commit_data(tx.dbPath, &tx.info, keys, resIds, buffers, sizes, results, numChanged, &numApplied) : 0;
+
+               pthread_rwlock_unlock(accessLock);
+
+               if(rval < 0)
+               {
+                  // the keys staged before the failed one have been written
+                  DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyTransactionCommit - commit failed:"), DLT_INT(rval),
+                                                          DLT_STRING("keys applied:"), DLT_UINT(numApplied), DLT_STRING("of"), DLT_UINT(numChanged));
+               }
+               else
+               {
+                  rval = (int)tx.numKeys;
+               }
+
+               // notifications of the applied keys are sent after all keys have been committed
+               if(PersistenceStorage_shared == tx.info.configKey.storage && numApplied > 0)
+               {
+                  PersistenceDbContext_s** contexts = malloc(numApplied * sizeof(PersistenceDbContext_s*));
+                  int notifyRval = EPERS_NOTIFY_SIG;
+
+                  if(contexts != NULL)
+                  {
+                     for(i = 0; i < numApplied; i++)
                      {
-                        data_size = EPERS_RESOURCE_READ_ONLY;
+                        contexts[i] = &tx.info.context;
                      }
+                     notifyRval = pers_send_Notification_Signal_Batch(resIds, contexts, numApplied, pclNotifyStatus_changed);
+                     free(contexts);
                   }
-                  else
+
+                  if(notifyRval <= 0)
                   {
-                     DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyWriteData no db context or res is not a key"));
+                     DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyTransactionCommit - Err to send noty sig"));
+                     rval = (rval < 0) ? rval : EPERS_NOTIFY_SIG;
                   }
                }
-               else
-               {
-                  data_size = EPERS_BUFLIMIT;
-                  DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyWriteData - buffer_size to big, limit is [bytes]:"), DLT_INT(gMaxKeyValDataSize));
-               }
             }
             else
             {
-               data_size = EPERS_LOCKFS;
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyTransactionCommit - rwlock lock failed:"), DLT_INT(lock));
+               rval = EPERS_COMMON;
             }
-#if USE_APPCHECK
          }
          else
          {
-            data_size = EPERS_SHUTDOWN_NO_TRUSTED;
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyTransactionCommit - malloc failed"));
+            rval = EPERS_COMMON;
          }
-#endif
-         pthread_mutex_unlock(&gKeyAPIAccessMtx);
-      }
-      else
-      {
-         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclKeyWriteData - mutex lock failed:"), DLT_INT(lock));
+
+         free(keys);
+         free(resIds);
+         free(buffers);
+         free(sizes);
+         free(results);
       }
+
+      transaction_release(&tx);
    }
-   else
+
+   return rval;
+}
+
+
+
+int pclKeyTransactionAbort(int transaction)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyTransactionAbort - transaction:"), DLT_INT(transaction));
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
    {
-      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("pclKeyWriteData - not initialized"));
-   }
+      rval = EPERS_MAXHANDLE;
 
-   //DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("<- pclKeyWriteData - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
+      if(transaction >= 0 && transaction < MaxKeyTransactions)
+      {
+         pthread_mutex_lock(&gKeyTransactionMtx);
+         if(gKeyTransaction[transaction].used != 0)
+         {
+            transaction_release(&gKeyTransaction[transaction]);
+            rval = 0;
+         }
+         pthread_mutex_unlock(&gKeyTransactionMtx);
+      }
+   }
 
-   return data_size;
+   return rval;
 }
 
 
@@ -785,12 +1853,12 @@ int pclKeyUnRegisterNotifyOnChange( unsigned int  ldbid, const char *  resource_
    int lock = 0;
    DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyUnRegisterNotifyOnChange - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "),DLT_STRING(resource_id));
 
-   lock = pthread_mutex_lock(&gKeyAPIAccessMtx);
+   lock = pthread_mutex_lock(&gKeyAPINotifyMtx);
    if(lock == 0)
    {
       rval = regNotifyOnChange(ldbid, resource_id, user_no, seat_no, callback, Notify_unregister);
 
-      pthread_mutex_unlock(&gKeyAPIAccessMtx);
+      pthread_mutex_unlock(&gKeyAPINotifyMtx);
    }
    else
    {
@@ -810,7 +1878,7 @@ int pclKeyRegisterNotifyOnChange(unsigned int ldbid, const char* resource_id, un
 
    DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyRegisterNotifyOnChange - ldbid:"), DLT_UINT(ldbid), DLT_STRING(" res: "), DLT_STRING(resource_id) );
 
-   lock = pthread_mutex_lock(&gKeyAPIAccessMtx);
+   lock = pthread_mutex_lock(&gKeyAPINotifyMtx);
    if(lock == 0)
    {
       if((gChangeNotifyCallback == callback) || (gChangeNotifyCallback == NULL))
@@ -822,7 +1890,7 @@ int pclKeyRegisterNotifyOnChange(unsigned int ldbid, const char* resource_id, un
          DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclKeyRegisterNotifyOnChange - Only one cBack is allowed for ch noti."));
          rval = EPERS_NOTIFY_NOT_ALLOWED;
       }
-      pthread_mutex_unlock(&gKeyAPIAccessMtx);
+      pthread_mutex_unlock(&gKeyAPINotifyMtx);
    }
    else
    {
@@ -899,3 +1967,344 @@ int regNotifyOnChange(unsigned int ldbid, const char* resource_id, unsigned int
 
    return rval;
 }
+
+
+
+/**
+ * @brief load the key list of the next database of an iterator
+ *
+ * @param iterator the iterator
+ *
+ * @return 1 if a key list has been loaded; 0 if there is no database left; a negative value on error
+ */
+static int iterator_load_next_db(PersKeyIterator_s* iterator)
+{
+   int rval = 0;
+
+   free(iterator->keyList);
+   iterator->keyList     = NULL;
+   iterator->keyListSize = 0;
+   iterator->keyListPos  = 0;
+
+   while(rval == 0 && ++iterator->policy < PersistencePolicy_na)
+   {
+      int handleDB = -1;
+      unsigned int dbGeneration = persistence_get_db_generation();
+
+      iterator->info.configKey.policy = (PersistencePolicy_e)iterator->policy;
+      memset(iterator->dbPath, 0, PERS_ORG_MAX_LENGTH_PATH_FILENAME);
+      (void)get_db_path_and_key(&iterator->info, "", iterator->contextPrefix, iterator->dbPath);
+
+      handleDB = persistence_acquire_db_handle(&iterator->info, iterator->dbPath);
+      if(handleDB >= 0)
+      {
+         if(*plugin_persComDbGetSizeKeysList != NULL && *plugin_persComDbGetKeysList != NULL)
+         {
+            pthread_rwlock_t* accessLock = get_key_access_lock(&iterator->info);
+            int lock = pthread_rwlock_rdlock(accessLock);
+
+            if(lock == 0)
+            {
+               int listSize = plugin_persComDbGetSizeKeysList(handleDB);
+               if(listSize > 0)
+               {
+                  iterator->keyList = malloc((size_t)listSize + 1);
+                  if(iterator->keyList != NULL)
+                  {
+                     iterator->keyListSize = plugin_persComDbGetKeysList(handleDB, iterator->keyList, listSize);
+                     if(iterator->keyListSize > 0)
+                     {
+                        iterator->keyList[iterator->keyListSize] = '\0';
+                        rval = 1;
+                     }
+                     else
+                     {
+                        free(iterator->keyList);
+                        iterator->keyList     = NULL;
+                        iterator->keyListSize = 0;
+                     }
+                  }
+                  else
+                  {
+                     DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("iteratorLoadNextDb - malloc failed"));
+                     rval = EPERS_COMMON;
+                  }
+               }
+               pthread_rwlock_unlock(accessLock);
+            }
+            else
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("iteratorLoadNextDb - rwlock lock failed:"), DLT_INT(lock));
+               rval = EPERS_COMMON;
+            }
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("iteratorLoadNextDb - EPERS_NO_PLUGIN_FUNCT"));
+            rval = EPERS_NO_PLUGIN_FUNCT;
+         }
+         persistence_release_db_handle(&iterator->info, iterator->dbPath, dbGeneration);
+      }
+   }
+
+   return rval;
+}
+
+
+
+int pclKeyIterateBegin(unsigned int ldbid, unsigned int user_no, unsigned int seat_no, const char* prefix)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("pclKeyIterateBegin - ldbid:"), DLT_UINT(ldbid));
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+#if USE_APPCHECK
+      if(doAppcheck() == 1)
+      {
+#endif
+         PersKeyIterator_s* iterator = calloc(1, sizeof(PersKeyIterator_s));
+
+         if(iterator != NULL)
+         {
+            int i = 0;
+
+            iterator->policy = -1;     // no database loaded yet
+            iterator->info.context.ldbid   = ldbid;
+            iterator->info.context.user_no = user_no;
+            iterator->info.context.seat_no = seat_no;
+            iterator->info.configKey.type  = PersistenceResourceType_key;
+            iterator->info.configKey.policy  = PersistencePolicy_wc;
+
+            // the database key prefix of the context is the key of an empty resource id
+            iterator->info.configKey.storage = (PersistenceStorage_e)get_db_path_and_key(&iterator->info, "", iterator->contextPrefix, iterator->dbPath);
+            snprintf(iterator->keyPrefix, PERS_DB_MAX_LENGTH_KEY_NAME, "%s%s", iterator->contextPrefix, (prefix != NULL) ? prefix : "");
+
+            rval = EPERS_MAXHANDLE;
+            pthread_mutex_lock(&gKeyIteratorMtx);
+            for(i = 0; i < MaxKeyIterators; i++)
+            {
+               if(gKeyIterator[i] == NULL)
+               {
+                  gKeyIterator[i] = iterator;
+                  rval = i;
+                  break;
+               }
+            }
+            pthread_mutex_unlock(&gKeyIteratorMtx);
+
+            if(rval == EPERS_MAXHANDLE)
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("keyIterateBegin - max no of iterators reached"));
+               free(iterator);
+            }
+         }
+         else
+         {
+            rval = EPERS_COMMON;
+         }
+#if USE_APPCHECK
+      }
+      else
+      {
+         rval = EPERS_SHUTDOWN_NO_TRUSTED;
+      }
+#endif
+   }
+
+   return rval;
+}
+
+
+
+int pclKeyIterateNext(int iterator, pclKeyIterateItem_s* items, unsigned int maxItems,
+                      unsigned char* valueBuffer, unsigned int valueBufferSize)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      PersKeyIterator_s* it = NULL;
+
+      if(iterator < 0 || iterator >= MaxKeyIterators || items == NULL)
+      {
+         return EPERS_MAXHANDLE;
+      }
+
+      pthread_mutex_lock(&gKeyIteratorMtx);
+      it = gKeyIterator[iterator];
+      if(it != NULL)
+      {
+         if(it->busy == 0)
+         {
+            it->busy = 1;     // the iterator is owned by this call, concurrent calls fail
+         }
+         else
+         {
+            it = NULL;
+         }
+      }
+      pthread_mutex_unlock(&gKeyIteratorMtx);
+
+      if(it == NULL)
+      {
+         rval = EPERS_MAXHANDLE;
+      }
+      else if(AccessNoLock == isAccessLocked() )   // check if access to persistent data is locked
+      {
+         rval = EPERS_LOCKFS;
+      }
+      else
+      {
+         unsigned int numItems = 0, valuePos = 0;
+         size_t prefixLen = strlen(it->keyPrefix), contextLen = strlen(it->contextPrefix);
+
+         rval = 0;
+         if(maxItems > MaxKeyIterateChunk)
+         {
+            maxItems = MaxKeyIterateChunk;
+         }
+
+         while(numItems < maxItems && rval >= 0)
+         {
+            const char* key = NULL;
+            size_t keyLen = 0;
+
+            if(it->keyList == NULL || it->keyListPos >= it->keyListSize)
+            {
+               if(it->policy >= PersistencePolicy_na)
+               {
+                  break;   // all databases have been iterated
+               }
+               rval = iterator_load_next_db(it);
+               if(rval <= 0)
+               {
+                  break;
+               }
+            }
+
+            key = &it->keyList[it->keyListPos];
+            keyLen = strlen(key);
+
+            if(keyLen == 0)
+            {
+               it->keyListPos++;
+               continue;
+            }
+
+            if(   (keyLen >= prefixLen)
+               && (0 == strncmp(key, it->keyPrefix, prefixLen)) )
+            {
+               if(valueBuffer != NULL)
+               {
+                  unsigned int dbGeneration = persistence_get_db_generation();
+                  int handleDB = persistence_acquire_db_handle(&it->info, it->dbPath);
+                  int size = (handleDB >= 0 && *plugin_persComDbGetKeySize != NULL) ? plugin_persComDbGetKeySize(handleDB, key) : EPERS_NO_PLUGIN_FUNCT;
+
+                  if(size >= 0 && (unsigned int)size > valueBufferSize - valuePos)
+                  {
+                     if(numItems > 0)
+                     {
+                        persistence_release_db_handle(&it->info, it->dbPath, dbGeneration);
+                        break;      // no space left for the value, return it with the next chunk
+                     }
+                     items[numItems].value      = NULL;
+                     items[numItems].value_size = EPERS_BUFLIMIT;
+                  }
+                  else if(size >= 0 && *plugin_persComDbReadKey != NULL)
+                  {
+                     pthread_rwlock_t* accessLock = get_key_access_lock(&it->info);
+                     int lock = pthread_rwlock_rdlock(accessLock);
+
+                     items[numItems].value      = &valueBuffer[valuePos];
+                     items[numItems].value_size = EPERS_COMMON;
+                     if(lock == 0)
+                     {
+                        items[numItems].value_size = plugin_persComDbReadKey(handleDB, key, (char*)&valueBuffer[valuePos], (int)(valueBufferSize - valuePos));
+                        pthread_rwlock_unlock(accessLock);
+                     }
+                     if(items[numItems].value_size > 0)
+                     {
+                        valuePos += (unsigned int)items[numItems].value_size;
+                     }
+                  }
+                  else
+                  {
+                     items[numItems].value      = NULL;
+                     items[numItems].value_size = size;
+                  }
+
+                  if(handleDB >= 0)
+                  {
+                     persistence_release_db_handle(&it->info, it->dbPath, dbGeneration);
+                  }
+               }
+               else
+               {
+                  items[numItems].value      = NULL;
+                  items[numItems].value_size = 0;
+               }
+
+               strncpy(it->keys[numItems], key, PERS_DB_MAX_LENGTH_KEY_NAME-1);
+               it->keys[numItems][PERS_DB_MAX_LENGTH_KEY_NAME-1] = '\0';
+               items[numItems].resource_id = &it->keys[numItems][(contextLen < keyLen) ? contextLen : keyLen];
+               numItems++;
+            }
+
+            it->keyListPos += (int)keyLen + 1;
+         }
+
+         if(rval >= 0 || numItems > 0)
+         {
+            rval = (int)numItems;
+         }
+      }
+
+      if(it != NULL)
+      {
+         pthread_mutex_lock(&gKeyIteratorMtx);
+         it->busy = 0;
+         pthread_mutex_unlock(&gKeyIteratorMtx);
+      }
+   }
+
+   return rval;
+}
+
+
+
+int pclKeyIterateEnd(int iterator)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      PersKeyIterator_s* it = NULL;
+
+      rval = EPERS_MAXHANDLE;
+      if(iterator >= 0 && iterator < MaxKeyIterators)
+      {
+         pthread_mutex_lock(&gKeyIteratorMtx);
+         it = gKeyIterator[iterator];
+         if(it != NULL && it->busy == 0)
+         {
+            gKeyIterator[iterator] = NULL;
+         }
+         else
+         {
+            it = NULL;
+         }
+         pthread_mutex_unlock(&gKeyIteratorMtx);
+      }
+
+      if(it != NULL)
+      {
+         free(it->keyList);
+         free(it);
+         rval = 0;
+      }
+   }
+
+   return rval;
+}
@@ -0,0 +1,394 @@
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_key_async.c
+ * @ingroup        Persistence client library
+ * @brief          Implementation of the asynchronous key write queue.
+ *                 Writes are copied into a preallocated queue and written
+ *                 in order by a worker thread.
+ * @see
+ */
+
+#include "persistence_client_library_key_async.h"
+
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/eventfd.h>
+#include <dlt.h>
+
+DLT_IMPORT_CONTEXT(gPclDLTContext);
+
+
+/// queued asynchronous key write
+typedef struct _PersAsyncWrite_s
+{
+   /// logical database id
+   unsigned int ldbid;
+   /// user number
+   unsigned int user_no;
+   /// seat number
+   unsigned int seat_no;
+   /// resource id
+   char resource_id[PERS_DB_MAX_LENGTH_KEY_NAME];
+   /// the data, points to inlineData or to allocated memory for large data
+   unsigned char* data;
+   /// size of the data
+   int size;
+   /// completion callback, may be NULL
+   pclKeyWriteAsyncCallback_t callback;
+   /// time the write has been queued
+   struct timespec queueTime;
+   /// storage for small data, no allocation needed
+   unsigned char inlineData[AsyncWriteInlineSize];
+} PersAsyncWrite_s;
+
+
+/// the write queue (ring buffer)
+static PersAsyncWrite_s gAsyncQueue[AsyncWriteQueueSize];
+/// index of the oldest queued write
+static unsigned int gAsyncHead = 0;
+/// number of queued writes
+static unsigned int gAsyncCount = 0;
+
+/// protects the write queue and the statistics
+static pthread_mutex_t gAsyncMtx = PTHREAD_MUTEX_INITIALIZER;
+/// signaled when a write has been queued or the worker must stop
+static pthread_cond_t gAsyncWorkCond = PTHREAD_COND_INITIALIZER;
+/// signaled when a write has been completed
+static pthread_cond_t gAsyncDoneCond = PTHREAD_COND_INITIALIZER;
+
+/// the write worker thread
+static pthread_t gAsyncThread;
+/// flag to indicate if the write worker thread is running
+static int gAsyncRunning = 0;
+/// flag to indicate that the write worker thread must stop when the queue is empty
+static int gAsyncQuit = 0;
+
+/// eventfd signaling completed writes, -1 if not (yet) created
+static int gAsyncEventFd = -1;
+
+/// statistics
+static pclKeyWriteAsyncStats_s gAsyncStats;
+/// sum of the latencies of all completed writes [us]
+static unsigned long long gAsyncLatencySum = 0;
+
+
+
+static unsigned long long elapsed_us(const struct timespec* start)
+{
+   struct timespec now;
+   long long us = 0;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   us = ((long long)now.tv_sec - (long long)start->tv_sec) * 1000000LL + (now.tv_nsec - start->tv_nsec) / 1000;
+
+   return (us > 0) ? (unsigned long long)us : 0;
+}
+
+
+
+static void* async_write_worker(void* userData)
+{
+   (void)userData;
+
+   pthread_mutex_lock(&gAsyncMtx);
+   for(;;)
+   {
+      PersAsyncWrite_s* item = NULL;
+      unsigned long long latency = 0;
+      int rval = 0;
+
+      while(gAsyncCount == 0 && gAsyncQuit == 0)
+      {
+         pthread_cond_wait(&gAsyncWorkCond, &gAsyncMtx);
+      }
+
+      if(gAsyncCount == 0)   // quit and nothing left to write
+      {
+         break;
+      }
+
+      // the slot at the head is not reused before the write has been completed
+      item = &gAsyncQueue[gAsyncHead];
+      pthread_mutex_unlock(&gAsyncMtx);
+
+      rval = pclKeyWriteData(item->ldbid, item->resource_id, item->user_no, item->seat_no, item->data, item->size);
+      latency = elapsed_us(&item->queueTime);
+
+      if(item->callback != NULL)
+      {
+         item->callback(item->ldbid, item->resource_id, item->user_no, item->seat_no, rval);
+      }
+
+      if(item->data != item->inlineData)
+      {
+         free(item->data);
+      }
+      item->data = NULL;
+
+      pthread_mutex_lock(&gAsyncMtx);
+      gAsyncHead = (gAsyncHead + 1) % AsyncWriteQueueSize;
+      gAsyncCount--;
+
+      gAsyncStats.queueDepth = gAsyncCount;
+      gAsyncStats.numCompleted++;
+      if(rval < 0)
+      {
+         gAsyncStats.numFailed++;
+      }
+      gAsyncLatencySum += latency;
+      if(latency > gAsyncStats.maxLatencyUs)
+      {
+         gAsyncStats.maxLatencyUs = latency;
+      }
+      pthread_cond_broadcast(&gAsyncDoneCond);
+
+      if(gAsyncEventFd != -1)
+      {
+         uint64_t one = 1;
+         if(write(gAsyncEventFd, &one, sizeof(one)) == -1)
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("asyncWriteWorker - eventfd write failed:"), DLT_INT(errno));
+         }
+      }
+   }
+   pthread_mutex_unlock(&gAsyncMtx);
+
+   return NULL;
+}
+
+
+
+/**
+ * @brief start the write worker thread if not already running, gAsyncMtx must be locked
+ *
+ * @return 0 on success, EPERS_COMMON if the thread could not be created
+ */
+static int async_write_start(void)
+{
+   int rval = 0;
+
+   if(gAsyncRunning == 0)
+   {
+      gAsyncQuit = 0;
+      if(pthread_create(&gAsyncThread, NULL, async_write_worker, NULL) == 0)
+      {
+         (void)pthread_setname_np(gAsyncThread, "pclAsyncWrite");
+         gAsyncRunning = 1;
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("asyncWriteStart - pthread_create failed"));
+         rval = EPERS_COMMON;
+      }
+   }
+
+   return rval;
+}
+
+
+
+int pclKeyWriteDataAsync(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no,
+                         unsigned char* buffer, int buffer_size, pclKeyWriteAsyncCallback_t callback)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      if(resource_id == NULL || buffer == NULL || buffer_size < 0)
+      {
+         rval = EPERS_COMMON;
+      }
+      else if(buffer_size > PERS_DB_MAX_SIZE_KEY_DATA)
+      {
+         rval = EPERS_BUFLIMIT;
+      }
+      else
+      {
+         pthread_mutex_lock(&gAsyncMtx);
+
+         if(gAsyncCount >= AsyncWriteQueueSize)
+         {
+            rval = EPERS_QUEUE_FULL;
+         }
+         else if((rval = async_write_start()) == 0)
+         {
+            PersAsyncWrite_s* item = &gAsyncQueue[(gAsyncHead + gAsyncCount) % AsyncWriteQueueSize];
+
+            item->data = (buffer_size <= AsyncWriteInlineSize) ? item->inlineData : malloc((size_t)buffer_size);
+            if(item->data != NULL)
+            {
+               memcpy(item->data, buffer, (size_t)buffer_size);
+               item->size     = buffer_size;
+               item->ldbid    = ldbid;
+               item->user_no  = user_no;
+               item->seat_no  = seat_no;
+               item->callback = callback;
+               strncpy(item->resource_id, resource_id, PERS_DB_MAX_LENGTH_KEY_NAME-1);
+               item->resource_id[PERS_DB_MAX_LENGTH_KEY_NAME-1] = '\0';
+               clock_gettime(CLOCK_MONOTONIC, &item->queueTime);
+
+               gAsyncCount++;
+               gAsyncStats.queueDepth = gAsyncCount;
+               if(gAsyncCount > gAsyncStats.maxQueueDepth)
+               {
+                  gAsyncStats.maxQueueDepth = gAsyncCount;
+               }
+               pthread_cond_signal(&gAsyncWorkCond);
+
+               rval = buffer_size;
+            }
+            else
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclKeyWriteDataAsync - malloc failed"));
+               rval = EPERS_COMMON;
+            }
+         }
+
+         pthread_mutex_unlock(&gAsyncMtx);
+      }
+   }
+
+   return rval;
+}
+
+
+
+int pclKeyWriteAsyncFlush(void)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      pthread_mutex_lock(&gAsyncMtx);
+      if(gAsyncRunning != 0 && pthread_equal(pthread_self(), gAsyncThread))
+      {
+         rval = EPERS_COMMON;    // called from a completion callback, the write being completed is still queued
+      }
+      else
+      {
+         while(gAsyncCount > 0)
+         {
+            pthread_cond_wait(&gAsyncDoneCond, &gAsyncMtx);
+         }
+         rval = 0;
+      }
+      pthread_mutex_unlock(&gAsyncMtx);
+   }
+
+   return rval;
+}
+
+
+
+int key_async_flush(unsigned int timeoutMs)
+{
+   int rval = 0;
+   struct timespec deadline;
+
+   clock_gettime(CLOCK_REALTIME, &deadline);     // the clock of gAsyncDoneCond
+   deadline.tv_sec  += (time_t)(timeoutMs / 1000);
+   deadline.tv_nsec += (long)(timeoutMs % 1000) * 1000000L;
+   if(deadline.tv_nsec >= 1000000000L)
+   {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+   }
+
+   pthread_mutex_lock(&gAsyncMtx);
+   while(gAsyncCount > 0 && rval == 0)
+   {
+      if(pthread_cond_timedwait(&gAsyncDoneCond, &gAsyncMtx, &deadline) == ETIMEDOUT)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("keyAsyncFlush - writes not completed:"), DLT_UINT(gAsyncCount));
+         rval = -1;
+      }
+   }
+   pthread_mutex_unlock(&gAsyncMtx);
+
+   return rval;
+}
+
+
+
+int pclKeyWriteAsyncGetFd(void)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      pthread_mutex_lock(&gAsyncMtx);
+      if(gAsyncEventFd == -1)
+      {
+         gAsyncEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+         if(gAsyncEventFd == -1)
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclKeyWriteAsyncGetFd - eventfd failed:"), DLT_INT(errno));
+         }
+      }
+      rval = (gAsyncEventFd != -1) ? gAsyncEventFd : EPERS_COMMON;
+      pthread_mutex_unlock(&gAsyncMtx);
+   }
+
+   return rval;
+}
+
+
+
+int pclKeyWriteAsyncGetStats(pclKeyWriteAsyncStats_s* stats)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      if(stats != NULL)
+      {
+         pthread_mutex_lock(&gAsyncMtx);
+         memcpy(stats, &gAsyncStats, sizeof(pclKeyWriteAsyncStats_s));
+         stats->queueSize    = AsyncWriteQueueSize;
+         stats->avgLatencyUs = (gAsyncStats.numCompleted > 0) ? (gAsyncLatencySum / gAsyncStats.numCompleted) : 0;
+         pthread_mutex_unlock(&gAsyncMtx);
+         rval = 0;
+      }
+      else
+      {
+         rval = EPERS_COMMON;
+      }
+   }
+
+   return rval;
+}
+
+
+
+void key_async_deinit(void)
+{
+   int running = 0;
+
+   pthread_mutex_lock(&gAsyncMtx);
+   running = gAsyncRunning;
+   gAsyncQuit = 1;
+   pthread_cond_signal(&gAsyncWorkCond);
+   pthread_mutex_unlock(&gAsyncMtx);
+
+   if(running != 0)
+   {
+      pthread_join(gAsyncThread, NULL);   // the worker writes all queued data before it ends
+   }
+
+   pthread_mutex_lock(&gAsyncMtx);
+   gAsyncRunning = 0;
+   gAsyncQuit = 0;
+   if(gAsyncEventFd != -1)
+   {
+      close(gAsyncEventFd);
+      gAsyncEventFd = -1;
+   }
+   memset(&gAsyncStats, 0, sizeof(pclKeyWriteAsyncStats_s));
+   gAsyncLatencySum = 0;
+   pthread_mutex_unlock(&gAsyncMtx);
+}
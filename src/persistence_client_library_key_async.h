@@ -0,0 +1,46 @@
+#ifndef PERSISTENCE_CLIENT_LIBRARY_KEY_ASYNC_H
+#define PERSISTENCE_CLIENT_LIBRARY_KEY_ASYNC_H
+
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_key_async.h
+ * @ingroup        Persistence client library
+ * @brief          Header of the asynchronous key write queue.
+ * @see
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "persistence_client_library_data_organization.h"
+
+
+/**
+ * @brief write all queued asynchronous key writes and stop the write worker thread
+ *        (must be called before the dbus mainloop is stopped)
+ */
+void key_async_deinit(void);
+
+
+/**
+ * @brief wait until all queued asynchronous key writes have been written, used on shutdown
+ *        before the data access is locked
+ *
+ * @param timeoutMs max time to wait [ms]; the queued writes may depend on the dbus mainloop
+ *        (change notifications), so the mainloop must not wait for them without a limit
+ *
+ * @return 0 if the queue is empty, -1 if the writes have not been completed in time
+ */
+int key_async_flush(unsigned int timeoutMs);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERSISTENCE_CLIENT_LIBRARY_KEY_ASYNC_H */
@@ -0,0 +1,397 @@
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_key_manifest.c
+ * @ingroup        Persistence client library
+ * @brief          Implementation of the boot access manifest.
+ *                 The keys read during the first seconds after pclInitLibrary are stored
+ *                 in the application cache folder. On the next start the values of these
+ *                 keys are read in the background into the read cache (PERS_CLIENT_LIB_READ_CACHE),
+ *                 which keeps them coherent with writes and change notifications.
+ * @see
+ */
+
+#include "persistence_client_library_key_manifest.h"
+#include "persistence_client_library_pas_interface.h"
+#include "persistence_client_library_db_access.h"
+#include "crc32.h"
+
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+#include <dlt.h>
+
+DLT_IMPORT_CONTEXT(gPclDLTContext);
+
+
+/// key of the boot access manifest
+typedef struct _PersManifestEntry_s
+{
+   /// the slot is used
+   int used;
+   /// logical database id
+   unsigned int ldbid;
+   /// user number
+   unsigned int user_no;
+   /// seat number
+   unsigned int seat_no;
+   /// resource id
+   char resource_id[PERS_DB_MAX_LENGTH_KEY_NAME];
+} PersManifestEntry_s;
+
+
+/// file the keys read during the recording window are stored in, located in the application cache folder
+static const char* gManifestFilename = "BootManifest.info";
+/// the full path of the manifest file
+static char gManifestFile[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+
+/// flag to indicate if the manifest is enabled
+static int gManifestEnabled = 0;
+/// recording window after the start [s]
+static unsigned int gManifestWindow = 0;
+/// time the manifest has been started
+static struct timespec gManifestStartTime;
+
+/// protects the manifest tables and counters
+static pthread_mutex_t gManifestMtx = PTHREAD_MUTEX_INITIALIZER;
+
+/// the keys read during this run (open addressing by ldbid and resource id)
+static PersManifestEntry_s gManifestRecorded[BootManifestTableSize];
+/// the recorded keys in the order of the first read
+static PersManifestEntry_s* gManifestRecordOrder[BootManifestMaxEntries];
+/// number of recorded keys
+static unsigned int gManifestNumRecorded = 0;
+
+/// the keys of the previous run (open addressing by ldbid and resource id), the set of keys to prefetch
+static PersManifestEntry_s gManifestCache[BootManifestTableSize];
+/// the keys to prefetch in the order of the manifest file
+static PersManifestEntry_s* gManifestLoadOrder[BootManifestMaxEntries];
+/// number of keys to prefetch
+static unsigned int gManifestNumLoad = 0;
+
+/// the prefetch thread
+static pthread_t gManifestThread;
+/// flag to indicate if the prefetch thread is running
+static int gManifestRunning = 0;
+/// flag to indicate that the prefetch thread must stop
+static int gManifestQuit = 0;
+
+/// counters
+static pclKeyBootManifestStats_s gManifestStats;
+
+
+
+static unsigned int manifest_hash(unsigned int ldbid, const char* resource_id)
+{
+   unsigned int hash = pclCrc32(0, (const unsigned char*)resource_id, strlen(resource_id));
+
+   hash ^= ldbid * 2654435761u;
+
+   return hash ^ (hash >> 16);
+}
+
+
+
+/**
+ * @brief find a key in a manifest table, gManifestMtx must be locked
+ *
+ * @param insert 1 to return the free slot the key can be inserted into if it is not in the table
+ *
+ * @return the entry, the free slot or NULL
+ */
+static PersManifestEntry_s* manifest_find(PersManifestEntry_s table[], unsigned int ldbid, const char* resource_id,
+                                          unsigned int user_no, unsigned int seat_no, int insert)
+{
+   unsigned int idx = manifest_hash(ldbid, resource_id) & (BootManifestTableSize-1);
+   unsigned int i = 0;
+
+   for(i = 0; i < BootManifestTableSize; i++)
+   {
+      PersManifestEntry_s* entry = &table[idx];
+
+      if(entry->used == 0)
+      {
+         return (insert != 0) ? entry : NULL;
+      }
+
+      if(   entry->ldbid == ldbid && entry->user_no == user_no && entry->seat_no == seat_no
+         && strncmp(entry->resource_id, resource_id, PERS_DB_MAX_LENGTH_KEY_NAME) == 0)
+      {
+         return entry;
+      }
+      idx = (idx + 1) & (BootManifestTableSize-1);
+   }
+
+   return NULL;
+}
+
+
+
+/**
+ * @brief number of prefetched values which have not been read, gManifestMtx must be locked
+ */
+static unsigned int manifest_num_wasted(void)
+{
+   return (gManifestStats.numHits < gManifestStats.numPrefetched)
+          ? gManifestStats.numPrefetched - (unsigned int)gManifestStats.numHits : 0;
+}
+
+
+
+static int manifest_in_window(void)
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return ((unsigned long)(now.tv_sec - gManifestStartTime.tv_sec) < gManifestWindow) ? 1 : 0;
+}
+
+
+
+/**
+ * @brief read the keys recorded during the previous run into the cache
+ */
+static void manifest_read_file(void)
+{
+   FILE* file = fopen(gManifestFile, "r");
+
+   if(file != NULL)
+   {
+      char line[PERS_DB_MAX_LENGTH_KEY_NAME + 64] = {0};
+      char format[32] = {0};
+
+      snprintf(format, sizeof(format), "%%x %%u %%u %%%d[^\n]", PERS_DB_MAX_LENGTH_KEY_NAME-1);
+
+      while(fgets(line, (int)sizeof(line), file) != NULL && gManifestNumLoad < BootManifestMaxEntries)
+      {
+         PersManifestEntry_s key;
+
+         memset(&key, 0, sizeof(PersManifestEntry_s));
+         if(sscanf(line, format, &key.ldbid, &key.user_no, &key.seat_no, key.resource_id) == 4)
+         {
+            PersManifestEntry_s* entry = manifest_find(gManifestCache, key.ldbid, key.resource_id, key.user_no, key.seat_no, 1);
+
+            if(entry != NULL && entry->used == 0)     // each key is prefetched once
+            {
+               memcpy(entry, &key, sizeof(PersManifestEntry_s));
+               entry->used = 1;
+               gManifestLoadOrder[gManifestNumLoad++] = entry;
+            }
+         }
+      }
+      fclose(file);
+   }
+}
+
+
+
+/**
+ * @brief write the keys recorded during this run
+ */
+static void manifest_write_file(void)
+{
+   FILE* file = fopen(gManifestFile, "w");
+
+   if(file != NULL)
+   {
+      unsigned int i = 0;
+
+      for(i = 0; i < gManifestNumRecorded; i++)
+      {
+         const PersManifestEntry_s* entry = gManifestRecordOrder[i];
+         fprintf(file, "%x %u %u %s\n", entry->ldbid, entry->user_no, entry->seat_no, entry->resource_id);
+      }
+      fclose(file);
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("bootManifest - Err write file"), DLT_STRING(gManifestFile), DLT_STRING(strerror(errno)));
+   }
+}
+
+
+
+static void* manifest_prefetch_worker(void* userData)
+{
+   unsigned char* buffer = malloc(PERS_DB_MAX_SIZE_KEY_DATA);
+   unsigned int i = 0;
+
+   (void)userData;
+
+   persistence_read_cache_set_prefetch(1);      // the values read by this thread are marked as prefetched
+
+   for(i = 0; buffer != NULL && i < gManifestNumLoad; i++)
+   {
+      const PersManifestEntry_s* entry = gManifestLoadOrder[i];
+
+      if(__sync_add_and_fetch(&gManifestQuit, 0) != 0 || isAccessLocked() == AccessNoLock)
+      {
+         break;
+      }
+
+      if(key_read_data(entry->ldbid, entry->resource_id, entry->user_no, entry->seat_no, buffer, PERS_DB_MAX_SIZE_KEY_DATA) >= 0)
+      {
+         pthread_mutex_lock(&gManifestMtx);
+         gManifestStats.numPrefetched++;
+         pthread_mutex_unlock(&gManifestMtx);
+      }
+   }
+
+   persistence_read_cache_set_prefetch(0);
+   free(buffer);
+
+   return NULL;
+}
+
+
+
+void key_manifest_start(const char* appName)
+{
+   const char* window = getenv("PERS_CLIENT_LIB_BOOT_MANIFEST");
+
+   if(window != NULL && gManifestEnabled == 0)
+   {
+      pthread_mutex_lock(&gManifestMtx);
+
+      gManifestWindow = (unsigned int)strtoul(window, NULL, 0);
+      if(gManifestWindow > 0)
+      {
+         snprintf(gManifestFile, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s/%s", CACHEPREFIX, appName, gManifestFilename);
+         clock_gettime(CLOCK_MONOTONIC, &gManifestStartTime);
+
+         // the prefetched values are kept by the read cache only, without it they would be read for nothing
+         if(persistence_read_cache_enabled() == 1)
+         {
+            manifest_read_file();
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("bootManifest - read cache disabled (PERS_CLIENT_LIB_READ_CACHE), no prefetch"));
+         }
+
+         gManifestQuit = 0;
+         if(gManifestNumLoad > 0)
+         {
+            if(pthread_create(&gManifestThread, NULL, manifest_prefetch_worker, NULL) == 0)
+            {
+               (void)pthread_setname_np(gManifestThread, "pclPrefetch");
+               gManifestRunning = 1;
+            }
+            else
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("bootManifest - pthread_create failed"));
+            }
+         }
+
+         gManifestEnabled = 1;
+         DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("bootManifest - window [s]:"), DLT_UINT(gManifestWindow),
+                                               DLT_STRING("prefetch:"), DLT_UINT(gManifestNumLoad));
+      }
+
+      pthread_mutex_unlock(&gManifestMtx);
+   }
+}
+
+
+
+void key_manifest_deinit(void)
+{
+   if(gManifestRunning != 0)
+   {
+      (void)__sync_lock_test_and_set(&gManifestQuit, 1);
+      pthread_join(gManifestThread, NULL);
+      gManifestRunning = 0;
+   }
+
+   pthread_mutex_lock(&gManifestMtx);
+   if(gManifestEnabled != 0)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("bootManifest - hits:"), DLT_UINT64(gManifestStats.numHits),
+                                            DLT_STRING("misses:"), DLT_UINT64(gManifestStats.numMisses),
+                                            DLT_STRING("prefetched:"), DLT_UINT(gManifestStats.numPrefetched),
+                                            DLT_STRING("wasted:"), DLT_UINT(manifest_num_wasted()));
+      manifest_write_file();
+
+      memset(gManifestCache, 0, sizeof(gManifestCache));
+      memset(gManifestRecorded, 0, sizeof(gManifestRecorded));
+      memset(&gManifestStats, 0, sizeof(pclKeyBootManifestStats_s));
+      gManifestNumLoad = 0;
+      gManifestNumRecorded = 0;
+      gManifestEnabled = 0;
+   }
+   pthread_mutex_unlock(&gManifestMtx);
+}
+
+
+
+void key_manifest_record(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no)
+{
+   if(__sync_add_and_fetch(&gManifestEnabled, 0) != 0 && resource_id != NULL)
+   {
+      int hit = persistence_read_cache_prefetch_hit();
+      int inWindow = manifest_in_window();
+
+      if(hit != 0 || inWindow == 1)
+      {
+         pthread_mutex_lock(&gManifestMtx);
+
+         if(hit != 0)
+         {
+            gManifestStats.numHits++;
+         }
+         else
+         {
+            gManifestStats.numMisses++;
+         }
+
+         if(inWindow == 1 && gManifestNumRecorded < BootManifestMaxEntries)
+         {
+            PersManifestEntry_s* entry = manifest_find(gManifestRecorded, ldbid, resource_id, user_no, seat_no, 1);
+
+            if(entry != NULL && entry->used == 0)     // each key is recorded once
+            {
+               entry->ldbid   = ldbid;
+               entry->user_no = user_no;
+               entry->seat_no = seat_no;
+               strncpy(entry->resource_id, resource_id, PERS_DB_MAX_LENGTH_KEY_NAME-1);
+               entry->resource_id[PERS_DB_MAX_LENGTH_KEY_NAME-1] = '\0';
+               entry->used = 1;
+               gManifestRecordOrder[gManifestNumRecorded++] = entry;
+            }
+         }
+
+         pthread_mutex_unlock(&gManifestMtx);
+      }
+   }
+}
+
+
+
+int pclKeyGetBootManifestStats(pclKeyBootManifestStats_s* stats)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      if(stats != NULL)
+      {
+         pthread_mutex_lock(&gManifestMtx);
+         memcpy(stats, &gManifestStats, sizeof(pclKeyBootManifestStats_s));
+         stats->windowSec   = (gManifestEnabled != 0) ? gManifestWindow : 0;
+         stats->numRecorded = gManifestNumRecorded;
+         stats->numWasted   = manifest_num_wasted();
+         pthread_mutex_unlock(&gManifestMtx);
+         rval = 0;
+      }
+      else
+      {
+         rval = EPERS_COMMON;
+      }
+   }
+
+   return rval;
+}
@@ -0,0 +1,75 @@
+#ifndef PERSISTENCE_CLIENT_LIBRARY_KEY_MANIFEST_H
+#define PERSISTENCE_CLIENT_LIBRARY_KEY_MANIFEST_H
+
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_key_manifest.h
+ * @ingroup        Persistence client library
+ * @brief          Header of the boot access manifest: the keys read shortly after
+ *                 pclInitLibrary are recorded and prefetched on the next start.
+ * @see
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "persistence_client_library_data_organization.h"
+
+
+/**
+ * @brief start recording the keys read and prefetch the keys of the previous run in the background
+ *        into the read cache.
+ *        The environment variable PERS_CLIENT_LIB_BOOT_MANIFEST defines the recording window [s]
+ *        after pclInitLibrary, nothing is done if it is not set. The keys are not prefetched
+ *        if the read cache is disabled (PERS_CLIENT_LIB_READ_CACHE).
+ *
+ * @param appName the application name
+ */
+void key_manifest_start(const char* appName);
+
+
+/**
+ * @brief stop the prefetch and store the keys recorded during this run
+ */
+void key_manifest_deinit(void);
+
+
+/**
+ * @brief record a key which has been read, it will be prefetched on the next run.
+ *        Counts if the value has been served from a prefetched value of the read cache.
+ *
+ * @param ldbid logical database ID
+ * @param resource_id the resource ID
+ * @param user_no the user ID
+ * @param seat_no the seat number
+ */
+void key_manifest_record(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no);
+
+
+/**
+ * @brief read the data of a key without the initialization, access lock and manifest checks of pclKeyReadData
+ *        (implemented in persistence_client_library_key.c)
+ *
+ * @param ldbid logical database ID
+ * @param resource_id the resource ID
+ * @param user_no the user ID
+ * @param seat_no the seat number
+ * @param buffer the buffer for the data
+ * @param buffer_size size of the buffer
+ *
+ * @return positive value (0 or greater): the size of the data; a negative value on error
+ */
+int key_read_data(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no,
+                  unsigned char* buffer, int buffer_size);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERSISTENCE_CLIENT_LIBRARY_KEY_MANIFEST_H */
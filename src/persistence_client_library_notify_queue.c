@@ -0,0 +1,576 @@
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_notify_queue.c
+ * @ingroup        Persistence client library
+ * @brief          Implementation of the change notification queue.
+ *                 Notifications are copied into a preallocated queue and delivered
+ *                 in order to the dbus mainloop by a sender thread.
+ *                 Within the coalescing window of a key, the changes following a
+ *                 notification are held back and sent as one notification with the
+ *                 latest status when the window ends.
+ * @see
+ */
+
+#include "persistence_client_library_notify_queue.h"
+#include "crc32.h"
+
+#include <pthread.h>
+#include <time.h>
+#include <dlt.h>
+
+DLT_IMPORT_CONTEXT(gPclDLTContext);
+
+
+/// the notification queue (ring buffer)
+static MainLoopData_u gNotifyQueue[NotifyQueueSize];
+/// index of the oldest queued notification
+static unsigned int gNotifyHead = 0;
+/// number of queued notifications, including the ones currently delivered
+static unsigned int gNotifyCount = 0;
+
+/// protects the notification queue
+static pthread_mutex_t gNotifyMtx = PTHREAD_MUTEX_INITIALIZER;
+/// signaled when a notification has been queued or the sender must stop
+static pthread_cond_t gNotifyWorkCond = PTHREAD_COND_INITIALIZER;
+/// signaled when notifications have been delivered to the mainloop
+static pthread_cond_t gNotifyDoneCond = PTHREAD_COND_INITIALIZER;
+
+/// the sender thread
+static pthread_t gNotifyThread;
+/// flag to indicate if the sender thread is running
+static int gNotifyRunning = 0;
+/// flag to indicate that the sender thread must stop when the queue is empty
+static int gNotifyQuit = 0;
+/// number of threads waiting in pclKeyNotificationFlush, held back notifications are sent at once
+static int gNotifyFlush = 0;
+/// send several queued notifications as one batched signal (environment variable PERS_CLIENT_LIB_NOTIFY_BATCH):
+/// 0 per key signals only, 1 batched signal and per key signals for listeners not knowing it, 2 batched signal only
+static int gNotifyBatch = 0;
+
+
+/// coalescing window of a logical database or of a resource
+typedef struct _PersNotifyWindow_s
+{
+   /// the entry is used
+   int used;
+   /// logical database id
+   unsigned int ldbid;
+   /// the window [ms]
+   unsigned int windowMs;
+   /// resource id, empty for the whole logical database
+   char resource_id[PERS_DB_MAX_LENGTH_KEY_NAME];
+} PersNotifyWindow_s;
+
+/// the coalescing windows set with pclKeySetNotifyCoalescing
+static PersNotifyWindow_s gNotifyWindow[MaxNotifyWindows];
+/// coalescing window of all other keys [ms] (environment variable PERS_CLIENT_LIB_NOTIFY_COALESCE)
+static unsigned int gNotifyDefaultWindow = 0;
+
+
+/// last notification of a key with a coalescing window
+typedef struct _PersNotifyCoalesce_s
+{
+   /// the entry is used
+   int used;
+   /// a notification is held back until the end of the window
+   int pending;
+   /// time the last notification has been queued [ms]
+   unsigned long long lastQueued;
+   /// end of the window [ms], valid if pending
+   unsigned long long due;
+   /// the notification, carries the latest status
+   MainLoopData_u data;
+} PersNotifyCoalesce_s;
+
+/// last notifications of the keys with a coalescing window, indexed by the hash of the key
+static PersNotifyCoalesce_s gNotifyCoalesce[NotifyCoalesceSize];
+/// number of held back notifications
+static unsigned int gNotifyNumPending = 0;
+
+/// statistics
+static pclKeyNotifyStats_s gNotifyStats;
+
+
+
+static unsigned long long now_ms(void)
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return (unsigned long long)now.tv_sec * 1000ULL + (unsigned long long)now.tv_nsec / 1000000ULL;
+}
+
+
+
+/**
+ * @brief get the coalescing window of a key, gNotifyMtx must be locked
+ *
+ * @return the window [ms], 0 if notifications of the key are not coalesced
+ */
+static unsigned int notify_window(unsigned int ldbid, const char* resource_id)
+{
+   unsigned int window = gNotifyDefaultWindow;
+   int i = 0, found = 0;
+
+   for(i = 0; i < MaxNotifyWindows && found == 0; i++)
+   {
+      if(gNotifyWindow[i].used != 0 && gNotifyWindow[i].ldbid == ldbid)
+      {
+         if(0 == strncmp(gNotifyWindow[i].resource_id, resource_id, PERS_DB_MAX_LENGTH_KEY_NAME))
+         {
+            window = gNotifyWindow[i].windowMs;
+            found = 1;     // the window of the resource wins over the window of the logical database
+         }
+         else if(gNotifyWindow[i].resource_id[0] == '\0')
+         {
+            window = gNotifyWindow[i].windowMs;
+         }
+      }
+   }
+
+   return window;
+}
+
+
+
+/**
+ * @brief copy a notification into the queue, gNotifyMtx must be locked and the queue must not be full
+ */
+static void notify_enqueue(const MainLoopData_u* data)
+{
+   memcpy(&gNotifyQueue[(gNotifyHead + gNotifyCount) % NotifyQueueSize], data, sizeof(MainLoopData_u));
+   gNotifyCount++;
+}
+
+
+
+/**
+ * @brief queue the held back notifications whose window has ended, gNotifyMtx must be locked
+ *
+ * @param all queue all held back notifications
+ *
+ * @return the end of the next window [ms], 0 if no notification is held back anymore
+ */
+static unsigned long long notify_release_pending(int all)
+{
+   unsigned long long next = 0;
+
+   if(gNotifyNumPending > 0)
+   {
+      unsigned long long now = now_ms();
+      int i = 0;
+
+      for(i = 0; i < NotifyCoalesceSize; i++)
+      {
+         PersNotifyCoalesce_s* entry = &gNotifyCoalesce[i];
+
+         if(entry->pending != 0)
+         {
+            if((all != 0 || entry->due <= now) && gNotifyCount < NotifyQueueSize)
+            {
+               notify_enqueue(&entry->data);
+               entry->pending = 0;
+               entry->lastQueued = now;
+               gNotifyNumPending--;
+            }
+            else if(next == 0 || entry->due < next)
+            {
+               next = (entry->due > now) ? entry->due : now + 1;     // queue full: try again soon
+            }
+         }
+      }
+   }
+
+   return next;
+}
+
+
+
+/**
+ * @brief coalesce a notification with the previous notification of the key, gNotifyMtx must be locked
+ *
+ * @return 1 if the notification has been held back; 0 if it must be queued
+ */
+static int notify_coalesce(const MainLoopData_u* data)
+{
+   int rval = 0;
+   unsigned int window = notify_window(data->params[0], data->string);
+
+   // a held back notification of the key must not be overtaken, even if the key is not coalesced anymore
+   if(window > 0 || gNotifyNumPending > 0)
+   {
+      unsigned long long now = now_ms();
+      unsigned int hash = pclCrc32(0, (const unsigned char*)data->string, strnlen(data->string, PERS_DB_MAX_LENGTH_KEY_NAME));
+      PersNotifyCoalesce_s* entry = NULL;
+      int sameKey = 0;
+
+      hash = pclCrc32(hash, (const unsigned char*)data->params, 3 * sizeof(uint32_t));    // ldbid, user, seat
+      entry = &gNotifyCoalesce[hash % NotifyCoalesceSize];
+
+      sameKey = (   (entry->used != 0)
+                 && (entry->data.params[0] == data->params[0])
+                 && (entry->data.params[1] == data->params[1])
+                 && (entry->data.params[2] == data->params[2])
+                 && (0 == strncmp(entry->data.string, data->string, PERS_DB_MAX_LENGTH_KEY_NAME)) ) ? 1 : 0;
+
+      if(sameKey != 0 && entry->pending != 0)         // merged into the held back notification
+      {
+         entry->data.params[3] = data->params[3];
+         if(window == 0)
+         {
+            entry->due = now;       // the window has been removed, send it with the next release
+         }
+         gNotifyStats.numSuppressed++;
+         rval = 1;
+      }
+      else if(window > 0)
+      {
+         if(sameKey != 0 && now < entry->lastQueued + window)
+         {
+            entry->data.params[3] = data->params[3];
+            entry->due = entry->lastQueued + window;
+            entry->pending = 1;
+            gNotifyNumPending++;
+            rval = 1;
+         }
+
+         if(rval == 0 && entry->pending == 0)   // an entry holding back a notification of another key is not replaced
+         {
+            memcpy(&entry->data, data, sizeof(MainLoopData_u));
+            entry->used = 1;
+            entry->lastQueued = now;
+         }
+      }
+   }
+
+   return rval;
+}
+
+
+
+static void* notify_sender_worker(void* userData)
+{
+   (void)userData;
+
+   pthread_mutex_lock(&gNotifyMtx);
+   for(;;)
+   {
+      unsigned int num = 0, index = 0;
+      MainLoopData_u* first = NULL;
+      int batch = 0, rval = 0;
+      unsigned long long next = notify_release_pending(gNotifyQuit != 0 || gNotifyFlush > 0);
+
+      while(gNotifyCount == 0 && gNotifyQuit == 0)
+      {
+         if(next == 0)
+         {
+            pthread_cond_wait(&gNotifyWorkCond, &gNotifyMtx);
+         }
+         else     // wait until the next window ends
+         {
+            struct timespec until;
+            unsigned long long now = now_ms();
+            unsigned long long wait = (next > now) ? (next - now) : 0;
+
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_sec  += (time_t)(wait / 1000ULL);
+            until.tv_nsec += (long)(wait % 1000ULL) * 1000000L;
+            if(until.tv_nsec >= 1000000000L)
+            {
+               until.tv_sec++;
+               until.tv_nsec -= 1000000000L;
+            }
+            (void)pthread_cond_timedwait(&gNotifyWorkCond, &gNotifyMtx, &until);
+         }
+         next = notify_release_pending(gNotifyQuit != 0 || gNotifyFlush > 0);
+      }
+
+      if(gNotifyCount == 0)
+      {
+         if(gNotifyQuit != 0 && gNotifyNumPending == 0)   // quit and nothing left to send
+         {
+            break;
+         }
+         continue;
+      }
+
+      // deliver all notifications up to the end of the ring at once,
+      // the slots are not reused before they have been delivered
+      num = gNotifyCount;
+      if(gNotifyHead + num > NotifyQueueSize)
+      {
+         num = NotifyQueueSize - gNotifyHead;
+      }
+      index = gNotifyHead;
+      first = &gNotifyQueue[index];
+      batch = (gNotifyBatch != 0 && num > 1) ? 1 : 0;
+      pthread_mutex_unlock(&gNotifyMtx);
+
+      if(batch == 1)    // the mainloop reads the notifications from the queue and sends one signal
+      {
+         MainLoopData_u data;
+
+         memset(&data, 0, sizeof(MainLoopData_u));
+         data.cmd = (uint32_t)CMD_SEND_NOTIFY_BATCH;
+         data.params[0] = index;
+         data.params[1] = num;
+         data.params[2] = (gNotifyBatch == 1) ? 1 : 0;    // per key signals too
+         rval = deliverToMainloop(&data);
+      }
+      else
+      {
+         rval = deliverToMainloopBatch(first, num);
+      }
+
+      if(-1 == rval)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("notifySender - Deliver to mainloop"));
+      }
+
+      pthread_mutex_lock(&gNotifyMtx);
+      gNotifyHead = (gNotifyHead + num) % NotifyQueueSize;
+      gNotifyCount -= num;
+      gNotifyStats.numSent += num;
+      gNotifyStats.numBatchSignals += (unsigned long long)batch;
+      pthread_cond_broadcast(&gNotifyDoneCond);
+   }
+   pthread_mutex_unlock(&gNotifyMtx);
+
+   return NULL;
+}
+
+
+
+/**
+ * @brief start the sender thread if not already running, gNotifyMtx must be locked
+ *
+ * @return 0 on success, -1 if the thread could not be created
+ */
+static int notify_sender_start(void)
+{
+   int rval = 0;
+
+   if(gNotifyRunning == 0)
+   {
+      gNotifyQuit = 0;
+      if(pthread_create(&gNotifyThread, NULL, notify_sender_worker, NULL) == 0)
+      {
+         (void)pthread_setname_np(gNotifyThread, "pclNotify");
+         gNotifyRunning = 1;
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("notifySenderStart - pthread_create failed"));
+         rval = -1;
+      }
+   }
+
+   return rval;
+}
+
+
+
+int notify_queue_push(const MainLoopData_u* data, unsigned int count)
+{
+   int rval = 0;
+   unsigned int i = 0;
+
+   pthread_mutex_lock(&gNotifyMtx);
+
+   rval = notify_sender_start();
+   for(i = 0; i < count && rval == 0; i++)
+   {
+      while(gNotifyCount >= NotifyQueueSize && rval == 0)
+      {
+         if(pthread_equal(pthread_self(), gMainLoopThread))
+         {
+            // called from a notification callback, the mainloop can't wait for itself
+            DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("notifyQueuePush - queue full"));
+            rval = -1;
+         }
+         else
+         {
+            pthread_cond_wait(&gNotifyDoneCond, &gNotifyMtx);
+         }
+      }
+
+      if(rval == 0)
+      {
+         gNotifyStats.numQueued++;
+         if(notify_coalesce(&data[i]) == 0)
+         {
+            notify_enqueue(&data[i]);
+         }
+      }
+   }
+   pthread_cond_signal(&gNotifyWorkCond);
+
+   pthread_mutex_unlock(&gNotifyMtx);
+
+   return rval;
+}
+
+
+
+int pclKeyNotificationFlush(void)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      if(pthread_equal(pthread_self(), gMainLoopThread))
+      {
+         rval = EPERS_COMMON;    // called from a notification callback, the mainloop can't wait for itself
+      }
+      else
+      {
+         pthread_mutex_lock(&gNotifyMtx);
+         gNotifyFlush++;      // the held back notifications are sent without waiting for the end of their window
+         pthread_cond_signal(&gNotifyWorkCond);
+         while(gNotifyCount > 0 || gNotifyNumPending > 0)
+         {
+            pthread_cond_wait(&gNotifyDoneCond, &gNotifyMtx);
+         }
+         gNotifyFlush--;
+         pthread_mutex_unlock(&gNotifyMtx);
+
+         rval = 0;
+      }
+   }
+
+   return rval;
+}
+
+
+
+int pclKeySetNotifyCoalescing(unsigned int ldbid, const char* resource_id, unsigned int windowMs)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      const char* resource = (resource_id != NULL) ? resource_id : "";
+      int i = 0, freeIdx = -1;
+
+      rval = EPERS_COMMON;
+
+      pthread_mutex_lock(&gNotifyMtx);
+      for(i = 0; i < MaxNotifyWindows && rval != 0; i++)
+      {
+         if(   (gNotifyWindow[i].used != 0)
+            && (gNotifyWindow[i].ldbid == ldbid)
+            && (0 == strncmp(gNotifyWindow[i].resource_id, resource, PERS_DB_MAX_LENGTH_KEY_NAME)) )
+         {
+            gNotifyWindow[i].windowMs = windowMs;
+            rval = 0;
+         }
+         else if(gNotifyWindow[i].used == 0 && freeIdx == -1)
+         {
+            freeIdx = i;
+         }
+      }
+
+      if(rval != 0 && freeIdx != -1)
+      {
+         gNotifyWindow[freeIdx].used = 1;
+         gNotifyWindow[freeIdx].ldbid = ldbid;
+         gNotifyWindow[freeIdx].windowMs = windowMs;
+         strncpy(gNotifyWindow[freeIdx].resource_id, resource, PERS_DB_MAX_LENGTH_KEY_NAME-1);
+         gNotifyWindow[freeIdx].resource_id[PERS_DB_MAX_LENGTH_KEY_NAME-1] = '\0';
+         rval = 0;
+      }
+      pthread_mutex_unlock(&gNotifyMtx);
+
+      if(rval != 0)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pclKeySetNotifyCoalescing - too many windows"));
+      }
+   }
+
+   return rval;
+}
+
+
+
+int pclKeyGetNotifyStats(pclKeyNotifyStats_s* stats)
+{
+   int rval = EPERS_NOT_INITIALIZED;
+
+   if(__sync_add_and_fetch(&gPclInitCounter, 0) > 0)
+   {
+      if(stats != NULL)
+      {
+         pthread_mutex_lock(&gNotifyMtx);
+         memcpy(stats, &gNotifyStats, sizeof(pclKeyNotifyStats_s));
+         stats->defaultWindowMs = gNotifyDefaultWindow;
+         stats->queueDepth      = gNotifyCount;
+         stats->numPending      = gNotifyNumPending;
+         pthread_mutex_unlock(&gNotifyMtx);
+         rval = 0;
+      }
+      else
+      {
+         rval = EPERS_COMMON;
+      }
+   }
+
+   return rval;
+}
+
+
+
+const MainLoopData_u* notify_queue_entries(unsigned int index)
+{
+   return &gNotifyQueue[index % NotifyQueueSize];
+}
+
+
+
+void notify_queue_init(void)
+{
+   const char* window = getenv("PERS_CLIENT_LIB_NOTIFY_COALESCE");
+   const char* batch  = getenv("PERS_CLIENT_LIB_NOTIFY_BATCH");
+
+   pthread_mutex_lock(&gNotifyMtx);
+   gNotifyDefaultWindow = (window != NULL) ? (unsigned int)atoi(window) : 0;
+   gNotifyBatch = (batch != NULL) ? atoi(batch) : 0;
+   if(gNotifyBatch < 0 || gNotifyBatch > 2)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("notifyQueueInit - invalid PERS_CLIENT_LIB_NOTIFY_BATCH:"), DLT_INT(gNotifyBatch));
+      gNotifyBatch = 1;
+   }
+   pthread_mutex_unlock(&gNotifyMtx);
+}
+
+
+
+void notify_queue_deinit(void)
+{
+   int running = 0;
+
+   pthread_mutex_lock(&gNotifyMtx);
+   running = gNotifyRunning;
+   gNotifyQuit = 1;
+   pthread_cond_signal(&gNotifyWorkCond);
+   pthread_mutex_unlock(&gNotifyMtx);
+
+   if(running != 0)
+   {
+      pthread_join(gNotifyThread, NULL);   // the sender delivers all queued and held back notifications before it ends
+   }
+
+   pthread_mutex_lock(&gNotifyMtx);
+   gNotifyRunning = 0;
+   gNotifyQuit = 0;
+   gNotifyDefaultWindow = 0;
+   gNotifyBatch = 0;
+   memset(gNotifyWindow, 0, sizeof(gNotifyWindow));
+   memset(gNotifyCoalesce, 0, sizeof(gNotifyCoalesce));
+   memset(&gNotifyStats, 0, sizeof(pclKeyNotifyStats_s));
+   pthread_mutex_unlock(&gNotifyMtx);
+}
@@ -0,0 +1,69 @@
+#ifndef PERSISTENCE_CLIENT_LIBRARY_NOTIFY_QUEUE_H
+#define PERSISTENCE_CLIENT_LIBRARY_NOTIFY_QUEUE_H
+
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_notify_queue.h
+ * @ingroup        Persistence client library
+ * @brief          Header of the change notification queue.
+ *                 Change notifications are queued and handed over to the dbus mainloop
+ *                 by a sender thread, the writer does not wait until the signal has been sent.
+ *                 Repeated changes of a key within its coalescing window are sent as one signal,
+ *                 optionally several queued notifications are sent as one batched signal.
+ * @see
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "persistence_client_library_dbus_service.h"
+
+
+/**
+ * @brief queue change notifications, they are sent in the order they have been queued.
+ *        Blocks only if the queue is full.
+ *
+ * @param data the notifications (CMD_SEND_NOTIFY_SIGNAL messages)
+ * @param count the number of notifications
+ *
+ * @return 0 on success, -1 if the notifications could not be queued
+ */
+int notify_queue_push(const MainLoopData_u* data, unsigned int count);
+
+
+/**
+ * @brief get the queued notifications a batched signal has been requested for (CMD_SEND_NOTIFY_BATCH),
+ *        they stay valid until the mainloop has processed the command
+ *
+ * @param index the queue index of the first notification
+ *
+ * @return the notifications
+ */
+const MainLoopData_u* notify_queue_entries(unsigned int index);
+
+
+/**
+ * @brief read the default coalescing window from the environment variable PERS_CLIENT_LIB_NOTIFY_COALESCE [ms]
+ *        and if several queued notifications are sent as one batched signal (PERS_CLIENT_LIB_NOTIFY_BATCH):
+ *        0 per key signals only (default), 1 batched signal and per key signals, 2 batched signal only
+ */
+void notify_queue_init(void);
+
+
+/**
+ * @brief send all queued and held back change notifications and stop the sender thread
+ *        (must be called before the dbus mainloop is stopped)
+ */
+void notify_queue_deinit(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERSISTENCE_CLIENT_LIBRARY_NOTIFY_QUEUE_H */
@@ -19,15 +19,118 @@
 
 #include "persistence_client_library_prct_access.h"
 #include "persistence_client_library_custom_loader.h"
+#include "persistence_client_library_rct_index.h"
+#include "crc32.h"
+
+#include <persComErrors.h>
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
 #include <dlt.h>
 
 DLT_IMPORT_CONTEXT(gPclDLTContext);
 
 
-/// pointer to resource table database
-static int gResource_table[PrctDbTableSize] = {[0 ... PrctDbTableSize-1] = -1};
-/// array to hold the information of database is already open
-static int gResourceOpen[PrctDbTableSize] = { [0 ... PrctDbTableSize-1] = 0 };
+/// resource configuration table of a combination of table type and group
+typedef struct _PersRctTableEntry_s
+{
+   /// key of the table (see rct_table_key), 0 if the entry is unused; the key of an entry never changes once set
+   unsigned int key;
+   /// the table is open (1), not open (0), currently being opened (2) or being closed (3)
+   int state;
+   /// handle of the table, -1 if not open
+   int handle;
+   /// in-memory index of all resources of the table, NULL if the plugin is asked for every resource
+   PersRctIndex_s* index;
+   /// size of the mapping if the index is a precompiled index file, 0 if the index has been created in memory
+   size_t indexMapSize;
+   /// number of lookups using the handle and the index, the table is not closed while it is > 0
+   int readers;
+} PersRctTableEntry_s;
+
+/// resource configuration tables (open addressing), lookup of already open tables is lock free
+static PersRctTableEntry_s gResourceTable[PrctDbTableSize] = { [0 ... PrctDbTableSize-1] = {0, 0, -1, NULL, 0, 0} };
+/// protects the state of the resource configuration tables and the insertion of new tables
+static pthread_mutex_t gResourceOpenMtx = PTHREAD_MUTEX_INITIALIZER;
+/// signaled when a resource configuration table has been opened (or failed to open) or closed
+static pthread_cond_t gResourceOpenCond = PTHREAD_COND_INITIALIZER;
+/// signaled when the last lookup of a table which is closed has released it
+static pthread_cond_t gResourceIdleCond = PTHREAD_COND_INITIALIZER;
+/// called when a resource configuration table has been loaded
+static pclRctLoadHook_t gRctLoadHook = NULL;
+
+
+/// resolved resource cache entry
+typedef struct _PersResolvedCacheEntry_s
+{
+   /// flag to indicate if the entry is valid
+   int valid;
+   /// the resource has been resolved as file or as key
+   unsigned int isFile;
+   /// the database context (ldbid, user, seat) the resource has been resolved for
+   PersistenceDbContext_s context;
+   /// the resource id
+   char resource_id[PERS_DB_MAX_LENGTH_KEY_NAME];
+   /// the resolved resource configuration
+   PersistenceConfigurationKey_s configKey;
+   /// the resolved database key
+   char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME];
+   /// the resolved database location path
+   char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME];
+} PersResolvedCacheEntry_s;
+
+/// cache of resolved resources (direct mapped), avoids RCT lookup and path/key creation on every access
+static PersResolvedCacheEntry_s gResolvedCache[ResolvedCacheSize];
+/// lookups in the resolved resource cache are shared, updates are exclusive
+static pthread_rwlock_t gResolvedCacheLock = PTHREAD_RWLOCK_INITIALIZER;
+/// generation of the resolved resources, incremented with gResolvedCacheLock held when they become invalid (RCT closed on shutdown or deinit)
+static unsigned int gResolvedGeneration = 1;
+/// resources resolved by this thread (direct mapped), checked before the shared resolved resource cache
+static __thread PersResolvedCacheEntry_s gTlsResolved[TlsResolvedCacheSize];
+/// generation of the resolved resources the thread local entries have been created in, 0 if unused
+static __thread unsigned int gTlsResolvedGeneration[TlsResolvedCacheSize];
+
+
+/// resource not found in the resource configuration table
+typedef struct _PersNegativeCacheEntry_s
+{
+   /// flag to indicate if the entry is valid
+   int valid;
+   /// the logical database id (identifies the resource configuration table)
+   unsigned int ldbid;
+   /// the resource id
+   char resource_id[PERS_DB_MAX_LENGTH_KEY_NAME];
+   /// the default configuration created for a local resource
+   PersistenceConfigurationKey_s configKey;
+} PersNegativeCacheEntry_s;
+
+/// cache of resources missing in the resource configuration table (direct mapped)
+static PersNegativeCacheEntry_s gNegativeCache[NegativeCacheSize];
+/// lookups in the negative cache are shared, updates are exclusive
+static pthread_rwlock_t gNegativeCacheLock = PTHREAD_RWLOCK_INITIALIZER;
+
+/// precompiled database path of a logical database and policy
+typedef struct _PersPathTemplate_s
+{
+   /// generation of the templates the path has been created for, 0 if not created yet
+   unsigned int generation;
+   /// length of the path
+   unsigned int length;
+   /// the database path, the key is appended for files
+   char path[PERS_ORG_MAX_LENGTH_PATH_FILENAME];
+} PersPathTemplate_s;
+
+/// path templates for shared ldbids (< 0x80) and all local ldbids (last row), for the policies wc and wt
+static PersPathTemplate_s gPathTemplate[0x80 + 1][2];
+/// current generation of the path templates, incremented when the application id changes
+static unsigned int gPathTemplateGeneration = 1;
+/// the path templates are copied shared, created exclusive
+static pthread_rwlock_t gPathTemplateLock = PTHREAD_RWLOCK_INITIALIZER;
+
+/// time the last resource configuration table miss has been logged [s, monotonic]
+static long gRctMissLogTime = 0;
+/// number of resource configuration table misses not logged since then
+static unsigned int gRctMissSuppressed = 0;
 
 
 /// persistence resource config table type definition
@@ -75,13 +178,60 @@ PersistenceRCT_e get_table_id(unsigned int ldbid, int* groupId)
 }
 
 
+/**
+ * @brief create the key of a resource configuration table, unique for every combination of table type and group
+ */
+static unsigned int rct_table_key(PersistenceRCT_e rct, int group)
+{
+   return (unsigned int)group * (unsigned int)PersistenceRCT_LastEntry + (unsigned int)rct + 1;
+}
+
+
+
+/**
+ * @brief find the entry of a resource configuration table
+ *
+ * @param key the key of the table
+ * @param insert 1 to use a free entry if the table has not been found (gResourceOpenMtx must be locked), 0 to search only
+ *
+ * @return the entry or NULL if not found (or no free entry is left)
+ */
+static PersRctTableEntry_s* rct_table_find(unsigned int key, int insert)
+{
+   unsigned int hash = key * 2654435769u;     // odd multiplier, consecutive keys get different slots
+   unsigned int i = 0;
+
+   for(i = 0; i < PrctDbTableSize; i++)
+   {
+      PersRctTableEntry_s* entry = &gResourceTable[(hash + i) & (PrctDbTableSize - 1)];
+      unsigned int entryKey = __sync_add_and_fetch(&entry->key, 0);
+
+      if(entryKey == key)
+      {
+         return entry;
+      }
+      else if(entryKey == 0)
+      {
+         if(insert == 1 && __sync_bool_compare_and_swap(&entry->key, 0, key))
+         {
+            return entry;
+         }
+         return NULL;
+      }
+   }
+
+   return NULL;
+}
+
+
+
 int get_resource_cfg_table_by_idx(int i)
 {
    int idx = -1;
 
    if(i >= 0 && i < PrctDbTableSize)
    {
-      idx = gResource_table[i];
+      idx = gResourceTable[i].handle;
    }
    return idx;
 }
@@ -91,23 +241,107 @@ void invalidate_resource_cfg_table(int i)
 {
    if(i >= 0 && i < PrctDbTableSize)
    {
-      gResource_table[i] = -1;
-      gResourceOpen[i] = 0;
+      PersRctTableEntry_s* entry = &gResourceTable[i];
+
+      if(pthread_mutex_lock(&gResourceOpenMtx) != 0)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("gRCT - mutex lock failed"));
+         return;
+      }
+
+      while(entry->state == 2 || entry->state == 3)     // opened or closed by another thread, wait for it
+      {
+         pthread_cond_wait(&gResourceOpenCond, &gResourceOpenMtx);
+      }
+
+      if(entry->state == 1)
+      {
+         struct timespec until;
+         int rc = 0;
+
+         entry->state = 3;          // new lookups take the slow path and wait until the table is closed
+         __sync_synchronize();      // mark the table as closed before checking the readers
+
+         clock_gettime(CLOCK_REALTIME, &until);
+         until.tv_sec  += DbCloseWaitMs / 1000;
+         until.tv_nsec += (long)(DbCloseWaitMs % 1000) * 1000000L;
+         if(until.tv_nsec >= 1000000000L)
+         {
+            until.tv_sec++;
+            until.tv_nsec -= 1000000000L;
+         }
+
+         // lookups already using the handle or the index finish without the lock, the last one signals it
+         while(__sync_add_and_fetch(&entry->readers, 0) > 0 && rc != ETIMEDOUT)
+         {
+            rc = pthread_cond_timedwait(&gResourceIdleCond, &gResourceOpenMtx, &until);
+         }
+
+         if(__sync_add_and_fetch(&entry->readers, 0) == 0)
+         {
+            if(*plugin_persComRctClose != NULL && plugin_persComRctClose(entry->handle) != 0)
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("gRCT - close failed => index:"), DLT_INT(i));
+            }
+            rct_index_release(entry->index, entry->indexMapSize);
+
+            entry->handle = -1;
+            entry->index = NULL;
+            entry->indexMapSize = 0;
+            entry->state = 0;
+         }
+         else
+         {
+            // the handle and the index stay referenced by the table, a later invalidation releases them
+            DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("gRCT - still in use, not closed => index:"), DLT_INT(i));
+            __sync_synchronize();
+            entry->state = 1;
+         }
+         pthread_cond_broadcast(&gResourceOpenCond);
+      }
+
+      pthread_mutex_unlock(&gResourceOpenMtx);
    }
 }
 
 
 int get_resource_cfg_table(PersistenceRCT_e rct, int group)
 {
-   unsigned int arrayIdx = 0;
+   PersRctTableEntry_s* entry = NULL;
+   unsigned int key = 0;
    int rval = EPERS_NOPRCTABLE;
 
-   // create array index: index is a combination of resource config table type and group
-   arrayIdx = (rct + (unsigned int)group);
-
-   if(arrayIdx < PrctDbTableSize)
+   if(rct < PersistenceRCT_LastEntry && group >= 0)
    {
-      if(gResourceOpen[arrayIdx] == 0)   // check if database is already open
+      // the key is a combination of resource config table type and group
+      key = rct_table_key(rct, group);
+
+      entry = rct_table_find(key, 0);
+      if(entry != NULL && __sync_add_and_fetch(&entry->state, 0) == 1)
+      {
+         return entry->handle;   // fast path, table already open
+      }
+
+      if(pthread_mutex_lock(&gResourceOpenMtx) != 0)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("gRCT - mutex lock failed"));
+         return EPERS_COMMON;
+      }
+
+      entry = rct_table_find(key, 1);
+      if(entry == NULL)
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("gRCT - no free table entry, group:"), DLT_INT(group));
+         pthread_mutex_unlock(&gResourceOpenMtx);
+         return EPERS_NOPRCTABLE;
+      }
+
+      while(entry->state == 2 || entry->state == 3)     // opened or closed by another thread, wait for it
+      {
+         pthread_cond_wait(&gResourceOpenCond, &gResourceOpenMtx);
+      }
+
+      if(entry->state == 0)   // check if database is already open
       {
          char filename[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = { [0 ... PERS_ORG_MAX_LENGTH_PATH_FILENAME-1] = 0};
 
@@ -129,16 +363,60 @@ int get_resource_cfg_table(PersistenceRCT_e rct, int group)
 
          if(*plugin_persComRctOpen != NULL)
          {
-            gResource_table[arrayIdx] = plugin_persComRctOpen(filename, 0x04);   // 0x04 ==> open in read only mode
+            int handleRCT = -1;
+            PersRctIndex_s* index = NULL;
+            size_t mapSize = 0;
+            pclRctLoadInfo_s loadInfo;
+            struct timespec start, end;
+
+            // open without holding the lock, other tables can be opened in the meantime
+            entry->state = 2;
+            pthread_mutex_unlock(&gResourceOpenMtx);
 
-            if(gResource_table[arrayIdx] < 0)
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            handleRCT = plugin_persComRctOpen(filename, 0x04);   // 0x04 ==> open in read only mode
+            if(handleRCT >= 0)
             {
-               gResourceOpen[arrayIdx] = 0;
-               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("gRCT - RCT problem"), DLT_INT(gResource_table[arrayIdx] ));
+               index = rct_index_map(filename, &mapSize);   // precompiled index shared with other processes
+               if(index == NULL)
+               {
+                  index = rct_index_load(handleRCT);    // resolve all resources without plugin calls
+               }
+               clock_gettime(CLOCK_MONOTONIC, &end);
+
+               loadInfo.ldbid        = (rct == PersistenceRCT_local) ? PCL_LDBID_LOCAL : (unsigned int)group;
+               loadInfo.numResources = (index != NULL) ? index->numEntries : 0;
+               loadInfo.memSize      = (index != NULL) ? index->size : 0;
+               loadInfo.mapped       = (mapSize > 0) ? 1 : 0;
+               loadInfo.loadTimeUs   = (unsigned long long)((end.tv_sec - start.tv_sec) * 1000000LL + (end.tv_nsec - start.tv_nsec) / 1000);
+
+               DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("gRCT - loaded:"), DLT_STRING(filename),
+                                                     DLT_STRING("resources:"), DLT_UINT(loadInfo.numResources),
+                                                     DLT_STRING("bytes:"), DLT_UINT(loadInfo.memSize),
+                                                     DLT_STRING("mapped:"), DLT_UINT(loadInfo.mapped),
+                                                     DLT_STRING("us:"), DLT_UINT64(loadInfo.loadTimeUs));
+               if(gRctLoadHook != NULL)
+               {
+                  gRctLoadHook(&loadInfo);
+               }
+            }
+
+            pthread_mutex_lock(&gResourceOpenMtx);
+
+            entry->handle = handleRCT;
+            entry->index = index;
+            entry->indexMapSize = mapSize;
+            pthread_cond_broadcast(&gResourceOpenCond);
+
+            if(entry->handle < 0)
+            {
+               entry->state = 0;
+               DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("gRCT - RCT problem"), DLT_INT(entry->handle));
             }
             else
             {
-                gResourceOpen[arrayIdx] = 1 ;
+                __sync_synchronize();      // publish the handle before marking the table as open
+                entry->state = 1;
             }
          }
          else
@@ -148,7 +426,9 @@ int get_resource_cfg_table(PersistenceRCT_e rct, int group)
          }
       }
 
-      rval = gResource_table[arrayIdx];
+      rval = entry->handle;
+
+      pthread_mutex_unlock(&gResourceOpenMtx);
    }
 
    return rval;
@@ -156,23 +436,359 @@ int get_resource_cfg_table(PersistenceRCT_e rct, int group)
 
 
 
+/**
+ * @brief release a resource configuration table acquired with rct_table_acquire
+ */
+static void rct_table_release(PersRctTableEntry_s* entry)
+{
+   if(entry != NULL)
+   {
+      if(__sync_sub_and_fetch(&entry->readers, 1) == 0 && __sync_add_and_fetch(&entry->state, 0) == 3)
+      {
+         // the table is waited for to be closed; signaled with the lock held, the wakeup can't get lost
+         pthread_mutex_lock(&gResourceOpenMtx);
+         pthread_cond_broadcast(&gResourceIdleCond);
+         pthread_mutex_unlock(&gResourceOpenMtx);
+      }
+   }
+}
+
+
+
+/**
+ * @brief open a resource configuration table and keep it open while it is used
+ *
+ * @param handle the handle of the table or a negative error will be stored here
+ *
+ * @return the entry of the table, must be released with rct_table_release; NULL if the table could not be opened
+ */
+static PersRctTableEntry_s* rct_table_acquire(PersistenceRCT_e rct, int group, int* handle)
+{
+   int tries = 0;
+
+   for(tries = 0; tries < 3; tries++)
+   {
+      PersRctTableEntry_s* entry = NULL;
+
+      *handle = get_resource_cfg_table(rct, group);
+      if(*handle < 0)
+      {
+         return NULL;
+      }
+
+      entry = rct_table_find(rct_table_key(rct, group), 0);
+      if(entry != NULL)
+      {
+         (void)__sync_add_and_fetch(&entry->readers, 1);
+         if(__sync_add_and_fetch(&entry->state, 0) == 1)
+         {
+            *handle = entry->handle;    // the table is not closed until the entry is released
+            return entry;
+         }
+         rct_table_release(entry);    // closed in the meantime, open it again
+      }
+   }
+
+   *handle = EPERS_NOPRCTABLE;
+   return NULL;
+}
+
+
+
+int open_resource_cfg_table(unsigned int ldbid)
+{
+   int groupId = 0;
+   PersistenceRCT_e rct = get_table_id(ldbid, &groupId);
+
+   return (rct < PersistenceRCT_LastEntry) ? get_resource_cfg_table(rct, groupId) : EPERS_NOPRCTABLE;
+}
+
+
+
+static unsigned int get_resolved_cache_hash(const PersistenceDbContext_s* context, const char* resource_id, unsigned int isFile)
+{
+   unsigned int hash = pclCrc32(0, (const unsigned char*)resource_id, strlen(resource_id));
+
+   hash = pclCrc32(hash, (const unsigned char*)context, sizeof(PersistenceDbContext_s));
+
+   return hash + isFile;
+}
+
+
+
+/**
+ * @brief copy a resolved resource if the entry belongs to the resource
+ *
+ * @return 1 if the entry belongs to the resource; 0 if not
+ */
+static int resolved_entry_get(const PersResolvedCacheEntry_s* entry, PersistenceInfo_s* dbContext, const char* resource_id, unsigned int isFile,
+                              char dbKey[], char dbPath[])
+{
+   if(   (entry->valid == 1)
+      && (entry->isFile == isFile)
+      && (entry->context.ldbid   == dbContext->context.ldbid)
+      && (entry->context.user_no == dbContext->context.user_no)
+      && (entry->context.seat_no == dbContext->context.seat_no)
+      && (0 == strncmp(entry->resource_id, resource_id, PERS_DB_MAX_LENGTH_KEY_NAME)) )
+   {
+      memcpy(&dbContext->configKey, &entry->configKey, sizeof(dbContext->configKey));
+      strncpy(dbKey,  entry->dbKey,  PERS_DB_MAX_LENGTH_KEY_NAME);
+      strncpy(dbPath, entry->dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME);
+      return 1;
+   }
+
+   return 0;
+}
+
+
+
+static void resolved_entry_set(PersResolvedCacheEntry_s* entry, const PersistenceInfo_s* dbContext, const char* resource_id, unsigned int isFile,
+                               const char dbKey[], const char dbPath[])
+{
+   entry->isFile  = isFile;
+   entry->context = dbContext->context;
+   memcpy(&entry->configKey, &dbContext->configKey, sizeof(entry->configKey));
+   strncpy(entry->resource_id, resource_id, PERS_DB_MAX_LENGTH_KEY_NAME);
+   strncpy(entry->dbKey,  dbKey,  PERS_DB_MAX_LENGTH_KEY_NAME);
+   strncpy(entry->dbPath, dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME);
+   entry->dbKey[PERS_DB_MAX_LENGTH_KEY_NAME-1]        = '\0'; // Ensures 0-Termination
+   entry->dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME-1] = '\0'; // Ensures 0-Termination
+   entry->valid = 1;
+}
+
+
+
+static int get_resolved_cache_entry(unsigned int hash, PersistenceInfo_s* dbContext, const char* resource_id, unsigned int isFile, char dbKey[], char dbPath[])
+{
+   int found = 0;
+
+   if(pthread_rwlock_rdlock(&gResolvedCacheLock) == 0)
+   {
+      found = resolved_entry_get(&gResolvedCache[hash & (ResolvedCacheSize-1)], dbContext, resource_id, isFile, dbKey, dbPath);
+      pthread_rwlock_unlock(&gResolvedCacheLock);
+   }
+
+   return found;
+}
+
+
+
+/**
+ * @brief store a resolved resource in the shared cache
+ *
+ * @param generation the generation of the resolved resources the resolution has been started in,
+ *        the resource is not stored if the cache has been invalidated in the meantime
+ */
+static void set_resolved_cache_entry(unsigned int hash, unsigned int generation, const PersistenceInfo_s* dbContext, const char* resource_id, unsigned int isFile,
+                                     const char dbKey[], const char dbPath[])
+{
+   if(strlen(resource_id) < PERS_DB_MAX_LENGTH_KEY_NAME)    // resource id's not fitting into the entry are not cached
+   {
+      if(pthread_rwlock_wrlock(&gResolvedCacheLock) == 0)
+      {
+         if(gResolvedGeneration == generation)    // changed only with the lock held
+         {
+            // replace whatever is stored in this slot
+            resolved_entry_set(&gResolvedCache[hash & (ResolvedCacheSize-1)], dbContext, resource_id, isFile, dbKey, dbPath);
+         }
+         pthread_rwlock_unlock(&gResolvedCacheLock);
+      }
+   }
+}
+
+
+
+static int get_tls_resolved_entry(unsigned int hash, unsigned int generation, PersistenceInfo_s* dbContext, const char* resource_id, unsigned int isFile,
+                                  char dbKey[], char dbPath[])
+{
+   unsigned int idx = hash & (TlsResolvedCacheSize-1);
+
+   return (gTlsResolvedGeneration[idx] == generation) ? resolved_entry_get(&gTlsResolved[idx], dbContext, resource_id, isFile, dbKey, dbPath) : 0;
+}
+
+
+
+static void set_tls_resolved_entry(unsigned int hash, unsigned int generation, const PersistenceInfo_s* dbContext, const char* resource_id, unsigned int isFile,
+                                   const char dbKey[], const char dbPath[])
+{
+   if(strlen(resource_id) < PERS_DB_MAX_LENGTH_KEY_NAME)    // resource id's not fitting into the entry are not cached
+   {
+      unsigned int idx = hash & (TlsResolvedCacheSize-1);
+
+      resolved_entry_set(&gTlsResolved[idx], dbContext, resource_id, isFile, dbKey, dbPath);
+      gTlsResolvedGeneration[idx] = generation;
+   }
+}
+
+
+
+void invalidate_resolved_cache(void)
+{
+   int i = 0;
+
+   if(pthread_rwlock_wrlock(&gResolvedCacheLock) == 0)
+   {
+      // resolutions started before are not stored anymore, invalidates the thread local entries of all threads
+      (void)__sync_add_and_fetch(&gResolvedGeneration, 1);
+      for(i=0; i<ResolvedCacheSize; i++)
+      {
+         gResolvedCache[i].valid = 0;
+      }
+      pthread_rwlock_unlock(&gResolvedCacheLock);
+   }
+
+   if(pthread_rwlock_wrlock(&gNegativeCacheLock) == 0)
+   {
+      for(i=0; i<NegativeCacheSize; i++)
+      {
+         gNegativeCache[i].valid = 0;
+      }
+      pthread_rwlock_unlock(&gNegativeCacheLock);
+   }
+}
+
+
+
+static unsigned int get_negative_cache_idx(unsigned int ldbid, const char* resource_id)
+{
+   return pclCrc32(ldbid, (const unsigned char*)resource_id, strlen(resource_id)) & (NegativeCacheSize-1);
+}
+
+
+
+/**
+ * @brief check if a resource is known to be missing in the resource configuration table
+ *
+ * @param ldbid the logical database id
+ * @param resource_id the resource id
+ * @param configKey the default configuration of a local resource will be stored here
+ *
+ * @return 1 if the resource is known to be missing; 0 if not
+ */
+static int get_negative_cache_entry(unsigned int ldbid, const char* resource_id, PersistenceConfigurationKey_s* configKey)
+{
+   int found = 0;
+   unsigned int idx = get_negative_cache_idx(ldbid, resource_id);
+
+   if(pthread_rwlock_rdlock(&gNegativeCacheLock) == 0)
+   {
+      PersNegativeCacheEntry_s* entry = &gNegativeCache[idx];
+
+      if(   (entry->valid == 1)
+         && (entry->ldbid == ldbid)
+         && (0 == strncmp(entry->resource_id, resource_id, PERS_DB_MAX_LENGTH_KEY_NAME)) )
+      {
+         memcpy(configKey, &entry->configKey, sizeof(PersistenceConfigurationKey_s));
+         found = 1;
+      }
+      pthread_rwlock_unlock(&gNegativeCacheLock);
+   }
+
+   return found;
+}
+
+
+
+static void set_negative_cache_entry(unsigned int generation, unsigned int ldbid, const char* resource_id, const PersistenceConfigurationKey_s* configKey)
+{
+   if(strlen(resource_id) < PERS_DB_MAX_LENGTH_KEY_NAME)    // resource id's not fitting into the entry are not cached
+   {
+      unsigned int idx = get_negative_cache_idx(ldbid, resource_id);
+
+      if(pthread_rwlock_wrlock(&gNegativeCacheLock) == 0)
+      {
+         PersNegativeCacheEntry_s* entry = &gNegativeCache[idx];    // replace whatever is stored in this slot
+
+         // a miss found before the tables have been invalidated is not stored, the generation is incremented before the cache is cleared
+         if(__sync_add_and_fetch(&gResolvedGeneration, 0) == generation)
+         {
+            entry->ldbid = ldbid;
+            strncpy(entry->resource_id, resource_id, PERS_DB_MAX_LENGTH_KEY_NAME);
+            memcpy(&entry->configKey, configKey, sizeof(PersistenceConfigurationKey_s));
+            entry->valid = 1;
+         }
+
+         pthread_rwlock_unlock(&gNegativeCacheLock);
+      }
+   }
+}
+
+
+
+/**
+ * @brief rate limit the log of resource configuration table misses
+ *
+ * @param suppressed the number of misses not logged since the last logged miss will be stored here
+ *
+ * @return 1 if the miss should be logged; 0 if not
+ */
+static int rct_miss_log_allowed(unsigned int* suppressed)
+{
+   struct timespec now;
+   long last = __sync_add_and_fetch(&gRctMissLogTime, 0);
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   if(   (last == 0 || now.tv_sec - last >= RctMissLogInterval)
+      && __sync_bool_compare_and_swap(&gRctMissLogTime, last, (long)now.tv_sec) )
+   {
+      *suppressed = __sync_fetch_and_and(&gRctMissSuppressed, 0);
+      return 1;
+   }
+
+   (void)__sync_add_and_fetch(&gRctMissSuppressed, 1);
+   return 0;
+}
+
+
+
 int get_db_context(PersistenceInfo_s* dbContext, const char* resource_id, unsigned int isFile, char dbKey[], char dbPath[])
 {
-   int rval = 0, resourceFound = 0, groupId = 0, handleRCT = 0;
+   int rval = 0, resourceFound = 0, groupId = 0, handleRCT = 0, knownMiss = 0, cacheMiss = 0;
    PersistenceRCT_e rct = PersistenceRCT_LastEntry;
+   PersRctTableEntry_s* rctEntry = NULL;
+   PersistenceConfigurationKey_s defaultKey;
+   unsigned int hash = get_resolved_cache_hash(&dbContext->context, resource_id, isFile);
+   unsigned int generation = __sync_add_and_fetch(&gResolvedGeneration, 0);   // before resolving, a concurrent invalidation wins
+
+   if(get_tls_resolved_entry(hash, generation, dbContext, resource_id, isFile, dbKey, dbPath) == 1)
+   {
+      return 0;   // resolved by this thread before
+   }
+
+   if(get_resolved_cache_entry(hash, dbContext, resource_id, isFile, dbKey, dbPath) == 1)
+   {
+      set_tls_resolved_entry(hash, generation, dbContext, resource_id, isFile, dbKey, dbPath);
+      return 0;   // already resolved
+   }
 
    rct = get_table_id(dbContext->context.ldbid, &groupId);
 
-   handleRCT = get_resource_cfg_table(rct, groupId);    // get resource configuration table
+   rctEntry = rct_table_acquire(rct, groupId, &handleRCT);    // get resource configuration table
 
    if(handleRCT >= 0)
    {
-      if(*plugin_persComRctRead != NULL)
+      const PersRctIndex_s* index = rctEntry->index;
+
+      if(index != NULL || *plugin_persComRctRead != NULL)
       {
          PersistenceConfigurationKey_s sRctEntry ;
+         int iErrCode = 0;
 
          // check if resouce id is in write through table
-         int iErrCode = plugin_persComRctRead(handleRCT, resource_id, &sRctEntry) ;
+         if(get_negative_cache_entry(dbContext->context.ldbid, resource_id, &defaultKey) == 1)
+         {
+            iErrCode = EPERS_NOKEYDATA;      // known to be missing, no lookup
+            knownMiss = 1;
+         }
+         else if(index != NULL)
+         {
+            iErrCode = (rct_index_lookup(index, resource_id, &sRctEntry) == 1) ? (int)sizeof(PersistenceConfigurationKey_s) : EPERS_NOKEYDATA;
+         }
+         else
+         {
+            iErrCode = plugin_persComRctRead(handleRCT, resource_id, &sRctEntry) ;
+         }
 
          if(sizeof(PersistenceConfigurationKey_s) == iErrCode)
          {
@@ -192,7 +808,15 @@ int get_db_context(PersistenceInfo_s* dbContext, const char* resource_id, unsign
          }
          else
          {
-            DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("gDBCtx - RCT: no value for key:"), DLT_STRING(resource_id) );
+            unsigned int suppressed = 0;
+
+            if(rct_miss_log_allowed(&suppressed) == 1)
+            {
+               DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("gDBCtx - RCT: no value for key:"), DLT_STRING(resource_id),
+                                                     DLT_STRING("misses not logged:"), DLT_UINT(suppressed) );
+            }
+            // only a definite miss is remembered, not a failing plugin
+            cacheMiss = (knownMiss == 0 && (index != NULL || iErrCode == PERS_COM_ERR_NOT_FOUND)) ? 1 : 0;
             rval = EPERS_NOKEYDATA;
          }
       }
@@ -201,6 +825,7 @@ int get_db_context(PersistenceInfo_s* dbContext, const char* resource_id, unsign
          DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("gDBCtx - no plugin function available"));
          rval = EPERS_NO_PLUGIN_FUNCT;
       }
+      rct_table_release(rctEntry);
    }  // resource table
    else
    {
@@ -210,11 +835,23 @@ int get_db_context(PersistenceInfo_s* dbContext, const char* resource_id, unsign
 
    if((resourceFound == 0) && (dbContext->context.ldbid == PCL_LDBID_LOCAL) ) // create only when the resource is local data
    {
-      // resource NOT found in resource table ==> default is local cached key
-      dbContext->configKey.policy      = PersistencePolicy_wc;
-      dbContext->configKey.storage     = PersistenceStorage_local;
-      dbContext->configKey.permission  = PersistencePermission_ReadWrite;
-      dbContext->configKey.max_size    = PERS_DB_MAX_SIZE_KEY_DATA;
+      if(knownMiss == 0)
+      {
+         // resource NOT found in resource table ==> default is local cached key
+         memset(&defaultKey, 0, sizeof(PersistenceConfigurationKey_s));
+         defaultKey.policy      = PersistencePolicy_wc;
+         defaultKey.storage     = PersistenceStorage_local;
+         defaultKey.permission  = PersistencePermission_ReadWrite;
+         defaultKey.max_size    = PERS_DB_MAX_SIZE_KEY_DATA;
+
+         strncpy(defaultKey.customID,    "A_CUSTOM_ID", strlen("A_CUSTOM_ID "));
+         strncpy(defaultKey.reponsible,  "default",     strlen("default"));
+         strncpy(defaultKey.custom_name, "default",     strlen("default"));
+
+         DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("gDBCtx - create res not in PRCT => key:"), DLT_STRING(resource_id) );
+      }
+
+      memcpy(&dbContext->configKey, &defaultKey, sizeof(dbContext->configKey));
       if(isFile == PersistenceResourceType_file)
       {
          dbContext->configKey.type = PersistenceResourceType_file;
@@ -224,14 +861,18 @@ int get_db_context(PersistenceInfo_s* dbContext, const char* resource_id, unsign
          dbContext->configKey.type  = PersistenceResourceType_key;
       }
 
-      strncpy(dbContext->configKey.customID,    "A_CUSTOM_ID", strlen("A_CUSTOM_ID "));
-      strncpy(dbContext->configKey.reponsible,  "default",     strlen("default"));
-      strncpy(dbContext->configKey.custom_name, "default",     strlen("default"));
-
-      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("gDBCtx - create res not in PRCT => key:"), DLT_STRING(resource_id) );
-
       rval = get_db_path_and_key(dbContext, resource_id, dbKey, dbPath);
    }
+   else if(cacheMiss == 1)
+   {
+      memset(&defaultKey, 0, sizeof(PersistenceConfigurationKey_s));     // no default for shared resources
+   }
+
+   if(cacheMiss == 1)
+   {
+      set_negative_cache_entry(generation, dbContext->context.ldbid, resource_id, &defaultKey);
+   }
+
    /* rval contains the return value of function get_db_path_and_key() if positive structure content 'dbContext' is valid.
     * rval can be 0,1 or 2 but get_db_context should only return '0' for success. */
    if (0 < rval)
@@ -239,129 +880,239 @@ int get_db_context(PersistenceInfo_s* dbContext, const char* resource_id, unsign
 	   rval = 0;
    }
 
+   if((rval == 0) && (handleRCT >= 0))   // only remember resources resolved against an open RCT
+   {
+      set_resolved_cache_entry(hash, generation, dbContext, resource_id, isFile, dbKey, dbPath);
+      set_tls_resolved_entry(hash, generation, dbContext, resource_id, isFile, dbKey, dbPath);
+   }
+
    return rval;
 }
 
 
 
-int get_db_path_and_key(PersistenceInfo_s* dbContext, const char* resource_id, char dbKey[], char dbPath[])
+void invalidate_path_templates(void)
 {
-   int storePolicy = PersistenceStorage_LastEntry;
+   (void)__sync_add_and_fetch(&gPathTemplateGeneration, 1);
+}
 
-   // create resource database key
-   if(((dbContext->context.ldbid < 0x80) || (dbContext->context.ldbid == PCL_LDBID_LOCAL)) &&  (NULL != dbKey))
+
+
+/// output of the key and path creation, truncated like snprintf
+typedef struct _PersStrBuf_s
+{
+   /// the buffer
+   char* buf;
+   /// number of characters written
+   size_t len;
+   /// max number of characters (size of the buffer - 1)
+   size_t max;
+} PersStrBuf_s;
+
+
+static void strbuf_init(PersStrBuf_s* sb, char* buf, size_t size)
+{
+   sb->buf = buf;
+   sb->len = 0;
+   sb->max = size - 1;
+}
+
+
+static void strbuf_append(PersStrBuf_s* sb, const char* str, size_t len)
+{
+   if(len > sb->max - sb->len)
    {
-      // The LDBID is used to find the DBID in the resource table.
-      if((dbContext->context.user_no == 0) && (dbContext->context.seat_no == 0))
+      len = sb->max - sb->len;
+   }
+   memcpy(sb->buf + sb->len, str, len);
+   sb->len += len;
+}
+
+
+static void strbuf_append_str(PersStrBuf_s* sb, const char* str)
+{
+   if(str == NULL)
+   {
+      str = "(null)";      // same output as snprintf
+   }
+   strbuf_append(sb, str, strlen(str));
+}
+
+
+static void strbuf_append_uint(PersStrBuf_s* sb, unsigned int value, unsigned int base)
+{
+   char digits[16];
+   size_t n = sizeof(digits);
+
+   do
+   {
+      digits[--n] = "0123456789abcdef"[value % base];
+      value /= base;
+   } while(value != 0);
+
+   strbuf_append(sb, &digits[n], sizeof(digits) - n);
+}
+
+
+static void strbuf_finish(PersStrBuf_s* sb)
+{
+   sb->buf[sb->len] = '\0';
+}
+
+
+
+/**
+ * @brief append the path template of a logical database and policy, the template is created on first use
+ *
+ * @param policy the policy, must be PersistencePolicy_wc or PersistencePolicy_wt
+ */
+static void path_template_append(PersStrBuf_s* sb, unsigned int ldbid, PersistencePolicy_e policy)
+{
+   unsigned int generation = __sync_add_and_fetch(&gPathTemplateGeneration, 0);
+   PersPathTemplate_s* tmpl = &gPathTemplate[(ldbid < 0x80) ? ldbid : 0x80][(policy == PersistencePolicy_wc) ? 0 : 1];
+
+   if(pthread_rwlock_rdlock(&gPathTemplateLock) != 0)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pathTmpl - lock failed"));
+      return;
+   }
+
+   if(tmpl->generation != generation)
+   {
+      pthread_rwlock_unlock(&gPathTemplateLock);
+      if(pthread_rwlock_wrlock(&gPathTemplateLock) != 0)
       {
-         // Node is added in front of the resource ID as the key string.
-         snprintf(dbKey, PERS_DB_MAX_LENGTH_KEY_NAME, "%s/%s", plugin_gNode, resource_id);
+         DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("pathTmpl - lock failed"));
+         return;
       }
-      else
+
+      if(tmpl->generation != generation)     // not created by another thread in the meantime
       {
-         // Node is added in front of the resource ID as the key string.
-         if(dbContext->context.seat_no == 0)
+         int len = 0;
+
+         if(ldbid >= 0x80)
          {
-            // /User/<user_no_parameter> is added in front of the resource ID as the key string.
-            snprintf(dbKey, PERS_DB_MAX_LENGTH_KEY_NAME, "%s%u/%s", plugin_gUser, dbContext->context.user_no, resource_id);
+            // L O C A L   database
+            len = snprintf(tmpl->path, PERS_ORG_MAX_LENGTH_PATH_FILENAME,
+                           (policy == PersistencePolicy_wc) ? getLocalCachePath() : getLocalWtPath(), gAppId, "");
+         }
+         else if(ldbid != PCL_LDBID_PUBLIC)
+         {
+            // shared  G R O U P  database
+            len = snprintf(tmpl->path, PERS_ORG_MAX_LENGTH_PATH_FILENAME,
+                           (policy == PersistencePolicy_wc) ? getSharedCachePath() : getSharedWtPath(), gAppId, ldbid, "");
          }
          else
          {
-            // /User/<user_no_parameter>/Seat/<seat_no_parameter> is added in front of the resource ID as the key string.
-            snprintf(dbKey, PERS_DB_MAX_LENGTH_KEY_NAME, "%s%u%s%u/%s", plugin_gUser, dbContext->context.user_no, plugin_gSeat, dbContext->context.seat_no, resource_id);
+            // shared  P U B L I C  database
+            len = snprintf(tmpl->path, PERS_ORG_MAX_LENGTH_PATH_FILENAME,
+                           (policy == PersistencePolicy_wc) ? getSharedPublicCachePath() : getSharedPublicWtPath(), gAppId, "");
          }
-      }
-      storePolicy = PersistenceStorage_local;
-   }
 
-   if((dbContext->context.ldbid >= 0x80) && (dbContext->context.ldbid != PCL_LDBID_LOCAL) && (NULL != dbKey))
-   {
-      // The LDBID is used to find the DBID in the resource table.
-      // /<LDBID parameter> is added in front of the resource ID as the key string.
-      //  Rational: Creates a namespace within one data base.
-      //  Rational: Reduction of number of databases -> reduction of maintenance costs
-      // /User/<user_no_parameter> and /Seat/<seat_no_parameter> are add after /<LDBID parameter> if there are different than 0.
-      if(dbContext->context.seat_no != 0)
-      {
-         snprintf(dbKey, PERS_DB_MAX_LENGTH_KEY_NAME, "/%x%s%u%s%u/%s", dbContext->context.ldbid, plugin_gUser, dbContext->context.user_no, plugin_gSeat, dbContext->context.seat_no, resource_id);
-      }
-      else
-      {
-         snprintf(dbKey, PERS_DB_MAX_LENGTH_KEY_NAME, "/%x%s%u/%s", dbContext->context.ldbid, plugin_gUser, dbContext->context.user_no, resource_id);
+         tmpl->length = (len < 0) ? 0 : (unsigned int)len;
+         if(tmpl->length > PERS_ORG_MAX_LENGTH_PATH_FILENAME-1)
+         {
+            tmpl->length = PERS_ORG_MAX_LENGTH_PATH_FILENAME-1;
+         }
+         tmpl->generation = generation;
       }
-      storePolicy = PersistenceStorage_local;
    }
 
-   // create resource database path
-   if(dbContext->context.ldbid < 0x80)
+   strbuf_append(sb, tmpl->path, tmpl->length);    // copied with the lock held, the template may be recreated afterwards
+
+   pthread_rwlock_unlock(&gPathTemplateLock);
+}
+
+
+
+int get_db_path_and_key(PersistenceInfo_s* dbContext, const char* resource_id, char dbKey[], char dbPath[])
+{
+   int storePolicy = PersistenceStorage_LastEntry;
+   unsigned int ldbid = dbContext->context.ldbid;
+   PersistencePolicy_e policy = dbContext->configKey.policy;
+   PersStrBuf_s sb;
+
+   // create resource database key
+   if(NULL != dbKey)
    {
-      // S H A R E D  database
+      strbuf_init(&sb, dbKey, PERS_DB_MAX_LENGTH_KEY_NAME);
 
-      if(dbContext->context.ldbid != PCL_LDBID_PUBLIC)
+      if((ldbid < 0x80) || (ldbid == PCL_LDBID_LOCAL))
       {
-         // Additionally /GROUP/<LDBID_parameter> shall be added inside of the database path listed in the resource table. (Off target)
-         //
-         // shared  G R O U P  database * * * * * * * * * * * * *  * * * * * *
-         if(PersistencePolicy_wc == dbContext->configKey.policy)
+         // The LDBID is used to find the DBID in the resource table.
+         if((dbContext->context.user_no == 0) && (dbContext->context.seat_no == 0))
          {
-            if(dbContext->configKey.type == PersistenceResourceType_key)
-               snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, getSharedCachePath(), gAppId, dbContext->context.ldbid, "");
-            else
-               snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, getSharedCachePathKey(), gAppId, dbContext->context.ldbid, dbKey);
+            // Node is added in front of the resource ID as the key string.
+            strbuf_append_str(&sb, plugin_gNode);
          }
-         else if(PersistencePolicy_wt == dbContext->configKey.policy)
+         else
          {
-            if(dbContext->configKey.type == PersistenceResourceType_key)
-               snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, getSharedWtPath(), gAppId, dbContext->context.ldbid);
-            else
-               snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, getSharedWtPathKey(), gAppId, dbContext->context.ldbid, dbKey);
+            // /User/<user_no_parameter> is added in front of the resource ID as the key string.
+            strbuf_append_str(&sb, plugin_gUser);
+            strbuf_append_uint(&sb, dbContext->context.user_no, 10);
+            if(dbContext->context.seat_no != 0)
+            {
+               // /User/<user_no_parameter>/Seat/<seat_no_parameter> is added in front of the resource ID as the key string.
+               strbuf_append_str(&sb, plugin_gSeat);
+               strbuf_append_uint(&sb, dbContext->context.seat_no, 10);
+            }
          }
       }
       else
       {
-         // Additionally /Shared/Public shall be added inside of the database path listed in the resource table. (Off target)
-         //
-         // shared  P U B L I C  database * * * * * * * * * * * * *  * * * * *
-         if(PersistencePolicy_wc == dbContext->configKey.policy)
+         // The LDBID is used to find the DBID in the resource table.
+         // /<LDBID parameter> is added in front of the resource ID as the key string.
+         //  Rational: Creates a namespace within one data base.
+         //  Rational: Reduction of number of databases -> reduction of maintenance costs
+         // /User/<user_no_parameter> and /Seat/<seat_no_parameter> are add after /<LDBID parameter> if there are different than 0.
+         strbuf_append(&sb, "/", 1);
+         strbuf_append_uint(&sb, ldbid, 16);
+         strbuf_append_str(&sb, plugin_gUser);
+         strbuf_append_uint(&sb, dbContext->context.user_no, 10);
+         if(dbContext->context.seat_no != 0)
          {
-            if(dbContext->configKey.type == PersistenceResourceType_key)
-               snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, getSharedPublicCachePath(), gAppId, "");
-            else
-               snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, getSharedPublicCachePathKey(), gAppId, dbKey);
-         }
-         else if(PersistencePolicy_wt == dbContext->configKey.policy)
-         {
-            if(dbContext->configKey.type == PersistenceResourceType_key)
-               snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, getSharedPublicWtPath(), gAppId, "");
-            else
-               snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, getSharedPublicWtPathKey(), gAppId, dbKey);
+            strbuf_append_str(&sb, plugin_gSeat);
+            strbuf_append_uint(&sb, dbContext->context.seat_no, 10);
          }
       }
-      storePolicy = PersistenceStorage_shared;   // we have a shared database
+      strbuf_append(&sb, "/", 1);
+      strbuf_append_str(&sb, resource_id);
+      strbuf_finish(&sb);
+
+      storePolicy = PersistenceStorage_local;
    }
-   else
+
+   // create resource database path: the precompiled path of the database, followed by the key for files
+   if(policy == PersistencePolicy_wc || policy == PersistencePolicy_wt)
    {
-      // L O C A L   database
-      if(PersistencePolicy_wc == dbContext->configKey.policy)
-      {
-         if(dbContext->configKey.type == PersistenceResourceType_key)
-            snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, getLocalCachePath(), gAppId, "");
-         else
-            snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, getLocalCachePathKey(), gAppId, dbKey);
-      }
-      else if(PersistencePolicy_wt == dbContext->configKey.policy)
+      // the path of local write through databases has always been limited to one character less
+      strbuf_init(&sb, dbPath, ((ldbid >= 0x80) && (policy == PersistencePolicy_wt)) ?
+                               PERS_ORG_MAX_LENGTH_PATH_FILENAME-1 : PERS_ORG_MAX_LENGTH_PATH_FILENAME);
+      path_template_append(&sb, ldbid, policy);
+      if(dbContext->configKey.type != PersistenceResourceType_key)
       {
-         if(dbContext->configKey.type == PersistenceResourceType_key)
-            snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME-1, getLocalWtPath(), gAppId, "");
-         else
-            snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME-1, getLocalWtPathKey(), gAppId, dbKey);
+         strbuf_append_str(&sb, dbKey);
       }
+      strbuf_finish(&sb);
+   }
 
+   if(ldbid < 0x80)
+   {
+      storePolicy = PersistenceStorage_shared;   // we have a shared database
+   }
+   else
+   {
       storePolicy = PersistenceStorage_local;   // we have a local database
    }
 
-   //printf("get_db_path_and_key - dbKey  : [key ]: %s \n",  dbKey);
-   //printf("get_db_path_and_key - dbPath : [path]: %s\n", dbPath);
-
    return storePolicy;
 }
+
+
+
+int pclSetRctLoadHook(pclRctLoadHook_t hook)
+{
+   gRctLoadHook = hook;
+
+   return 0;
+}
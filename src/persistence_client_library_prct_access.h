@@ -37,6 +37,14 @@ int get_db_path_and_key(PersistenceInfo_s* dbContext, const char* resource_id, c
 
 
 
+/**
+ * @brief invalidate the precompiled database paths used by get_db_path_and_key
+ *        (must be called when the application id changes)
+ */
+void invalidate_path_templates(void);
+
+
+
 /**
  * @brief Create database search key and database location path
  *
@@ -61,7 +69,19 @@ int get_resource_cfg_table_by_idx(int i);
 
 
 /**
- * @brief mark the resource configuration table as closed
+ * @brief open the resource configuration table of a logical database in advance
+ *
+ * @param ldbid the logical database id
+ *
+ * @return the handle to the table or a negative value if the table could not be opened
+ */
+int open_resource_cfg_table(unsigned int ldbid);
+
+
+
+/**
+ * @brief close the resource configuration table, waits for running lookups to finish
+ *        before the handle is closed and the index is released
  *
  * @param i the index
  */
@@ -69,4 +89,12 @@ void invalidate_resource_cfg_table(int i);
 
 
 
+/**
+ * @brief invalidate all entries of the resolved resource cache and of the cache of resources
+ *        missing in the resource configuration tables (must be called when the tables are closed)
+ */
+void invalidate_resolved_cache(void);
+
+
+
 #endif /* PERSISTENCE_CLIENT_LIBRARY_ACCESS_HELPER_H */
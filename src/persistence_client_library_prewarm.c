@@ -0,0 +1,332 @@
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_prewarm.c
+ * @ingroup        Persistence client library
+ * @brief          Implementation of the database prewarm.
+ *                 The databases and resource configuration tables of the prewarm list
+ *                 are opened by a small pool of threads while the application starts,
+ *                 the first access finds an already open database.
+ * @see
+ */
+
+#include "persistence_client_library_prewarm.h"
+#include "persistence_client_library_db_access.h"
+#include "persistence_client_library_prct_access.h"
+
+#include <pthread.h>
+#include <errno.h>
+#include <dlt.h>
+
+DLT_IMPORT_CONTEXT(gPclDLTContext);
+
+
+/// database to be opened in advance
+typedef struct _PersPrewarmEntry_s
+{
+   /// storage type
+   unsigned int storage;
+   /// logical database id
+   unsigned int ldbid;
+   /// database type (policy or default database), -1 for the resource configuration table
+   int dbType;
+   /// path to the database
+   char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME];
+} PersPrewarmEntry_s;
+
+
+/// file the databases used during a run are stored in, located in the application cache folder
+static const char* gPrewarmFilename = "PrewarmList.info";
+/// the full path of the prewarm file
+static char gPrewarmFile[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+
+/// flag to indicate if the prewarm is enabled
+static int gPrewarmEnabled = 0;
+
+/// the databases to open in advance
+static PersPrewarmEntry_s gPrewarmList[PrewarmMaxEntries];
+/// number of databases to open in advance
+static unsigned int gPrewarmCount = 0;
+/// index of the next database to be opened by the prewarm threads
+static unsigned int gPrewarmNext = 0;
+/// number of databases the prewarm threads have opened
+static unsigned int gPrewarmOpened = 0;
+
+/// the databases used during this run
+static PersPrewarmEntry_s gPrewarmUsed[PrewarmMaxEntries];
+/// number of databases used during this run
+static unsigned int gPrewarmUsedCount = 0;
+/// protects the databases used during this run
+static pthread_mutex_t gPrewarmMtx = PTHREAD_MUTEX_INITIALIZER;
+
+/// the prewarm threads
+static pthread_t gPrewarmThread[PrewarmThreads];
+/// number of running prewarm threads
+static unsigned int gPrewarmNumThreads = 0;
+
+
+
+/**
+ * @brief add a database to a list, nothing is added if it is already in the list or the list is full
+ *
+ * @return 1 if the database has been added; 0 if not
+ */
+static int prewarm_add(PersPrewarmEntry_s* list, unsigned int* count, unsigned int storage, unsigned int ldbid,
+                       int dbType, const char* dbPath)
+{
+   unsigned int i = 0;
+
+   for(i = 0; i < *count; i++)
+   {
+      if(   list[i].ldbid == ldbid
+         && list[i].dbType == dbType
+         && strncmp(list[i].dbPath, dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME) == 0)
+      {
+         return 0;
+      }
+   }
+
+   if(*count >= PrewarmMaxEntries)
+   {
+      return 0;
+   }
+
+   list[*count].storage = storage;
+   list[*count].ldbid   = ldbid;
+   list[*count].dbType  = dbType;
+   strncpy(list[*count].dbPath, dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME-1);
+   list[*count].dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME-1] = '\0';
+   (*count)++;
+
+   return 1;
+}
+
+
+
+/**
+ * @brief add the resource configuration table and the databases of a logical database to the prewarm list
+ */
+static void prewarm_add_ldbid(unsigned int ldbid)
+{
+   int policy = 0;
+
+   (void)prewarm_add(gPrewarmList, &gPrewarmCount, 0, ldbid, -1, "");
+
+   for(policy = PersistencePolicy_wc; policy <= PersistencePolicy_wt; policy++)
+   {
+      PersistenceInfo_s info;
+      char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME] = {0};
+      char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+      unsigned int storage = 0;
+
+      memset(&info, 0, sizeof(PersistenceInfo_s));
+      info.context.ldbid     = ldbid;
+      info.configKey.type    = PersistenceResourceType_key;
+      info.configKey.policy  = (PersistencePolicy_e)policy;
+      storage = (unsigned int)get_db_path_and_key(&info, "", dbKey, dbPath);
+
+      (void)prewarm_add(gPrewarmList, &gPrewarmCount, storage, ldbid, policy, dbPath);
+      (void)prewarm_add(gPrewarmList, &gPrewarmCount, storage, ldbid, PersistenceDB_confdefault, dbPath);
+      (void)prewarm_add(gPrewarmList, &gPrewarmCount, storage, ldbid, PersistenceDB_default, dbPath);
+   }
+}
+
+
+
+/**
+ * @brief read the databases used during the previous run
+ */
+static void prewarm_read_file(void)
+{
+   FILE* file = fopen(gPrewarmFile, "r");
+
+   if(file != NULL)
+   {
+      char line[PERS_ORG_MAX_LENGTH_PATH_FILENAME + 32] = {0};
+      char format[32] = {0};
+
+      snprintf(format, sizeof(format), "%%u %%x %%d %%%ds", PERS_ORG_MAX_LENGTH_PATH_FILENAME-1);
+
+      while(fgets(line, (int)sizeof(line), file) != NULL)
+      {
+         PersPrewarmEntry_s entry;
+
+         memset(&entry, 0, sizeof(PersPrewarmEntry_s));
+         if(   sscanf(line, format, &entry.storage, &entry.ldbid, &entry.dbType, entry.dbPath) == 4
+            && entry.dbType >= 0 && entry.dbType < (int)PersistenceDB_LastEntry)
+         {
+            (void)prewarm_add(gPrewarmList, &gPrewarmCount, 0, entry.ldbid, -1, "");
+            (void)prewarm_add(gPrewarmList, &gPrewarmCount, entry.storage, entry.ldbid, entry.dbType, entry.dbPath);
+         }
+      }
+      fclose(file);
+   }
+}
+
+
+
+/**
+ * @brief write the databases used during this run
+ */
+static void prewarm_write_file(void)
+{
+   FILE* file = fopen(gPrewarmFile, "w");
+
+   if(file != NULL)
+   {
+      unsigned int i = 0;
+
+      pthread_mutex_lock(&gPrewarmMtx);
+      for(i = 0; i < gPrewarmUsedCount; i++)
+      {
+         fprintf(file, "%u %x %d %s\n", gPrewarmUsed[i].storage, gPrewarmUsed[i].ldbid, gPrewarmUsed[i].dbType, gPrewarmUsed[i].dbPath);
+      }
+      pthread_mutex_unlock(&gPrewarmMtx);
+
+      fclose(file);
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("prewarm - Err write file"), DLT_STRING(gPrewarmFile), DLT_STRING(strerror(errno)));
+   }
+}
+
+
+
+static void* prewarm_worker(void* userData)
+{
+   unsigned int idx = 0;
+
+   (void)userData;
+
+   while((idx = __sync_fetch_and_add(&gPrewarmNext, 1)) < gPrewarmCount)
+   {
+      PersPrewarmEntry_s* entry = &gPrewarmList[idx];
+      int rval = 0;
+
+      if(entry->dbType < 0)
+      {
+         rval = open_resource_cfg_table(entry->ldbid);
+      }
+      else
+      {
+         PersistenceInfo_s info;
+
+         memset(&info, 0, sizeof(PersistenceInfo_s));
+         info.context.ldbid    = entry->ldbid;
+         info.configKey.type   = PersistenceResourceType_key;
+         info.configKey.storage = (PersistenceStorage_e)entry->storage;
+         rval = persistence_prewarm_db(&info, entry->dbPath, entry->dbType);
+      }
+
+      if(rval > 0 || (entry->dbType < 0 && rval >= 0))
+      {
+         (void)__sync_add_and_fetch(&gPrewarmOpened, 1);
+      }
+   }
+
+   return NULL;
+}
+
+
+
+void prewarm_start(const char* appName)
+{
+   const char* ldbids = getenv("PERS_CLIENT_LIB_PREWARM");
+
+   if(ldbids != NULL && gPrewarmNumThreads == 0)
+   {
+      char list[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+      char* savePtr = NULL;
+      char* token = NULL;
+      unsigned int i = 0;
+
+      gPrewarmEnabled = 1;
+      gPrewarmCount = 0;
+      gPrewarmNext = 0;
+      gPrewarmOpened = 0;
+      pthread_mutex_lock(&gPrewarmMtx);
+      gPrewarmUsedCount = 0;
+      pthread_mutex_unlock(&gPrewarmMtx);
+
+      snprintf(gPrewarmFile, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s/%s", CACHEPREFIX, appName, gPrewarmFilename);
+
+      // the logical databases given by the application
+      strncpy(list, ldbids, PERS_ORG_MAX_LENGTH_PATH_FILENAME-1);
+      for(token = strtok_r(list, ", ", &savePtr); token != NULL; token = strtok_r(NULL, ", ", &savePtr))
+      {
+         char* end = NULL;
+         unsigned long ldbid = strtoul(token, &end, 0);
+
+         if(end != token && *end == '\0')
+         {
+            prewarm_add_ldbid((unsigned int)ldbid);
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("prewarm - invalid ldbid:"), DLT_STRING(token));
+         }
+      }
+
+      // the databases used during the previous run
+      prewarm_read_file();
+
+      for(i = 0; i < PrewarmThreads && i < gPrewarmCount; i++)
+      {
+         if(pthread_create(&gPrewarmThread[i], NULL, prewarm_worker, NULL) == 0)
+         {
+            (void)pthread_setname_np(gPrewarmThread[i], "pclPrewarm");
+            gPrewarmNumThreads++;
+         }
+         else
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("prewarm - pthread_create failed"));
+            break;
+         }
+      }
+
+      if(gPrewarmNumThreads == 0)
+      {
+         prewarm_worker(NULL);      // no thread available, open the databases now
+      }
+
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("prewarm - databases:"), DLT_UINT(gPrewarmCount),
+                                            DLT_STRING("threads:"), DLT_UINT(gPrewarmNumThreads));
+   }
+}
+
+
+
+void prewarm_deinit(void)
+{
+   unsigned int i = 0;
+
+   for(i = 0; i < gPrewarmNumThreads; i++)
+   {
+      pthread_join(gPrewarmThread[i], NULL);
+   }
+   gPrewarmNumThreads = 0;
+
+   if(gPrewarmEnabled != 0)
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_INFO, DLT_STRING("prewarm - opened:"), DLT_UINT(gPrewarmOpened),
+                                            DLT_STRING("of"), DLT_UINT(gPrewarmCount));
+      prewarm_write_file();
+      gPrewarmEnabled = 0;
+   }
+}
+
+
+
+void prewarm_record(unsigned int storage, unsigned int ldbid, int dbType, const char* dbPath)
+{
+   if(gPrewarmEnabled != 0)
+   {
+      pthread_mutex_lock(&gPrewarmMtx);
+      (void)prewarm_add(gPrewarmUsed, &gPrewarmUsedCount, storage, ldbid, dbType, dbPath);
+      pthread_mutex_unlock(&gPrewarmMtx);
+   }
+}
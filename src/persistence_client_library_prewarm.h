@@ -0,0 +1,56 @@
+#ifndef PERSISTENCE_CLIENT_LIBRARY_PREWARM_H
+#define PERSISTENCE_CLIENT_LIBRARY_PREWARM_H
+
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_prewarm.h
+ * @ingroup        Persistence client library
+ * @brief          Header of the database prewarm: databases and resource configuration
+ *                 tables are opened in advance by a small pool of threads.
+ * @see
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "persistence_client_library_data_organization.h"
+
+
+/**
+ * @brief start opening the databases of the prewarm list in the background.
+ *        The list consists of the logical database ids of the environment variable
+ *        PERS_CLIENT_LIB_PREWARM (comma separated) and the databases used during the previous run.
+ *        Nothing is done if the environment variable is not set.
+ *
+ * @param appName the application name
+ */
+void prewarm_start(const char* appName);
+
+
+/**
+ * @brief wait until the prewarm threads have ended and store the databases used during this run
+ */
+void prewarm_deinit(void);
+
+
+/**
+ * @brief remember a database which has been opened, it will be opened in advance on the next run
+ *
+ * @param storage the storage type
+ * @param ldbid the logical database id
+ * @param dbType the database type (policy or default database)
+ * @param dbPath the path to the database
+ */
+void prewarm_record(unsigned int storage, unsigned int ldbid, int dbType, const char* dbPath);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERSISTENCE_CLIENT_LIBRARY_PREWARM_H */
@@ -0,0 +1,434 @@
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_rct_index.c
+ * @ingroup        Persistence client library
+ * @brief          Implementation of the in-memory resource configuration table index.
+ *                 The resources are spread over small buckets; for every bucket a seed is
+ *                 searched which maps all its resources to free slots (hash and displace).
+ *                 A precompiled index file is mapped read-only, its pages are shared
+ *                 by all processes using the same table.
+ * @see
+ */
+
+#include "persistence_client_library_rct_index.h"
+#include "persistence_client_library_custom_loader.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dlt.h>
+
+DLT_IMPORT_CONTEXT(gPclDLTContext);
+
+
+const char* gRctIndexSuffix = ".idx";
+
+
+
+static unsigned int rct_index_hash(const char* resource_id)
+{
+   unsigned int hash = 2166136261u;
+
+   while(*resource_id != '\0')
+   {
+      hash = (hash ^ (unsigned char)*resource_id++) * 16777619u;
+   }
+
+   return hash;
+}
+
+
+
+static unsigned int rct_index_slot(unsigned int hash, unsigned int seed, unsigned int numSlots)
+{
+   hash ^= seed * 0x9E3779B9u;
+   hash ^= hash >> 16;
+   hash *= 0x85EBCA6Bu;
+   hash ^= hash >> 13;
+   hash *= 0xC2B2AE35u;
+   hash ^= hash >> 16;
+
+   return hash & (numSlots - 1);
+}
+
+
+
+/**
+ * @brief search a seed mapping all resources of a bucket to free and different slots
+ *
+ * @return 0 on success, -1 if there is no such seed
+ */
+static int rct_index_place_bucket(PersRctIndex_s* index, const unsigned int hashes[], const unsigned int members[], unsigned int count,
+                                  unsigned int bucket)
+{
+   unsigned int* seeds = (unsigned int*)((char*)index + index->seedOffset);
+   unsigned int* slots = (unsigned int*)((char*)index + index->slotOffset);
+   unsigned int seed = 0, i = 0, j = 0;
+
+   for(seed = 0; seed < RctIndexMaxSeeds; seed++)
+   {
+      int collision = 0;
+
+      for(i = 0; i < count && collision == 0; i++)
+      {
+         unsigned int slot = rct_index_slot(hashes[members[i]], seed, index->numSlots);
+
+         if(slots[slot] != 0)
+         {
+            collision = 1;
+         }
+         for(j = 0; j < i && collision == 0; j++)
+         {
+            if(slot == rct_index_slot(hashes[members[j]], seed, index->numSlots))
+            {
+               collision = 1;
+            }
+         }
+      }
+
+      if(collision == 0)
+      {
+         for(i = 0; i < count; i++)
+         {
+            slots[rct_index_slot(hashes[members[i]], seed, index->numSlots)] = members[i] + 1;
+         }
+         seeds[bucket] = seed;
+         return 0;
+      }
+   }
+
+   return -1;
+}
+
+
+
+PersRctIndex_s* rct_index_create(const char* const names[], const PersistenceConfigurationKey_s configs[], unsigned int count)
+{
+   unsigned int numSlots = 1, numBuckets = 1, namesSize = 0, size = 0, i = 0;
+   unsigned int *hashes = NULL, *bucketStart = NULL, *members = NULL;
+   PersRctIndex_s* index = NULL;
+   int ok = 1;
+
+   while(numSlots < count + count / 4 + 1)     // load factor 0.8
+   {
+      numSlots <<= 1;
+   }
+   while(numBuckets * 4 < count)               // 4 resources per bucket
+   {
+      numBuckets <<= 1;
+   }
+   for(i = 0; i < count; i++)
+   {
+      namesSize += (unsigned int)strlen(names[i]) + 1;
+   }
+
+   size = (unsigned int)sizeof(PersRctIndex_s) + (numBuckets + numSlots) * (unsigned int)sizeof(unsigned int)
+        + count * (unsigned int)sizeof(PersRctIndexEntry_s) + namesSize;
+
+   index       = calloc(1, size);
+   hashes      = malloc((count + 1) * sizeof(unsigned int));
+   bucketStart = calloc(numBuckets + 1, sizeof(unsigned int));
+   members     = malloc((count + 1) * sizeof(unsigned int));
+
+   if(index != NULL && hashes != NULL && bucketStart != NULL && members != NULL)
+   {
+      PersRctIndexEntry_s* entries = NULL;
+      unsigned int nameOffset = 0, bucket = 0, maxCount = 0, bucketCount = 0;
+
+      index->magic       = RctIndexMagic;
+      index->version     = RctIndexVersion;
+      index->configSize  = (unsigned int)sizeof(PersistenceConfigurationKey_s);
+      index->size        = size;
+      index->numEntries  = count;
+      index->numBuckets  = numBuckets;
+      index->numSlots    = numSlots;
+      index->seedOffset  = (unsigned int)sizeof(PersRctIndex_s);
+      index->slotOffset  = index->seedOffset + numBuckets * (unsigned int)sizeof(unsigned int);
+      index->entryOffset = index->slotOffset + numSlots * (unsigned int)sizeof(unsigned int);
+      index->nameOffset  = index->entryOffset + count * (unsigned int)sizeof(PersRctIndexEntry_s);
+
+      entries = (PersRctIndexEntry_s*)((char*)index + index->entryOffset);
+      nameOffset = index->nameOffset;
+
+      for(i = 0; i < count; i++)
+      {
+         size_t len = strlen(names[i]) + 1;
+
+         memcpy((char*)index + nameOffset, names[i], len);
+         entries[i].nameOffset = nameOffset;
+         memcpy(&entries[i].config, &configs[i], sizeof(PersistenceConfigurationKey_s));
+         nameOffset += (unsigned int)len;
+
+         hashes[i] = rct_index_hash(names[i]);
+         bucketStart[(hashes[i] & (numBuckets - 1)) + 1]++;
+      }
+
+      // group the resources by bucket
+      for(bucket = 0; bucket < numBuckets; bucket++)
+      {
+         if(bucketStart[bucket + 1] > maxCount)
+         {
+            maxCount = bucketStart[bucket + 1];
+         }
+         bucketStart[bucket + 1] += bucketStart[bucket];
+      }
+      for(i = 0; i < count; i++)
+      {
+         bucket = hashes[i] & (numBuckets - 1);
+         members[bucketStart[bucket]++] = i;
+      }
+      for(bucket = numBuckets; bucket > 0; bucket--)      // restore the start of the buckets
+      {
+         bucketStart[bucket] = bucketStart[bucket - 1];
+      }
+      bucketStart[0] = 0;
+
+      // the largest buckets first, while most slots are free
+      for(bucketCount = maxCount; bucketCount > 0 && ok == 1; bucketCount--)
+      {
+         for(bucket = 0; bucket < numBuckets && ok == 1; bucket++)
+         {
+            if(bucketStart[bucket + 1] - bucketStart[bucket] == bucketCount)
+            {
+               if(rct_index_place_bucket(index, hashes, &members[bucketStart[bucket]], bucketCount, bucket) != 0)
+               {
+                  DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("rctIndexCreate - no seed for bucket:"), DLT_UINT(bucket));
+                  ok = 0;
+               }
+            }
+         }
+      }
+   }
+   else
+   {
+      DLT_LOG(gPclDLTContext, DLT_LOG_ERROR, DLT_STRING("rctIndexCreate - malloc failed"));
+      ok = 0;
+   }
+
+   free(hashes);
+   free(bucketStart);
+   free(members);
+
+   if(ok == 0)
+   {
+      free(index);
+      index = NULL;
+   }
+
+   return index;
+}
+
+
+
+PersRctIndex_s* rct_index_load(int handleRCT)
+{
+   PersRctIndex_s* index = NULL;
+
+   if(   *plugin_persComRctGetSizeResourcesList != NULL && *plugin_persComRctGetResourcesList != NULL
+      && *plugin_persComRctRead != NULL)
+   {
+      int listSize = plugin_persComRctGetSizeResourcesList(handleRCT);
+      char* list = (listSize > 0) ? malloc((size_t)listSize + 1) : NULL;
+
+      if(list != NULL)
+      {
+         listSize = plugin_persComRctGetResourcesList(handleRCT, list, listSize);
+         if(listSize > 0)
+         {
+            unsigned int count = 0, numRead = 0;
+            const char** names = NULL;
+            PersistenceConfigurationKey_s* configs = NULL;
+            int pos = 0;
+
+            list[listSize] = '\0';
+            for(pos = 0; pos < listSize; pos += (int)strlen(&list[pos]) + 1)
+            {
+               count++;
+            }
+
+            names   = malloc(count * sizeof(const char*));
+            configs = malloc(count * sizeof(PersistenceConfigurationKey_s));
+            if(names != NULL && configs != NULL)
+            {
+               for(pos = 0; pos < listSize; pos += (int)strlen(&list[pos]) + 1)
+               {
+                  if(   list[pos] != '\0'
+                     && plugin_persComRctRead(handleRCT, &list[pos], &configs[numRead]) == (int)sizeof(PersistenceConfigurationKey_s))
+                  {
+                     names[numRead++] = &list[pos];
+                  }
+               }
+               index = rct_index_create(names, configs, numRead);
+            }
+            free(names);
+            free(configs);
+         }
+         free(list);
+      }
+   }
+
+   return index;
+}
+
+
+
+int rct_index_valid(const PersRctIndex_s* index, size_t size)
+{
+   int rval = 0;
+
+   if(   size >= sizeof(PersRctIndex_s)
+      && index->magic == RctIndexMagic
+      && index->version == RctIndexVersion
+      && index->configSize == sizeof(PersistenceConfigurationKey_s)
+      && index->size == size
+      && index->numBuckets > 0 && (index->numBuckets & (index->numBuckets - 1)) == 0
+      && index->numSlots > 0 && (index->numSlots & (index->numSlots - 1)) == 0
+      && index->seedOffset == sizeof(PersRctIndex_s)
+      && index->slotOffset == index->seedOffset + index->numBuckets * sizeof(unsigned int)
+      && index->entryOffset == index->slotOffset + index->numSlots * sizeof(unsigned int)
+      && index->nameOffset == index->entryOffset + index->numEntries * sizeof(PersRctIndexEntry_s)
+      && index->nameOffset <= size
+      && (index->nameOffset == size || ((const char*)index)[size - 1] == '\0') )
+   {
+      const unsigned int* slots = (const unsigned int*)((const char*)index + index->slotOffset);
+      const PersRctIndexEntry_s* entries = (const PersRctIndexEntry_s*)((const char*)index + index->entryOffset);
+      unsigned int i = 0;
+
+      rval = 1;
+      for(i = 0; i < index->numSlots && rval == 1; i++)
+      {
+         rval = (slots[i] <= index->numEntries) ? 1 : 0;
+      }
+      for(i = 0; i < index->numEntries && rval == 1; i++)
+      {
+         rval = (entries[i].nameOffset >= index->nameOffset && entries[i].nameOffset < size) ? 1 : 0;
+      }
+   }
+
+   return rval;
+}
+
+
+
+int rct_index_lookup(const PersRctIndex_s* index, const char* resource_id, PersistenceConfigurationKey_s* config)
+{
+   const unsigned int* seeds = (const unsigned int*)((const char*)index + index->seedOffset);
+   const unsigned int* slots = (const unsigned int*)((const char*)index + index->slotOffset);
+   unsigned int hash = rct_index_hash(resource_id);
+   unsigned int entry = slots[rct_index_slot(hash, seeds[hash & (index->numBuckets - 1)], index->numSlots)];
+
+   if(entry != 0)
+   {
+      const PersRctIndexEntry_s* found = (const PersRctIndexEntry_s*)((const char*)index + index->entryOffset) + (entry - 1);
+
+      if(strcmp((const char*)index + found->nameOffset, resource_id) == 0)
+      {
+         memcpy(config, &found->config, sizeof(PersistenceConfigurationKey_s));
+         return 1;
+      }
+   }
+
+   return 0;
+}
+
+
+
+int rct_index_stamp(PersRctIndex_s* index, const char* rctFilename)
+{
+   struct stat st;
+
+   if(stat(rctFilename, &st) != 0)
+   {
+      return -1;
+   }
+
+   index->sourceSize  = (unsigned long long)st.st_size;
+   index->sourceMtime = (unsigned long long)st.st_mtim.tv_sec * 1000000000ULL + (unsigned long long)st.st_mtim.tv_nsec;
+
+   return 0;
+}
+
+
+
+PersRctIndex_s* rct_index_map(const char* rctFilename, size_t* mapSize)
+{
+   char indexFilename[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+   PersRctIndex_s* index = NULL;
+   struct stat st;
+   int fd = -1;
+
+   snprintf(indexFilename, PERS_ORG_MAX_LENGTH_PATH_FILENAME, "%s%s", rctFilename, gRctIndexSuffix);
+
+   fd = open(indexFilename, O_RDONLY | O_CLOEXEC);
+   if(fd == -1)
+   {
+      return NULL;      // no precompiled index, nothing to report
+   }
+
+   if(fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(PersRctIndex_s))
+   {
+      void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+      if(map != MAP_FAILED)
+      {
+         PersRctIndex_s stamp;
+
+         memset(&stamp, 0, sizeof(PersRctIndex_s));
+         index = (PersRctIndex_s*)map;
+
+         if(rct_index_valid(index, (size_t)st.st_size) == 0)
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("rctIndexMap - invalid index:"), DLT_STRING(indexFilename));
+            index = NULL;
+         }
+         else if(   rct_index_stamp(&stamp, rctFilename) != 0
+                 || stamp.sourceSize != index->sourceSize || stamp.sourceMtime != index->sourceMtime)
+         {
+            DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("rctIndexMap - stale index:"), DLT_STRING(indexFilename));
+            index = NULL;
+         }
+
+         if(index == NULL)
+         {
+            munmap(map, (size_t)st.st_size);
+         }
+         else
+         {
+            *mapSize = (size_t)st.st_size;
+         }
+      }
+      else
+      {
+         DLT_LOG(gPclDLTContext, DLT_LOG_WARN, DLT_STRING("rctIndexMap - mmap failed:"), DLT_STRING(indexFilename), DLT_STRING(strerror(errno)));
+      }
+   }
+
+   close(fd);
+
+   return index;
+}
+
+
+
+void rct_index_release(PersRctIndex_s* index, size_t mapSize)
+{
+   if(index != NULL)
+   {
+      if(mapSize > 0)
+      {
+         munmap(index, mapSize);
+      }
+      else
+      {
+         free(index);
+      }
+   }
+}
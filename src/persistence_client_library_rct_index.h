@@ -0,0 +1,161 @@
+#ifndef PERSISTENCE_CLIENT_LIBRARY_RCT_INDEX_H
+#define PERSISTENCE_CLIENT_LIBRARY_RCT_INDEX_H
+
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+ /**
+ * @file           persistence_client_library_rct_index.h
+ * @ingroup        Persistence client library
+ * @brief          Header of the in-memory resource configuration table index.
+ *                 All resources of a table are stored in one immutable block, found
+ *                 with a perfect hash: one probe per lookup, no plugin call.
+ *                 The block can be precompiled into a file next to the table
+ *                 (persistence_rct_compiler) and mapped read-only by all processes.
+ * @see
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "persistence_client_library_data_organization.h"
+
+
+/// suffix of the precompiled index file, appended to the path of the resource configuration table
+extern const char* gRctIndexSuffix;
+
+
+/**
+ * resource configuration table index, a single block without pointers.
+ * The header is followed by the bucket seeds, the slots, the entries and the resource ids.
+ */
+typedef struct _PersRctIndex_s
+{
+   /// ::RctIndexMagic
+   unsigned int magic;
+   /// ::RctIndexVersion
+   unsigned int version;
+   /// size of PersistenceConfigurationKey_s the index has been created with
+   unsigned int configSize;
+   /// size of the whole block [bytes]
+   unsigned int size;
+   /// number of resources
+   unsigned int numEntries;
+   /// number of hash buckets (power of 2)
+   unsigned int numBuckets;
+   /// number of slots (power of 2)
+   unsigned int numSlots;
+   /// offset of the bucket seeds (unsigned int[numBuckets])
+   unsigned int seedOffset;
+   /// offset of the slots (unsigned int[numSlots], entry index + 1, 0 if empty)
+   unsigned int slotOffset;
+   /// offset of the entries (PersRctIndexEntry_s[numEntries])
+   unsigned int entryOffset;
+   /// offset of the resource ids
+   unsigned int nameOffset;
+   /// reserved, 0
+   unsigned int reserved;
+   /// size of the resource configuration table the index has been compiled from [bytes], 0 if created in memory
+   unsigned long long sourceSize;
+   /// modification time of the resource configuration table the index has been compiled from [ns]
+   unsigned long long sourceMtime;
+} PersRctIndex_s;
+
+
+/// resource of the index
+typedef struct _PersRctIndexEntry_s
+{
+   /// offset of the resource id from the start of the index
+   unsigned int nameOffset;
+   /// the resource configuration
+   PersistenceConfigurationKey_s config;
+} PersRctIndexEntry_s;
+
+
+/**
+ * @brief create the index of resources
+ *
+ * @param names the resource ids
+ * @param configs the resource configurations
+ * @param count number of resources
+ *
+ * @return the index (to be released with free) or NULL if the index could not be created
+ */
+PersRctIndex_s* rct_index_create(const char* const names[], const PersistenceConfigurationKey_s configs[], unsigned int count);
+
+
+/**
+ * @brief read all resources of an open resource configuration table and create the index
+ *
+ * @param handleRCT the handle of the table
+ *
+ * @return the index (to be released with free) or NULL if the index could not be created
+ */
+PersRctIndex_s* rct_index_load(int handleRCT);
+
+
+/**
+ * @brief check if a memory block is a valid index
+ *
+ * @param index the index
+ * @param size the size of the memory block
+ *
+ * @return 1 if valid; 0 if not
+ */
+int rct_index_valid(const PersRctIndex_s* index, size_t size);
+
+
+/**
+ * @brief store the size and modification time of a resource configuration table in the index,
+ *        a precompiled index is only used as long as the table has not been changed
+ *
+ * @param index the index
+ * @param rctFilename the path of the resource configuration table
+ *
+ * @return 0 on success, -1 if the table can't be accessed
+ */
+int rct_index_stamp(PersRctIndex_s* index, const char* rctFilename);
+
+
+/**
+ * @brief map the precompiled index of a resource configuration table read-only.
+ *        The index file is the path of the table followed by ::gRctIndexSuffix.
+ *
+ * @param rctFilename the path of the resource configuration table
+ * @param mapSize the size of the mapping will be stored here
+ *
+ * @return the index (to be released with rct_index_release) or NULL if there is no index file,
+ *         or the index is invalid or older than the table
+ */
+PersRctIndex_s* rct_index_map(const char* rctFilename, size_t* mapSize);
+
+
+/**
+ * @brief release an index
+ *
+ * @param index the index, NULL is ignored
+ * @param mapSize the size of the mapping returned by rct_index_map, 0 if the index has been created in memory
+ */
+void rct_index_release(PersRctIndex_s* index, size_t mapSize);
+
+
+/**
+ * @brief get the configuration of a resource
+ *
+ * @param index the index
+ * @param resource_id the resource id
+ * @param config the configuration of the resource will be stored here
+ *
+ * @return 1 if the resource has been found; 0 if not
+ */
+int rct_index_lookup(const PersRctIndex_s* index, const char* resource_id, PersistenceConfigurationKey_s* config);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERSISTENCE_CLIENT_LIBRARY_RCT_INDEX_H */
@@ -19,10 +19,13 @@
 #include "../include/persistence_client_library_key.h"
 #include "../include/persistence_client_library_file.h"
 #include "../include/persistence_client_library_error_def.h"
+#include "../src/persistence_client_library_prct_access.h"
+#include "../src/persistence_client_library_dbus_service.h"
 
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>     /* atoi */
+#include <unistd.h>     /* sysconf */
 
 #include <dlt.h>
 #include <dlt_common.h>
@@ -30,6 +33,7 @@
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <pthread.h>
+#include <sched.h>
 
 
 #define SECONDS2NANO 1000000000L
@@ -38,6 +42,9 @@
 
 #define BUFFER_SIZE  2048
 
+// max number of reader threads used for the parallel read benchmark
+#define MAX_READ_THREADS 16
+
 // define for the used clock: "CLOCK_MONOTONIC" or "CLOCK_REALTIME"
 #define CLOCK_ID  CLOCK_MONOTONIC
 
@@ -53,6 +60,30 @@ double gAverageBytesWriteSecond = 0, gAverageTimeWriteSecond = 0;
 double gDurationRead = 0, gSizeRead = 0;
 double gDurationReadSecond = 0, gSizeReadSecond = 0;
 double gDurationInit = 0, gDurationDeinit = 0;
+double gReadsPerSecondMt[MAX_READ_THREADS+1] = {0};
+int gNumReadThreads = 0;
+double gDurationPathKeySnprintf = 0, gDurationPathKeyTemplate = 0;
+double gCommandsPerSecondMt[MAX_READ_THREADS+1] = {0};
+long long gCommandRetriesMt[MAX_READ_THREADS+1] = {0};
+int gNumCommandThreads = 0;
+
+/// key prefix strings of the plugin (persistence_client_library_custom_loader.h)
+extern char* plugin_gUser;
+extern char* plugin_gSeat;
+
+
+typedef struct _ReadThreadData_s
+{
+   int numLoops;
+   long size;
+} ReadThreadData_s;
+
+
+typedef struct _CommandThreadData_s
+{
+   int numCommands;
+   long long numRetries;
+} CommandThreadData_s;
 
 
 inline long long getNsDuration(struct timespec* start, struct timespec* end)
@@ -98,6 +129,135 @@ void init_benchmark(int numLoops)
 
 
 
+/**
+ * @brief database key and path of a local cached resource created with snprintf, as done before the path templates
+ */
+static void path_key_snprintf(const PersistenceInfo_s* info, const char* resource_id, char dbKey[], char dbPath[])
+{
+   snprintf(dbKey, PERS_DB_MAX_LENGTH_KEY_NAME, "%s%u%s%u/%s", plugin_gUser, info->context.user_no, plugin_gSeat, info->context.seat_no, resource_id);
+   snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, getLocalCachePath(), gAppName, "");
+}
+
+
+
+void path_key_benchmark(int numLoops)
+{
+   int i = 0;
+   long long duration = 0;
+   struct timespec start, end;
+   char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME] = {0};
+   char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME] = {0};
+   PersistenceInfo_s info;
+   int numCalls = numLoops * 1000;
+
+   (void)pclInitLibrary(gAppName , PCL_SHUTDOWN_TYPE_NONE);
+
+   memset(&info, 0, sizeof(PersistenceInfo_s));
+   info.context.ldbid    = PCL_LDBID_LOCAL;
+   info.context.user_no  = 1;
+   info.context.seat_no  = 2;
+   info.configKey.policy = PersistencePolicy_wc;
+   info.configKey.type   = PersistenceResourceType_key;
+
+   clock_gettime(CLOCK_ID, &start);
+   for(i=0; i<numCalls; i++)
+   {
+      path_key_snprintf(&info, "pos/last_position", dbKey, dbPath);
+   }
+   clock_gettime(CLOCK_ID, &end);
+   duration = getNsDuration(&start, &end);
+   gDurationPathKeySnprintf = (double)duration/(double)numCalls;
+
+   clock_gettime(CLOCK_ID, &start);
+   for(i=0; i<numCalls; i++)
+   {
+      (void)get_db_path_and_key(&info, "pos/last_position", dbKey, dbPath);
+   }
+   clock_gettime(CLOCK_ID, &end);
+   duration = getNsDuration(&start, &end);
+   gDurationPathKeyTemplate = (double)duration/(double)numCalls;
+
+   (void)pclDeinitLibrary();
+}
+
+
+
+void* command_thread(void* dataPtr)
+{
+   int i = 0;
+   MainLoopData_u data;
+   CommandThreadData_s* threadData = (CommandThreadData_s*)dataPtr;
+
+   memset(&data, 0, sizeof(MainLoopData_u));
+   data.cmd = (uint32_t)CMD_NOP;
+
+   for(i=0; i<threadData->numCommands; i++)
+   {
+      while(deliverToMainloop_NM(&data) != 0)    // command ring full
+      {
+         threadData->numRetries++;
+         sched_yield();
+      }
+   }
+
+   // the mainloop dispatches in order: returns when all commands of this thread have been dispatched
+   (void)deliverToMainloop(&data);
+
+   return NULL;
+}
+
+
+
+void command_benchmark(int numLoops, int maxThreads)
+{
+   int i = 0, numThreads = 0;
+   long long duration = 0;
+   struct timespec start, end;
+   pthread_t threads[MAX_READ_THREADS];
+   CommandThreadData_s threadData[MAX_READ_THREADS];
+   int numCommands = numLoops * 100;
+
+   (void)pclInitLibrary(gAppName , PCL_SHUTDOWN_TYPE_NONE);
+
+   //
+   // send commands to the dbus mainloop with 1 .. maxThreads concurrent producers
+   //
+   for(numThreads=1; numThreads<=maxThreads; numThreads++)
+   {
+      int numStarted = 0;
+
+      clock_gettime(CLOCK_ID, &start);
+      for(i=0; i<numThreads; i++)
+      {
+         threadData[i].numCommands = numCommands;
+         threadData[i].numRetries = 0;
+
+         if(pthread_create(&threads[i], NULL, command_thread, &threadData[i]) != 0)
+         {
+            printf("command_benchmark - failed to create thread: %d\n", i);
+            break;
+         }
+         numStarted++;
+      }
+
+      gCommandRetriesMt[numThreads] = 0;
+      for(i=0; i<numStarted; i++)
+      {
+         pthread_join(threads[i], NULL);
+         gCommandRetriesMt[numThreads] += threadData[i].numRetries;
+      }
+      clock_gettime(CLOCK_ID, &end);
+
+      duration = getNsDuration(&start, &end);
+      gCommandsPerSecondMt[numThreads] = (double)numStarted * (double)numCommands / ((double)duration / (double)SECONDS2NANO);
+   }
+   gNumCommandThreads = maxThreads;
+
+   (void)pclDeinitLibrary();
+}
+
+
+
 void read_benchmark(int numLoops)
 {
    int ret = 0, i = 0;
@@ -164,6 +324,96 @@ void read_benchmark(int numLoops)
 }
 
 
+void* read_thread(void* dataPtr)
+{
+   int i = 0, ret = 0;
+   char key[128] = { 0 };
+   unsigned char buffer[7168] = {0};   // 7kB
+   ReadThreadData_s* threadData = (ReadThreadData_s*)dataPtr;
+
+   for(i=0; i<threadData->numLoops; i++)
+   {
+      snprintf(key, 128, "pos/last_position_w_bench%d",i);
+
+      ret = pclKeyReadData(PCL_LDBID_LOCAL, key, 10, 10, buffer, 7168);
+      if(ret > 0)
+      {
+         threadData->size += ret;
+      }
+   }
+
+   return NULL;
+}
+
+
+
+void read_parallel_benchmark(int numLoops, int maxThreads)
+{
+   int i = 0, numThreads = 0;
+   long long duration = 0;
+   char key[128] = { 0 };
+   struct timespec readStart, readEnd;
+   pthread_t threads[MAX_READ_THREADS];
+   ReadThreadData_s threadData[MAX_READ_THREADS];
+   int shutdownReg = PCL_SHUTDOWN_TYPE_NONE;
+
+   (void)pclInitLibrary(gAppName , shutdownReg);
+
+   //
+   // populate data
+   //
+   for(i=0; i<numLoops; i++)
+   {
+      snprintf(key, 128, "pos/last_position_w_bench%d",i);
+
+      if(i%2)
+      {
+         (void)pclKeyWriteData(PCL_LDBID_LOCAL, key, 10, 10, (unsigned char*)gWriteBuffer, (int)strlen(gWriteBuffer) );
+      }
+      else
+      {
+         (void)pclKeyWriteData(PCL_LDBID_LOCAL, key, 10, 10, (unsigned char*)gWriteBuffer2, (int)strlen(gWriteBuffer2) );
+      }
+   }
+
+   //
+   // read data with 1 .. maxThreads concurrent readers, every reader reads all keys
+   //
+   for(numThreads=1; numThreads<=maxThreads; numThreads++)
+   {
+      int numStarted = 0;
+
+      clock_gettime(CLOCK_ID, &readStart);
+      for(i=0; i<numThreads; i++)
+      {
+         threadData[i].numLoops = numLoops;
+         threadData[i].size = 0;
+
+         if(pthread_create(&threads[i], NULL, read_thread, &threadData[i]) != 0)
+         {
+            printf("read_parallel_benchmark - failed to create thread: %d\n", i);
+            break;
+         }
+         numStarted++;
+      }
+
+      for(i=0; i<numStarted; i++)
+      {
+         pthread_join(threads[i], NULL);
+      }
+      clock_gettime(CLOCK_ID, &readEnd);
+
+      duration = getNsDuration(&readStart, &readEnd);
+      gReadsPerSecondMt[numThreads] = (double)numStarted * (double)numLoops / ((double)duration / (double)SECONDS2NANO);
+   }
+   gNumReadThreads = maxThreads;
+
+   pclLifecycleSet(PCL_SHUTDOWN);
+   (void)pclDeinitLibrary();
+}
+
+
+
 void write_benchmark(int numLoops)
 {
    int ret = 0, i = 0;
@@ -263,7 +513,7 @@ void printAppManual()
    printf("   ./persistence_client_library_benchmark - run PCL benchmarks");
 
    printf("\nSYNOPSIS\n");
-   printf("   persistence_client_library_benchmark [-l loop] [-irwh]\n");
+   printf("   persistence_client_library_benchmark [-l loop] [-t threads] [-irpwkmh]\n");
 
    printf("\nDESCRIPTION\n");
    printf("   Run persistence client library benchmarks.\n");
@@ -273,7 +523,11 @@ void printAppManual()
    printf("   -l   number of loops for each test (init benchmark is bound to 10 loops)\n");
    printf("   -i   Run init/deinit benchmarks\n");
    printf("   -r   Run read benchmarks\n");
+   printf("   -p   Run parallel read benchmarks (1 up to the number of threads)\n");
+   printf("   -t   max number of threads for the parallel read and command benchmarks (default: number of cores, max %d)\n", MAX_READ_THREADS);
    printf("   -w   Run write benchmarks\n");
+   printf("   -k   Run database path and key creation benchmark (loops * 1000 calls)\n");
+   printf("   -m   Run dbus mainloop command throughput benchmark (1 up to the number of threads, loops * 100 commands per thread)\n");
    printf("   -h   Display this help\n");
    printf("==================================================================================\n");
 }
@@ -289,7 +543,8 @@ int main(int argc, char *argv[])
 
    struct timespec clockRes;
 
-   int opt = 0, doInit = 0, doRead = 0, doWrite = 0, printManual = 0;
+   int opt = 0, doInit = 0, doRead = 0, doReadParallel = 0, doWrite = 0, doPathKey = 0, doCommand = 0, printManual = 0;
+   int numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
 
    const char* envVariable = "PERS_CLIENT_LIB_CUSTOM_LOAD";
 
@@ -300,12 +555,15 @@ int main(int argc, char *argv[])
       // if no parameter, run all tests with default loops
       doInit  = 1;
       doRead  = 1;
+      doReadParallel = 1;
       doWrite = 1;
+      doPathKey = 1;
+      doCommand = 1;
       printManual = 1;
    }
 
 
-   while ((opt = getopt(argc, argv, "l:irwh")) != -1)
+   while ((opt = getopt(argc, argv, "l:t:irpwkmh")) != -1)
    {
       switch (opt)
       {
@@ -315,12 +573,24 @@ int main(int argc, char *argv[])
          case 'i':
             doInit = 1;
             break;
+         case 't':
+            numThreads = atoi(optarg);
+            break;
          case 'r':
             doRead = 1;
             break;
+         case 'p':
+            doReadParallel = 1;
+            break;
          case 'w':
             doWrite = 1;
             break;
+         case 'k':
+            doPathKey = 1;
+            break;
+         case 'm':
+            doCommand = 1;
+            break;
          case 'h':
             printManual = 1;
          break;
@@ -343,9 +613,23 @@ int main(int argc, char *argv[])
    if(doRead == 1)
       read_benchmark(numLoops);
 
+   if(numThreads < 1)
+      numThreads = 1;
+   else if(numThreads > MAX_READ_THREADS)
+      numThreads = MAX_READ_THREADS;
+
+   if(doReadParallel == 1)
+      read_parallel_benchmark(numLoops, numThreads);
+
    if(doWrite == 1)
       write_benchmark(numLoops);
 
+   if(doPathKey == 1)
+      path_key_benchmark(numLoops);
+
+   if(doCommand == 1)
+      command_benchmark(numLoops, numThreads);
+
 
    if(printManual == 1)
    {
@@ -377,6 +661,20 @@ int main(int argc, char *argv[])
       printf("Read benchmark - not activated.\n");
    }
    printf("==================================================================================\n");
+   if(doReadParallel == 1)
+   {
+      int i = 0;
+      printf("Parallel read benchmark\n");
+      for(i=1; i<=gNumReadThreads; i++)
+      {
+         printf("  %2d thread(s) => %.0f reads/s \t [scaling: %.2f]\n", i, gReadsPerSecondMt[i], gReadsPerSecondMt[i]/gReadsPerSecondMt[1]);
+      }
+   }
+   else
+   {
+      printf("Parallel read benchmark - not activated.\n");
+   }
+   printf("==================================================================================\n");
    if(doWrite == 1)
    {
       printf("Write benchmark\n");
@@ -400,6 +698,32 @@ int main(int argc, char *argv[])
       printf("Write benchmark - not activated.\n");
    }
    printf("==================================================================================\n");
+   if(doPathKey == 1)
+   {
+      printf("Database path and key creation benchmark\n");
+      printf("  snprintf  => %.1f ns per call\n", gDurationPathKeySnprintf);
+      printf("  templates => %.1f ns per call \t [speedup: %.2f]\n", gDurationPathKeyTemplate, gDurationPathKeySnprintf/gDurationPathKeyTemplate);
+   }
+   else
+   {
+      printf("Database path and key creation benchmark - not activated.\n");
+   }
+   printf("==================================================================================\n");
+   if(doCommand == 1)
+   {
+      int i = 0;
+      printf("Mainloop command benchmark\n");
+      for(i=1; i<=gNumCommandThreads; i++)
+      {
+         printf("  %2d thread(s) => %.0f commands/s \t [scaling: %.2f - ring full: %lld]\n", i, gCommandsPerSecondMt[i],
+                gCommandsPerSecondMt[i]/gCommandsPerSecondMt[1], gCommandRetriesMt[i]);
+      }
+   }
+   else
+   {
+      printf("Mainloop command benchmark - not activated.\n");
+   }
+   printf("==================================================================================\n");
 
    // unregister debug log and trace
    DLT_UNREGISTER_APP();
@@ -40,6 +40,7 @@
 #include "../include/persistence_client_library_key.h"
 #include "../include/persistence_client_library.h"
 #include "../include/persistence_client_library_error_def.h"
+#include "../src/persistence_client_library_prct_access.h"
 
 //#define SKIP_MULTITHREADED_TESTS 1
 
@@ -191,6 +192,1261 @@ START_TEST(test_GetData)
 END_TEST
 
 
+
+/**
+ * Test the batch key value interface: read several keys stored in different databases at once,
+ * write several keys at once and check the per key status.
+ */
+START_TEST(test_KeyBatch)
+{
+   int ret = 0;
+   unsigned char buffer[4][READ_SIZE];
+   pclKeyBatchItem_s items[4];
+   const char* batchWrite1 = "BATCH_ first value";
+   const char* batchWrite2 = "BATCH_ second value";
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_KeyBatch"));
+
+   memset(buffer, 0, sizeof(buffer));
+   memset(items, 0, sizeof(items));
+
+   items[0].ldbid = PCL_LDBID_LOCAL; items[0].resource_id = "pos/last_position";    items[0].user_no = 1; items[0].seat_no = 1;
+   items[1].ldbid = 0x20;            items[1].resource_id = "address/home_address"; items[1].user_no = 4; items[1].seat_no = 0;
+   items[2].ldbid = PCL_LDBID_LOCAL; items[2].resource_id = "pos/last_satellites";  items[2].user_no = 0; items[2].seat_no = 0;
+   items[3].ldbid = PCL_LDBID_LOCAL; items[3].resource_id = "key/does/not/exist";   items[3].user_no = 0; items[3].seat_no = 0;
+   for(ret = 0; ret < 4; ret++)
+   {
+      items[ret].buffer = buffer[ret];
+      items[ret].buffer_size = READ_SIZE;
+   }
+
+   ret = pclKeyReadBatch(items, 4);
+   ck_assert_int_eq(ret, 3);
+   ck_assert_str_eq( (char*)buffer[0], "CACHE_ +48 10' 38.95, +8 44' 39.06");
+   ck_assert_int_eq(items[0].status, (int)strlen("CACHE_ +48 10' 38.95, +8 44' 39.06"));
+   ck_assert_str_eq( (char*)buffer[1], "WT_ 55327 Heimatstadt, Wohnstrasse 31");
+   ck_assert_int_eq(items[1].status, (int)strlen("WT_ 55327 Heimatstadt, Wohnstrasse 31"));
+   ck_assert_str_eq( (char*)buffer[2], "WT_ 17");
+   ck_assert_int_eq(items[2].status, (int)strlen("WT_ 17"));
+   fail_unless(items[3].status < 0, "Read of a not existing key must fail");
+
+   memset(items, 0, sizeof(items));
+   items[0].ldbid = PCL_LDBID_LOCAL; items[0].resource_id = "batch/key_1"; items[0].user_no = 1; items[0].seat_no = 2;
+   items[0].buffer = (unsigned char*)batchWrite1; items[0].buffer_size = (int)strlen(batchWrite1);
+   items[1].ldbid = PCL_LDBID_LOCAL; items[1].resource_id = "batch/key_2"; items[1].user_no = 1; items[1].seat_no = 2;
+   items[1].buffer = (unsigned char*)batchWrite2; items[1].buffer_size = (int)strlen(batchWrite2);
+
+   ret = pclKeyWriteBatch(items, 2);
+   ck_assert_int_eq(ret, 2);
+   ck_assert_int_eq(items[0].status, (int)strlen(batchWrite1));
+   ck_assert_int_eq(items[1].status, (int)strlen(batchWrite2));
+
+   memset(buffer, 0, sizeof(buffer));
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "batch/key_2", 1, 2, buffer[0], READ_SIZE);
+   ck_assert_str_eq( (char*)buffer[0], batchWrite2);
+   ck_assert_int_eq(ret, (int)strlen(batchWrite2));
+}
+END_TEST
+
+
+
+/**
+ * Test key transactions: staged data is written on commit only and discarded on abort.
+ */
+START_TEST(test_KeyTransaction)
+{
+   int ret = 0, transaction = 0;
+   unsigned char buffer[READ_SIZE] = {0};
+   const char* profileVolume  = "TRANSACTION_ volume 12";
+   const char* profileBalance = "TRANSACTION_ balance -3";
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_KeyTransaction"));
+
+   (void)pclKeyDelete(PCL_LDBID_LOCAL, "profile/balance", 1, 2);     // remove data of a previous test run
+
+   transaction = pclKeyTransactionBegin(PCL_LDBID_LOCAL, 1, 2);
+   fail_unless(transaction >= 0, "Failed to begin transaction");
+
+   ret = pclKeyTransactionWrite(transaction, "profile/volume", (unsigned char*)profileVolume, (int)strlen(profileVolume));
+   ck_assert_int_eq(ret, (int)strlen(profileVolume));
+   ret = pclKeyTransactionWrite(transaction, "profile/balance", (unsigned char*)profileBalance, (int)strlen(profileBalance));
+   ck_assert_int_eq(ret, (int)strlen(profileBalance));
+
+   // not yet committed
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "profile/balance", 1, 2, buffer, READ_SIZE);
+   fail_unless(ret < 0, "Staged data must not be visible before commit");
+
+   ret = pclKeyTransactionCommit(transaction);
+   ck_assert_int_eq(ret, 2);
+
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "profile/volume", 1, 2, buffer, READ_SIZE);
+   ck_assert_str_eq( (char*)buffer, profileVolume);
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "profile/balance", 1, 2, buffer, READ_SIZE);
+   ck_assert_str_eq( (char*)buffer, profileBalance);
+
+   // the transaction has been finished by the commit
+   ret = pclKeyTransactionCommit(transaction);
+   ck_assert_int_eq(ret, EPERS_MAXHANDLE);
+
+   transaction = pclKeyTransactionBegin(PCL_LDBID_LOCAL, 1, 2);
+   fail_unless(transaction >= 0, "Failed to begin transaction");
+   ret = pclKeyTransactionWrite(transaction, "profile/volume", (unsigned char*)"aborted", (int)strlen("aborted"));
+   ck_assert_int_eq(ret, (int)strlen("aborted"));
+   ret = pclKeyTransactionAbort(transaction);
+   ck_assert_int_eq(ret, 0);
+
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "profile/volume", 1, 2, buffer, READ_SIZE);
+   ck_assert_str_eq( (char*)buffer, profileVolume);
+}
+END_TEST
+
+
+
+static int gAsyncWriteCallbackCount = 0;
+static int gAsyncFlushInCallback = 0;
+
+static void asyncWriteCallback(unsigned int ldbid, const char* resource_id, unsigned int user_no, unsigned int seat_no, int result)
+{
+   (void)ldbid; (void)resource_id; (void)user_no; (void)seat_no;
+
+   gAsyncFlushInCallback = pclKeyWriteAsyncFlush();      // must not wait for the write being completed
+
+   if(result >= 0)
+   {
+      __sync_add_and_fetch(&gAsyncWriteCallbackCount, 1);
+   }
+}
+
+/**
+ * Test the asynchronous write interface: queued writes are written in order,
+ * completion is reported via callback and eventfd.
+ */
+START_TEST(test_KeyWriteAsync)
+{
+   int ret = 0, fd = -1;
+   uint64_t completed = 0;
+   unsigned char buffer[READ_SIZE] = {0};
+   pclKeyWriteAsyncStats_s stats;
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_KeyWriteAsync"));
+
+   gAsyncWriteCallbackCount = 0;
+   gAsyncFlushInCallback = 0;
+
+   fd = pclKeyWriteAsyncGetFd();
+   fail_unless(fd >= 0, "Failed to get async write fd");
+
+   ret = pclKeyWriteDataAsync(PCL_LDBID_LOCAL, "async/value", 1, 2, (unsigned char*)"ASYNC_ first", (int)strlen("ASYNC_ first"), asyncWriteCallback);
+   ck_assert_int_eq(ret, (int)strlen("ASYNC_ first"));
+   ret = pclKeyWriteDataAsync(PCL_LDBID_LOCAL, "async/value", 1, 2, (unsigned char*)"ASYNC_ second", (int)strlen("ASYNC_ second"), asyncWriteCallback);
+   ck_assert_int_eq(ret, (int)strlen("ASYNC_ second"));
+   ret = pclKeyWriteDataAsync(PCL_LDBID_LOCAL, "async/value", 1, 2, (unsigned char*)"ASYNC_ last", (int)strlen("ASYNC_ last"), asyncWriteCallback);
+   ck_assert_int_eq(ret, (int)strlen("ASYNC_ last"));
+
+   ret = pclKeyWriteAsyncFlush();
+   ck_assert_int_eq(ret, 0);
+   ck_assert_int_eq(gAsyncWriteCallbackCount, 3);
+   ck_assert_int_eq(gAsyncFlushInCallback, EPERS_COMMON);
+
+   ret = (int)read(fd, &completed, sizeof(completed));
+   ck_assert_int_eq(ret, (int)sizeof(completed));
+   ck_assert_int_eq((int)completed, 3);
+
+   // the writes have been done in order, the last one wins
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "async/value", 1, 2, buffer, READ_SIZE);
+   ck_assert_str_eq( (char*)buffer, "ASYNC_ last");
+
+   ret = pclKeyWriteAsyncGetStats(&stats);
+   ck_assert_int_eq(ret, 0);
+   ck_assert_int_eq(stats.queueDepth, 0);
+   fail_unless(stats.numCompleted == 3, "Wrong number of completed writes");
+   fail_unless(stats.maxQueueDepth >= 1, "Wrong max queue depth");
+}
+END_TEST
+
+
+
+/**
+ * Test the limit of open databases: idle databases are closed and opened again transparently,
+ * a database referred to by a key handle stays open.
+ */
+START_TEST(test_DbHandleEviction)
+{
+   int ret = 0, i = 0, handle = 0;
+   int shutdownReg = PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL;
+   unsigned char buffer[READ_SIZE] = {0};
+   const char* wtData = "WT_ /var/opt/user_manual_climateControl.pdf";
+   pclKeyDbHandleStats_s stats;
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_DbHandleEviction"));
+
+   // reinitialize the library with max one open database
+   pclDeinitLibrary();
+   setenv("PERS_CLIENT_LIB_MAX_OPEN_DB", "1", 1);
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+
+   ret = pclKeyGetDbHandleStats(&stats);
+   ck_assert_int_eq(ret, 0);
+   ck_assert_int_eq(stats.maxOpen, 1);
+
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "status/open_document", 3, 2, (unsigned char*)wtData, (int)strlen(wtData));
+   ck_assert_int_eq(ret, (int)strlen(wtData));
+
+   // alternate between the cached and the write through database
+   for(i = 0; i < 3; i++)
+   {
+      memset(buffer, 0, READ_SIZE);
+      ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+      ck_assert_str_eq((char*)buffer, "CACHE_ +48 10' 38.95, +8 44' 39.06");
+
+      memset(buffer, 0, READ_SIZE);
+      ret = pclKeyReadData(PCL_LDBID_LOCAL, "status/open_document", 3, 2, buffer, READ_SIZE);
+      ck_assert_str_eq((char*)buffer, wtData);
+   }
+
+   ret = pclKeyGetDbHandleStats(&stats);
+   ck_assert_int_eq(ret, 0);
+   ck_assert_int_eq(stats.numOpen, 1);
+   fail_unless(stats.numEvicted >= 5, "Idle databases have not been closed");
+   fail_unless(stats.numOpened == stats.numEvicted + 1, "Wrong number of opened databases");
+
+   // the database of an open key handle is not closed
+   handle = pclKeyHandleOpen(PCL_LDBID_LOCAL, "pos/last_position", 1, 1);
+   fail_unless(handle >= 0, "Failed to open key handle");
+
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "status/open_document", 3, 2, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, wtData);
+
+   ret = pclKeyGetDbHandleStats(&stats);
+   ck_assert_int_eq(stats.numOpen, 2);
+
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyHandleReadData(handle, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, "CACHE_ +48 10' 38.95, +8 44' 39.06");
+
+   ret = pclKeyHandleClose(handle);
+   ck_assert_int_eq(ret, 1);
+
+   pclDeinitLibrary();
+   unsetenv("PERS_CLIENT_LIB_MAX_OPEN_DB");
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+}
+END_TEST
+
+
+
+/**
+ * Test the database pins of a batch: a batch writing local and shared keys releases the pin of each
+ * database it used exactly once, so all databases are idle and can be closed afterwards.
+ */
+START_TEST(test_KeyBatchDbHandles)
+{
+   int ret = 0, i = 0;
+   int shutdownReg = PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL;
+   unsigned char buffer[READ_SIZE] = {0};
+   pclKeyBatchItem_s items[3];
+   pclKeyDbHandleStats_s stats;
+   const char* localData  = "BATCH_ local pinned value";
+   const char* sharedData = "BATCH_ shared pinned value";
+   const char* wtData     = "WT_ /var/opt/user_manual_batch.pdf";
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_KeyBatchDbHandles"));
+
+   // reinitialize the library with max one open database
+   pclDeinitLibrary();
+   setenv("PERS_CLIENT_LIB_MAX_OPEN_DB", "1", 1);
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+
+   // only the shared item is notified, the pins of the local items must be released as well
+   memset(items, 0, sizeof(items));
+   items[0].ldbid = PCL_LDBID_LOCAL; items[0].resource_id = "batch/key_1";          items[0].user_no = 1; items[0].seat_no = 2;
+   items[0].buffer = (unsigned char*)localData;  items[0].buffer_size = (int)strlen(localData);
+   items[1].ldbid = 0x20;            items[1].resource_id = "links/last_link2";     items[1].user_no = 2; items[1].seat_no = 1;
+   items[1].buffer = (unsigned char*)sharedData; items[1].buffer_size = (int)strlen(sharedData);
+   items[2].ldbid = PCL_LDBID_LOCAL; items[2].resource_id = "status/open_document"; items[2].user_no = 3; items[2].seat_no = 2;
+   items[2].buffer = (unsigned char*)wtData;     items[2].buffer_size = (int)strlen(wtData);
+
+   ret = pclKeyWriteBatch(items, 3);
+   ck_assert_int_eq(ret, 3);
+   ck_assert_int_eq(items[0].status, (int)strlen(localData));
+   ck_assert_int_eq(items[1].status, (int)strlen(sharedData));
+   ck_assert_int_eq(items[2].status, (int)strlen(wtData));
+
+   // alternate between the databases used by the batch, each of them must be closed when idle
+   for(i = 0; i < 2; i++)
+   {
+      memset(buffer, 0, READ_SIZE);
+      ret = pclKeyReadData(PCL_LDBID_LOCAL, "batch/key_1", 1, 2, buffer, READ_SIZE);
+      ck_assert_str_eq((char*)buffer, localData);
+
+      memset(buffer, 0, READ_SIZE);
+      ret = pclKeyReadData(0x20, "links/last_link2", 2, 1, buffer, READ_SIZE);
+      ck_assert_str_eq((char*)buffer, sharedData);
+
+      memset(buffer, 0, READ_SIZE);
+      ret = pclKeyReadData(PCL_LDBID_LOCAL, "status/open_document", 3, 2, buffer, READ_SIZE);
+      ck_assert_str_eq((char*)buffer, wtData);
+   }
+
+   ret = pclKeyGetDbHandleStats(&stats);
+   ck_assert_int_eq(ret, 0);
+   ck_assert_int_eq(stats.numOpen, 1);
+   fail_unless(stats.numOpened == stats.numEvicted + 1, "A database pin of the batch has been leaked");
+
+   pclDeinitLibrary();
+   unsetenv("PERS_CLIENT_LIB_MAX_OPEN_DB");
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+}
+END_TEST
+
+
+
+/**
+ * Test the unchanged write detection: writing a local key with the data it already holds doesn't access
+ * the database, changed data and repeated writes of shared keys are written.
+ */
+START_TEST(test_KeySkipUnchanged)
+{
+   int ret = 0, numOpened = 0;
+   int shutdownReg = PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL;
+   unsigned char buffer[READ_SIZE] = {0};
+   pclKeyDbHandleStats_s stats;
+   const char* wtData     = "WT_ /var/opt/user_manual_unchanged.pdf";
+   const char* wtDataNew  = "WT_ /var/opt/user_manual_changed.pdf";
+   const char* sharedData = "Shared unchanged data";
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_KeySkipUnchanged"));
+
+   // reinitialize the library with max one open database, a write accessing the database must open it again
+   pclDeinitLibrary();
+   setenv("PERS_CLIENT_LIB_MAX_OPEN_DB", "1", 1);
+   setenv("PERS_CLIENT_LIB_SKIP_UNCHANGED", "1", 1);
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "status/open_document", 3, 2, (unsigned char*)wtData, (int)strlen(wtData));
+   ck_assert_int_eq(ret, (int)strlen(wtData));
+
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, "CACHE_ +48 10' 38.95, +8 44' 39.06");
+
+   ret = pclKeyGetDbHandleStats(&stats);
+   ck_assert_int_eq(ret, 0);
+   numOpened = (int)stats.numOpened;
+
+   // the repeated write of a local key is skipped
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "status/open_document", 3, 2, (unsigned char*)wtData, (int)strlen(wtData));
+   ck_assert_int_eq(ret, (int)strlen(wtData));
+
+   ret = pclKeyGetDbHandleStats(&stats);
+   ck_assert_int_eq((int)stats.numOpened, numOpened);
+
+   // changed data is written
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "status/open_document", 3, 2, (unsigned char*)wtDataNew, (int)strlen(wtDataNew));
+   ck_assert_int_eq(ret, (int)strlen(wtDataNew));
+
+   ret = pclKeyGetDbHandleStats(&stats);
+   ck_assert_int_eq((int)stats.numOpened, numOpened + 1);
+
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "status/open_document", 3, 2, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, wtDataNew);
+
+   // a shared key can be changed by other applications, the repeated write is not skipped
+   ret = pclKeyWriteData(0x20, "links/last_link2", 2, 1, (unsigned char*)sharedData, (int)strlen(sharedData));
+   ck_assert_int_eq(ret, (int)strlen(sharedData));
+
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, "CACHE_ +48 10' 38.95, +8 44' 39.06");
+
+   ret = pclKeyGetDbHandleStats(&stats);
+   numOpened = (int)stats.numOpened;
+
+   ret = pclKeyWriteData(0x20, "links/last_link2", 2, 1, (unsigned char*)sharedData, (int)strlen(sharedData));
+   ck_assert_int_eq(ret, (int)strlen(sharedData));
+
+   ret = pclKeyGetDbHandleStats(&stats);
+   ck_assert_int_eq((int)stats.numOpened, numOpened + 1);
+
+   pclDeinitLibrary();
+   unsetenv("PERS_CLIENT_LIB_SKIP_UNCHANGED");
+   unsetenv("PERS_CLIENT_LIB_MAX_OPEN_DB");
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+}
+END_TEST
+
+
+
+/**
+ * Test the database prewarm: the databases used are stored at deinit and opened in advance on the next init.
+ */
+START_TEST(test_DbPrewarm)
+{
+   int ret = 0;
+   int shutdownReg = PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL;
+   unsigned char buffer[READ_SIZE] = {0};
+   const char* prewarmFile = "/Data/mnt-c/lt-persistence_client_library_test/PrewarmList.info";
+   pclKeyDbHandleStats_s stats;
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_DbPrewarm"));
+
+   pclDeinitLibrary();
+   remove(prewarmFile);
+   setenv("PERS_CLIENT_LIB_PREWARM", "0xFF", 1);
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, "CACHE_ +48 10' 38.95, +8 44' 39.06");
+
+   pclDeinitLibrary();
+   fail_unless(access(prewarmFile, F_OK) == 0, "Prewarm list has not been written");
+
+   // the databases are opened in advance, the data is the same
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, "CACHE_ +48 10' 38.95, +8 44' 39.06");
+
+   ret = pclKeyGetDbHandleStats(&stats);
+   ck_assert_int_eq(ret, 0);
+   fail_unless(stats.numOpen >= 1, "No open database");
+
+   pclDeinitLibrary();
+   unsetenv("PERS_CLIENT_LIB_PREWARM");
+   remove(prewarmFile);
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+}
+END_TEST
+
+
+
+/**
+ * Test the boot access manifest: the keys read after init are prefetched on the next init,
+ * a key changed after the prefetch is read from the database.
+ */
+START_TEST(test_BootManifest)
+{
+   int ret = 0, i = 0;
+   int shutdownReg = PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL;
+   unsigned char buffer[READ_SIZE] = {0};
+   const char* manifestFile = "/Data/mnt-c/lt-persistence_client_library_test/BootManifest.info";
+   const char* wtData = "WT_ /var/opt/user_manual_climateControl.pdf";
+   const char* wtDataNew = "WT_ /var/opt/user_manual_boot_manifest.pdf";
+   pclKeyBootManifestStats_s stats;
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_BootManifest"));
+
+   pclDeinitLibrary();
+   remove(manifestFile);
+   setenv("PERS_CLIENT_LIB_BOOT_MANIFEST", "60", 1);
+   setenv("PERS_CLIENT_LIB_READ_CACHE", "4096", 1);     // the values are prefetched into the read cache
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "status/open_document", 3, 2, (unsigned char*)wtData, (int)strlen(wtData));
+   ck_assert_int_eq(ret, (int)strlen(wtData));
+
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, "CACHE_ +48 10' 38.95, +8 44' 39.06");
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "status/open_document", 3, 2, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, wtData);
+
+   ret = pclKeyGetBootManifestStats(&stats);
+   ck_assert_int_eq(ret, 0);
+   ck_assert_int_eq(stats.windowSec, 60);
+   ck_assert_int_eq(stats.numRecorded, 2);
+   ck_assert_int_eq(stats.numPrefetched, 0);
+
+   pclDeinitLibrary();
+   fail_unless(access(manifestFile, F_OK) == 0, "Boot manifest has not been written");
+
+   // next start: both keys are prefetched
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+
+   for(i = 0; i < 100; i++)
+   {
+      ret = pclKeyGetBootManifestStats(&stats);
+      if(stats.numPrefetched == 2)
+      {
+         break;
+      }
+      usleep(10000);
+   }
+   ck_assert_int_eq(stats.numPrefetched, 2);
+
+   // a changed key is not served from its prefetched value
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "status/open_document", 3, 2, (unsigned char*)wtDataNew, (int)strlen(wtDataNew));
+   ck_assert_int_eq(ret, (int)strlen(wtDataNew));
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "status/open_document", 3, 2, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, wtDataNew);
+
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, "CACHE_ +48 10' 38.95, +8 44' 39.06");
+
+   ret = pclKeyGetBootManifestStats(&stats);
+   ck_assert_int_eq(stats.numHits, 1);
+   ck_assert_int_eq(stats.numMisses, 1);
+   ck_assert_int_eq(stats.numWasted, 1);
+
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "status/open_document", 3, 2, (unsigned char*)wtData, (int)strlen(wtData));
+   ck_assert_int_eq(ret, (int)strlen(wtData));
+
+   pclDeinitLibrary();
+
+   // without the read cache nothing is prefetched
+   unsetenv("PERS_CLIENT_LIB_READ_CACHE");
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+   usleep(100000);
+
+   ret = pclKeyGetBootManifestStats(&stats);
+   ck_assert_int_eq(ret, 0);
+   ck_assert_int_eq(stats.windowSec, 60);
+   ck_assert_int_eq(stats.numPrefetched, 0);
+
+   pclDeinitLibrary();
+   unsetenv("PERS_CLIENT_LIB_BOOT_MANIFEST");
+   remove(manifestFile);
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+}
+END_TEST
+
+
+
+/**
+ * Test the read cache: cached values follow writes and deletes.
+ */
+START_TEST(test_ReadCache)
+{
+   int ret = 0, i = 0;
+   int shutdownReg = PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL;
+   unsigned char buffer[READ_SIZE] = {0};
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_ReadCache"));
+
+   pclDeinitLibrary();
+   setenv("PERS_CLIENT_LIB_READ_CACHE", "4096", 1);
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "readcache/value", 1, 2, (unsigned char*)"READCACHE_ 1", (int)strlen("READCACHE_ 1"));
+   ck_assert_int_eq(ret, (int)strlen("READCACHE_ 1"));
+
+   for(i = 0; i < 2; i++)
+   {
+      memset(buffer, 0, READ_SIZE);
+      ret = pclKeyReadData(PCL_LDBID_LOCAL, "readcache/value", 1, 2, buffer, READ_SIZE);
+      ck_assert_int_eq(ret, (int)strlen("READCACHE_ 1"));
+      ck_assert_str_eq((char*)buffer, "READCACHE_ 1");
+   }
+
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "readcache/value", 1, 2, (unsigned char*)"READCACHE_ 22", (int)strlen("READCACHE_ 22"));
+   ck_assert_int_eq(ret, (int)strlen("READCACHE_ 22"));
+
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "readcache/value", 1, 2, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, "READCACHE_ 22");
+
+   ret = pclKeyDelete(PCL_LDBID_LOCAL, "readcache/value", 1, 2);
+   fail_unless(ret >= 0, "Failed to delete key");
+
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "readcache/value", 1, 2, buffer, READ_SIZE);
+   fail_unless(ret == EPERS_NOKEY, "Deleted key read from the cache");
+
+   pclDeinitLibrary();
+   unsetenv("PERS_CLIENT_LIB_READ_CACHE");
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+}
+END_TEST
+
+
+
+static unsigned int gRctLoadCount = 0;
+static pclRctLoadInfo_s gRctLoadInfo;
+
+static void rctLoadHook(const pclRctLoadInfo_s* info)
+{
+   if(info->ldbid == PCL_LDBID_LOCAL)
+   {
+      memcpy(&gRctLoadInfo, info, sizeof(pclRctLoadInfo_s));
+   }
+   gRctLoadCount++;
+}
+
+/**
+ * Test the in-memory resource configuration table index: the load is reported and resources are resolved.
+ */
+START_TEST(test_RctIndex)
+{
+   int ret = 0;
+   int shutdownReg = PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL;
+   unsigned char buffer[READ_SIZE] = {0};
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_RctIndex"));
+
+   pclDeinitLibrary();
+   gRctLoadCount = 0;
+   memset(&gRctLoadInfo, 0, sizeof(pclRctLoadInfo_s));
+   ret = pclSetRctLoadHook(rctLoadHook);
+   ck_assert_int_eq(ret, 0);
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, "CACHE_ +48 10' 38.95, +8 44' 39.06");
+
+   fail_unless(gRctLoadCount >= 1, "RCT load not reported");
+   fail_unless(gRctLoadInfo.numResources > 0, "RCT index is empty");
+   fail_unless(gRctLoadInfo.memSize > 0, "RCT index memory not reported");
+
+   // resources not in the RCT are still created as local keys
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "rctindex/not_in_rct", 1, 2, (unsigned char*)"RCTINDEX_", (int)strlen("RCTINDEX_"));
+   ck_assert_int_eq(ret, (int)strlen("RCTINDEX_"));
+
+   pclDeinitLibrary();
+   (void)pclSetRctLoadHook(NULL);
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+}
+END_TEST
+
+
+
+/**
+ * Test the precompiled resource configuration table index: an invalid index file is ignored,
+ * the table is loaded through the plugin.
+ */
+START_TEST(test_RctIndexFile)
+{
+   int ret = 0, fd = -1;
+   int shutdownReg = PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL;
+   unsigned char buffer[READ_SIZE] = {0};
+   char indexFile[READ_SIZE] = {0};
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_RctIndexFile"));
+
+   snprintf(indexFile, READ_SIZE, "/Data/mnt-wt/%s/resource-table-cfg.itz.idx", gTheAppId);
+   fd = open(indexFile, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+   fail_unless(fd != -1, "Failed to create index file");
+   ret = (int)write(fd, "PRIX-not-an-index", strlen("PRIX-not-an-index"));
+   ck_assert_int_eq(ret, (int)strlen("PRIX-not-an-index"));
+   close(fd);
+
+   pclDeinitLibrary();
+   gRctLoadCount = 0;
+   memset(&gRctLoadInfo, 0, sizeof(pclRctLoadInfo_s));
+   (void)pclSetRctLoadHook(rctLoadHook);
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, "CACHE_ +48 10' 38.95, +8 44' 39.06");
+
+   fail_unless(gRctLoadCount >= 1, "RCT load not reported");
+   ck_assert_int_eq(gRctLoadInfo.mapped, 0);
+   fail_unless(gRctLoadInfo.numResources > 0, "RCT not loaded through the plugin");
+
+   pclDeinitLibrary();
+   (void)pclSetRctLoadHook(NULL);
+   (void)remove(indexFile);
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+}
+END_TEST
+
+
+/**
+ * Test the negative cache: resources not in the RCT are resolved again and again,
+ * more than fit into the cache, local resources get the default configuration.
+ */
+START_TEST(test_RctNegativeCache)
+{
+   int ret = 0, i = 0, round = 0;
+   unsigned char buffer[READ_SIZE] = {0};
+   char key[READ_SIZE] = {0};
+   char value[READ_SIZE] = {0};
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_RctNegativeCache"));
+
+   for(round = 0; round < 2; round++)
+   {
+      for(i = 0; i < 300; i++)
+      {
+         snprintf(key, READ_SIZE, "negcache/key_%d", i);
+         snprintf(value, READ_SIZE, "NEGCACHE_ %d %d", round, i);
+
+         ret = pclKeyWriteData(PCL_LDBID_LOCAL, key, 1, 2, (unsigned char*)value, (int)strlen(value));
+         ck_assert_int_eq(ret, (int)strlen(value));
+
+         memset(buffer, 0, READ_SIZE);
+         ret = pclKeyReadData(PCL_LDBID_LOCAL, key, 1, 2, buffer, READ_SIZE);
+         ck_assert_int_eq(ret, (int)strlen(value));
+         ck_assert_str_eq((char*)buffer, value);
+
+         ret = pclKeyGetSize(PCL_LDBID_LOCAL, key, 1, 2);
+         ck_assert_int_eq(ret, (int)strlen(value));
+      }
+   }
+
+   // shared resources missing in the RCT are never created
+   for(round = 0; round < 3; round++)
+   {
+      ret = pclKeyReadData(0x20, "negcache/not_in_rct", 4, 0, buffer, READ_SIZE);
+      fail_unless(ret < 0, "Shared resource not in RCT found");
+      ret = pclKeyWriteData(0x20, "negcache/not_in_rct", 4, 0, (unsigned char*)"NEGCACHE_", (int)strlen("NEGCACHE_"));
+      fail_unless(ret < 0, "Shared resource not in RCT written");
+   }
+}
+END_TEST
+
+
+/// key prefix strings of the plugin (persistence_client_library_custom_loader.h)
+extern char* plugin_gNode;
+extern char* plugin_gUser;
+extern char* plugin_gSeat;
+
+/**
+ * @brief reference for get_db_path_and_key: the database key and path created with snprintf and the path formats
+ */
+static int ref_db_path_and_key(PersistenceInfo_s* dbContext, const char* appId, const char* resource_id, char dbKey[], char dbPath[])
+{
+   int storePolicy = PersistenceStorage_LastEntry;
+   unsigned int ldbid = dbContext->context.ldbid, user = dbContext->context.user_no, seat = dbContext->context.seat_no;
+   int isKey = (dbContext->configKey.type == PersistenceResourceType_key) ? 1 : 0;
+
+   if(((ldbid < 0x80) || (ldbid == PCL_LDBID_LOCAL)) && (NULL != dbKey))
+   {
+      if((user == 0) && (seat == 0))
+         snprintf(dbKey, PERS_DB_MAX_LENGTH_KEY_NAME, "%s/%s", plugin_gNode, resource_id);
+      else if(seat == 0)
+         snprintf(dbKey, PERS_DB_MAX_LENGTH_KEY_NAME, "%s%u/%s", plugin_gUser, user, resource_id);
+      else
+         snprintf(dbKey, PERS_DB_MAX_LENGTH_KEY_NAME, "%s%u%s%u/%s", plugin_gUser, user, plugin_gSeat, seat, resource_id);
+      storePolicy = PersistenceStorage_local;
+   }
+   if((ldbid >= 0x80) && (ldbid != PCL_LDBID_LOCAL) && (NULL != dbKey))
+   {
+      if(seat != 0)
+         snprintf(dbKey, PERS_DB_MAX_LENGTH_KEY_NAME, "/%x%s%u%s%u/%s", ldbid, plugin_gUser, user, plugin_gSeat, seat, resource_id);
+      else
+         snprintf(dbKey, PERS_DB_MAX_LENGTH_KEY_NAME, "/%x%s%u/%s", ldbid, plugin_gUser, user, resource_id);
+      storePolicy = PersistenceStorage_local;
+   }
+
+   if(ldbid < 0x80 && ldbid != PCL_LDBID_PUBLIC)
+   {
+      if(PersistencePolicy_wc == dbContext->configKey.policy)
+         snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, isKey ? getSharedCachePath() : getSharedCachePathKey(), appId, ldbid, isKey ? "" : dbKey);
+      else if(PersistencePolicy_wt == dbContext->configKey.policy)
+         snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, isKey ? getSharedWtPath() : getSharedWtPathKey(), appId, ldbid, isKey ? "" : dbKey);
+      storePolicy = PersistenceStorage_shared;
+   }
+   else if(ldbid < 0x80)
+   {
+      if(PersistencePolicy_wc == dbContext->configKey.policy)
+         snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, isKey ? getSharedPublicCachePath() : getSharedPublicCachePathKey(), appId, isKey ? "" : dbKey);
+      else if(PersistencePolicy_wt == dbContext->configKey.policy)
+         snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, isKey ? getSharedPublicWtPath() : getSharedPublicWtPathKey(), appId, isKey ? "" : dbKey);
+      storePolicy = PersistenceStorage_shared;
+   }
+   else
+   {
+      if(PersistencePolicy_wc == dbContext->configKey.policy)
+         snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME, isKey ? getLocalCachePath() : getLocalCachePathKey(), appId, isKey ? "" : dbKey);
+      else if(PersistencePolicy_wt == dbContext->configKey.policy)
+         snprintf(dbPath, PERS_ORG_MAX_LENGTH_PATH_FILENAME-1, isKey ? getLocalWtPath() : getLocalWtPathKey(), appId, isKey ? "" : dbKey);
+      storePolicy = PersistenceStorage_local;
+   }
+
+   return storePolicy;
+}
+
+/**
+ * Test the precompiled database path templates: key, path and return value are byte identical
+ * to the snprintf based creation for all ldbid ranges, users, seats, policies, types and truncated keys.
+ */
+START_TEST(test_DbPathKeyTemplates)
+{
+   unsigned int ldbids[] = {PCL_LDBID_PUBLIC, 0x01, 0x20, 0x7F, 0x80, 0x84, 0xFE, PCL_LDBID_LOCAL, 0xFFFFFFFF};
+   unsigned int users[]  = {0, 3, 0xFFFFFFFF};
+   unsigned int seats[]  = {0, 2, 77};
+   PersistencePolicy_e policies[] = {PersistencePolicy_wc, PersistencePolicy_wt, PersistencePolicy_na};
+   PersistenceResourceType_e types[] = {PersistenceResourceType_key, PersistenceResourceType_file};
+   char longId[PERS_ORG_MAX_LENGTH_PATH_FILENAME + 64] = {0};
+   const char* resources[] = {"pos/last_position", "", longId};
+   unsigned int a = 0, u = 0, se = 0, p = 0, t = 0, r = 0, numCases = 0;
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_DbPathKeyTemplates"));
+
+   memset(longId, 'r', sizeof(longId) - 1);
+
+   for(a = 0; a < sizeof(ldbids)/sizeof(ldbids[0]); a++)
+   for(u = 0; u < sizeof(users)/sizeof(users[0]); u++)
+   for(se = 0; se < sizeof(seats)/sizeof(seats[0]); se++)
+   for(p = 0; p < sizeof(policies)/sizeof(policies[0]); p++)
+   for(t = 0; t < sizeof(types)/sizeof(types[0]); t++)
+   for(r = 0; r < sizeof(resources)/sizeof(resources[0]); r++)
+   {
+      PersistenceInfo_s info, refInfo;
+      char dbKey[PERS_DB_MAX_LENGTH_KEY_NAME], refKey[PERS_DB_MAX_LENGTH_KEY_NAME];
+      char dbPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME], refPath[PERS_ORG_MAX_LENGTH_PATH_FILENAME];
+      int ret = 0, refRet = 0;
+
+      memset(&info, 0, sizeof(PersistenceInfo_s));
+      info.context.ldbid     = ldbids[a];
+      info.context.user_no   = users[u];
+      info.context.seat_no   = seats[se];
+      info.configKey.policy  = policies[p];
+      info.configKey.type    = types[t];
+      memcpy(&refInfo, &info, sizeof(PersistenceInfo_s));
+
+      // bytes not written must stay untouched as well
+      memset(dbKey, '#', sizeof(dbKey));
+      memset(refKey, '#', sizeof(refKey));
+      memset(dbPath, '#', sizeof(dbPath));
+      memset(refPath, '#', sizeof(refPath));
+
+      ret    = get_db_path_and_key(&info, resources[r], dbKey, dbPath);
+      refRet = ref_db_path_and_key(&refInfo, gTheAppId, resources[r], refKey, refPath);
+
+      ck_assert_int_eq(ret, refRet);
+      fail_unless(0 == memcmp(dbKey, refKey, sizeof(dbKey)), "Key differs");
+      fail_unless(0 == memcmp(dbPath, refPath, sizeof(dbPath)), "Path differs");
+
+      // without key: only the database path is created
+      if(types[t] == PersistenceResourceType_key)
+      {
+         memset(dbPath, '#', sizeof(dbPath));
+         memset(refPath, '#', sizeof(refPath));
+         ret    = get_db_path_and_key(&info, resources[r], NULL, dbPath);
+         refRet = ref_db_path_and_key(&refInfo, gTheAppId, resources[r], NULL, refPath);
+         ck_assert_int_eq(ret, refRet);
+         fail_unless(0 == memcmp(dbPath, refPath, sizeof(dbPath)), "Path without key differs");
+      }
+      numCases++;
+   }
+
+   fail_unless(numCases > 0, "No case tested");
+}
+END_TEST
+
+
+#define NUM_TLS_THREADS 4
+
+static void* tlsReadThread(void* userData)
+{
+   int i = 0, ret = 0, errors = 0;
+   unsigned char buffer[READ_SIZE] = {0};
+
+   (void)userData;
+
+   for(i = 0; i < 1000; i++)
+   {
+      memset(buffer, 0, READ_SIZE);
+      ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+      if(ret != (int)strlen("CACHE_ +48 10' 38.95, +8 44' 39.06") || strcmp((char*)buffer, "CACHE_ +48 10' 38.95, +8 44' 39.06") != 0)
+      {
+         errors++;
+      }
+
+      memset(buffer, 0, READ_SIZE);
+      (void)pclKeyReadData(0x20, "links/last_link", 2, 0, buffer, READ_SIZE);
+      if(strcmp((char*)buffer, "CACHE_ /last_exit/queens") != 0)
+      {
+         errors++;
+      }
+   }
+
+   return (void*)(long)errors;
+}
+
+/**
+ * Test the thread local resolution cache: threads reading the same keys get the right values,
+ * resources resolved by a thread are not used any more after pclDeinitLibrary.
+ */
+START_TEST(test_TlsResolvedCache)
+{
+   int ret = 0, i = 0;
+   int shutdownReg = PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL;
+   unsigned char buffer[READ_SIZE] = {0};
+   pthread_t threads[NUM_TLS_THREADS];
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_TlsResolvedCache"));
+
+   for(i = 0; i < NUM_TLS_THREADS; i++)
+   {
+      ret = pthread_create(&threads[i], NULL, tlsReadThread, NULL);
+      ck_assert_int_eq(ret, 0);
+   }
+   for(i = 0; i < NUM_TLS_THREADS; i++)
+   {
+      void* errors = NULL;
+
+      pthread_join(threads[i], &errors);
+      ck_assert_int_eq((int)(long)errors, 0);
+   }
+
+   // resolved by this thread for the test application
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, "CACHE_ +48 10' 38.95, +8 44' 39.06");
+
+   // another application: the resource must be resolved again, it is not in the databases of this application
+   pclDeinitLibrary();
+   (void)pclInitLibrary("tlsResolvedCacheApp", shutdownReg);
+
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   fail_unless(ret < 0, "Resource resolved for the previous application used");
+
+   pclDeinitLibrary();
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, "CACHE_ +48 10' 38.95, +8 44' 39.06");
+}
+END_TEST
+
+
+START_TEST(test_NotificationQueue)
+{
+   int ret = 0, i = 0;
+   int shutdownReg = PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL;
+   char data[READ_SIZE] = {0};
+   unsigned char buffer[READ_SIZE] = {0};
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_NotificationQueue"));
+
+   // more writes than the notification queue can hold, the writer must wait for free entries
+   for(i = 0; i < 600; i++)
+   {
+      snprintf(data, READ_SIZE, "Notification queue data %d", i);
+      ret = pclKeyWriteData(0x20, "links/last_link2", 2, 1, (unsigned char*)data, (int)strlen(data));
+      ck_assert_int_eq(ret, (int)strlen(data));
+   }
+
+   ret = pclKeyNotificationFlush();
+   ck_assert_int_eq(ret, 0);
+
+   ret = pclKeyNotificationFlush();     // nothing queued
+   ck_assert_int_eq(ret, 0);
+
+   ret = pclKeyReadData(0x20, "links/last_link2", 2, 1, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, "Notification queue data 599");
+
+   // queued notifications are sent before the library is deinitialized
+   ret = pclKeyWriteData(0x20, "links/last_link2", 2, 1, (unsigned char*)"Notification queue deinit", (int)strlen("Notification queue deinit"));
+   ck_assert_int_eq(ret, (int)strlen("Notification queue deinit"));
+   pclDeinitLibrary();
+
+   ret = pclKeyNotificationFlush();
+   ck_assert_int_eq(ret, EPERS_NOT_INITIALIZED);
+
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+}
+END_TEST
+
+
+START_TEST(test_NotifyCoalescing)
+{
+   int ret = 0, i = 0;
+   char data[READ_SIZE] = {0};
+   pclKeyNotifyStats_s stats;
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_NotifyCoalescing"));
+
+   ret = pclKeySetNotifyCoalescing(0x20, NULL, 10000);
+   ck_assert_int_eq(ret, 0);
+   ret = pclKeySetNotifyCoalescing(0x20, "links/last_link3", 0);     // every change of this resource is notified
+   ck_assert_int_eq(ret, 0);
+
+   ret = pclKeyGetNotifyStats(&stats);
+   ck_assert_int_eq(ret, 0);
+   ck_assert_int_eq((int)stats.numSuppressed, 0);
+
+   // the first change is notified, the second one is held back, the others are merged into it
+   for(i = 0; i < 20; i++)
+   {
+      snprintf(data, READ_SIZE, "Coalesced data %d", i);
+      ret = pclKeyWriteData(0x20, "links/last_link2", 2, 1, (unsigned char*)data, (int)strlen(data));
+      ck_assert_int_eq(ret, (int)strlen(data));
+   }
+   for(i = 0; i < 5; i++)
+   {
+      snprintf(data, READ_SIZE, "Not coalesced data %d", i);
+      ret = pclKeyWriteData(0x20, "links/last_link3", 3, 2, (unsigned char*)data, (int)strlen(data));
+      ck_assert_int_eq(ret, (int)strlen(data));
+   }
+
+   ret = pclKeyGetNotifyStats(&stats);
+   ck_assert_int_eq(ret, 0);
+   ck_assert_int_eq((int)stats.numQueued, 25);
+   ck_assert_int_eq((int)stats.numSuppressed, 18);
+   ck_assert_int_eq((int)stats.numPending, 1);
+
+   // without a window the change must not overtake the held back notification, it is merged and sent at once
+   ret = pclKeySetNotifyCoalescing(0x20, "links/last_link2", 0);
+   ck_assert_int_eq(ret, 0);
+   ret = pclKeyWriteData(0x20, "links/last_link2", 2, 1, (unsigned char*)"Uncoalesced data", (int)strlen("Uncoalesced data"));
+   ck_assert_int_eq(ret, (int)strlen("Uncoalesced data"));
+
+   for(i = 0; i < 100; i++)
+   {
+      ret = pclKeyGetNotifyStats(&stats);
+      ck_assert_int_eq(ret, 0);
+      if(stats.numPending == 0 && stats.queueDepth == 0)
+      {
+         break;
+      }
+      usleep(10 * 1000);
+   }
+   ck_assert_int_eq((int)stats.numQueued, 26);
+   ck_assert_int_eq((int)stats.numSuppressed, 19);
+   ck_assert_int_eq((int)stats.numPending, 0);
+
+   // nothing is held back anymore, the flush returns at once
+   ret = pclKeyNotificationFlush();
+   ck_assert_int_eq(ret, 0);
+
+   ret = pclKeyGetNotifyStats(&stats);
+   ck_assert_int_eq(ret, 0);
+   ck_assert_int_eq((int)stats.numPending, 0);
+   ck_assert_int_eq((int)stats.queueDepth, 0);
+   ck_assert_int_eq((int)stats.numSent, 7);
+
+   ret = pclKeyGetNotifyStats(NULL);
+   ck_assert_int_eq(ret, EPERS_COMMON);
+}
+END_TEST
+
+
+/// number of change notifications received by myBatchChangeCallback
+static int gBatchCallbackCount = 0;
+
+static int myBatchChangeCallback(pclNotification_s * notifyStruct)
+{
+   (void)notifyStruct;
+   (void)__sync_add_and_fetch(&gBatchCallbackCount, 1);
+   return 1;
+}
+
+/// wait until the expected number of change notifications has been received, further ones are waited for a short time
+static int waitBatchCallbacks(int expected)
+{
+   int waitMs = 0;
+
+   while(__sync_add_and_fetch(&gBatchCallbackCount, 0) < expected && waitMs < 2000)
+   {
+      usleep(10 * 1000);
+      waitMs += 10;
+   }
+   usleep(100 * 1000);
+
+   return __sync_add_and_fetch(&gBatchCallbackCount, 0);
+}
+
+START_TEST(test_NotifyBatchSignal)
+{
+   int ret = 0, i = 0;
+   int shutdownReg = PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL;
+   pclKeyBatchItem_s items[3];
+   pclKeyNotifyStats_s stats;
+   const char* batchData = "Batched notification data";
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_NotifyBatchSignal"));
+
+   setenv("PERS_CLIENT_LIB_NOTIFY_BATCH", "1", 1);
+   pclDeinitLibrary();
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+
+   memset(items, 0, sizeof(items));
+   items[0].ldbid = 0x20; items[0].resource_id = "links/last_link2"; items[0].user_no = 2; items[0].seat_no = 1;
+   items[1].ldbid = 0x20; items[1].resource_id = "links/last_link3"; items[1].user_no = 3; items[1].seat_no = 2;
+   items[2].ldbid = 0x20; items[2].resource_id = "links/last_link4"; items[2].user_no = 4; items[2].seat_no = 1;
+   for(i = 0; i < 3; i++)
+   {
+      items[i].buffer = (unsigned char*)batchData;
+      items[i].buffer_size = (int)strlen(batchData);
+
+      ret = pclKeyRegisterNotifyOnChange(items[i].ldbid, items[i].resource_id, items[i].user_no, items[i].seat_no, myBatchChangeCallback);
+      ck_assert_int_eq(ret, 0);
+   }
+   gBatchCallbackCount = 0;
+
+   // the notifications of the batch are queued at once and sent as one signal
+   ret = pclKeyWriteBatch(items, 3);
+   ck_assert_int_eq(ret, 3);
+
+   ret = pclKeyNotificationFlush();
+   ck_assert_int_eq(ret, 0);
+
+   ret = pclKeyGetNotifyStats(&stats);
+   ck_assert_int_eq(ret, 0);
+   ck_assert_int_eq((int)stats.numSent, 3);
+   ck_assert_int_eq((int)stats.numBatchSignals, 1);
+
+   // the callback is called once per entry of the batch, the per key signals sent along are not delivered again
+   ck_assert_int_eq(waitBatchCallbacks(3), 3);
+
+   // a single notification is sent with the per key signal
+   ret = pclKeyWriteData(0x20, "links/last_link2", 2, 1, (unsigned char*)batchData, (int)strlen(batchData));
+   ck_assert_int_eq(ret, (int)strlen(batchData));
+
+   ret = pclKeyNotificationFlush();
+   ck_assert_int_eq(ret, 0);
+
+   ret = pclKeyGetNotifyStats(&stats);
+   ck_assert_int_eq(ret, 0);
+   ck_assert_int_eq((int)stats.numSent, 4);
+   ck_assert_int_eq((int)stats.numBatchSignals, 1);
+   ck_assert_int_eq(waitBatchCallbacks(4), 4);
+
+   for(i = 0; i < 3; i++)
+   {
+      ret = pclKeyUnRegisterNotifyOnChange(items[i].ldbid, items[i].resource_id, items[i].user_no, items[i].seat_no, myBatchChangeCallback);
+      ck_assert_int_eq(ret, 0);
+   }
+
+   unsetenv("PERS_CLIENT_LIB_NOTIFY_BATCH");
+   pclDeinitLibrary();
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+}
+END_TEST
+
+
+#define NUM_GROUP_THREADS 8
+
+/// number of wrong values read by the group threads
+static int gGroupErrors[NUM_GROUP_THREADS] = {0};
+
+static void* groupThread(void* userData)
+{
+   int id = *(int*)userData;
+   int i = 0, ret = 0;
+   unsigned char buffer[READ_SIZE] = {0};
+
+   for(i = 0; i < 0x7F; i++)
+   {
+      unsigned int ldbid = (unsigned int)((i + id * 16) % 0x7F) + 1;     // all groups, every thread in a different order
+
+      memset(buffer, 0, READ_SIZE);
+      ret = pclKeyReadData(ldbid, "address/home_address", 4, 0, buffer, READ_SIZE);
+      if(ldbid == 0x20)
+      {
+         if(strcmp((char*)buffer, "WT_ 55327 Heimatstadt, Wohnstrasse 31") != 0)
+         {
+            gGroupErrors[id]++;
+         }
+      }
+      else if(ret >= 0 && strcmp((char*)buffer, "WT_ 55327 Heimatstadt, Wohnstrasse 31") == 0)
+      {
+         gGroupErrors[id]++;      // resource of group 0x20 found in another group
+      }
+
+      memset(buffer, 0, READ_SIZE);
+      (void)pclKeyReadData(PCL_LDBID_LOCAL, "pos/last_position", 1, 1, buffer, READ_SIZE);
+      if(strcmp((char*)buffer, "CACHE_ +48 10' 38.95, +8 44' 39.06") != 0)
+      {
+         gGroupErrors[id]++;
+      }
+   }
+
+   return NULL;
+}
+
+/**
+ * Test the resource configuration tables of many groups opened at once:
+ * every group gets its own table, local and group resources are resolved from the right table.
+ */
+START_TEST(test_RctManyGroups)
+{
+   int ret = 0, i = 0;
+   int shutdownReg = PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL;
+   unsigned char buffer[READ_SIZE] = {0};
+   pthread_t threads[NUM_GROUP_THREADS];
+   int threadId[NUM_GROUP_THREADS];
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_RctManyGroups"));
+
+   pclDeinitLibrary();
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+
+   for(i = 0; i < NUM_GROUP_THREADS; i++)
+   {
+      threadId[i] = i;
+      gGroupErrors[i] = 0;
+      ret = pthread_create(&threads[i], NULL, groupThread, &threadId[i]);
+      ck_assert_int_eq(ret, 0);
+   }
+   for(i = 0; i < NUM_GROUP_THREADS; i++)
+   {
+      pthread_join(threads[i], NULL);
+      ck_assert_int_eq(gGroupErrors[i], 0);
+   }
+
+   ret = pclKeyReadData(0x20, "links/last_link", 2, 0, buffer, READ_SIZE);
+   ck_assert_str_eq((char*)buffer, "CACHE_ /last_exit/queens");
+}
+END_TEST
+
+
+/**
+ * Test the key iterator: enumerate all keys with a given prefix in chunks, with and without values.
+ */
+START_TEST(test_KeyIterate)
+{
+   int ret = 0, iterator = 0, i = 0, numFound = 0, numKeys = 0;
+   unsigned char values[READ_SIZE] = {0};
+   pclKeyIterateItem_s items[2];
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_KeyIterate"));
+
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "iterate/a", 1, 2, (unsigned char*)"ITERATE_ a", (int)strlen("ITERATE_ a"));
+   ck_assert_int_eq(ret, (int)strlen("ITERATE_ a"));
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "iterate/b", 1, 2, (unsigned char*)"ITERATE_ b", (int)strlen("ITERATE_ b"));
+   ck_assert_int_eq(ret, (int)strlen("ITERATE_ b"));
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "iterate/c", 1, 2, (unsigned char*)"ITERATE_ c", (int)strlen("ITERATE_ c"));
+   ck_assert_int_eq(ret, (int)strlen("ITERATE_ c"));
+
+   iterator = pclKeyIterateBegin(PCL_LDBID_LOCAL, 1, 2, "iterate/");
+   fail_unless(iterator >= 0, "Failed to begin iteration");
+
+   // chunks of max 2 keys with values
+   while((ret = pclKeyIterateNext(iterator, items, 2, values, READ_SIZE)) > 0)
+   {
+      fail_unless(ret <= 2, "Chunk too large");
+      for(i = 0; i < ret; i++)
+      {
+         fail_unless(0 == strncmp(items[i].resource_id, "iterate/", strlen("iterate/")), "Key does not match prefix");
+         ck_assert_int_eq(items[i].value_size, (int)strlen("ITERATE_ a"));
+         fail_unless(0 == memcmp(items[i].value, "ITERATE_ ", strlen("ITERATE_ ")), "Wrong value");
+         fail_unless(items[i].value[strlen("ITERATE_ ")] == (unsigned char)items[i].resource_id[strlen("iterate/")], "Value does not belong to key");
+         numFound++;
+      }
+   }
+   ck_assert_int_eq(ret, 0);
+   ck_assert_int_eq(numFound, 3);
+
+   ret = pclKeyIterateEnd(iterator);
+   ck_assert_int_eq(ret, 0);
+   ret = pclKeyIterateEnd(iterator);
+   ck_assert_int_eq(ret, EPERS_MAXHANDLE);
+
+   // without values
+   iterator = pclKeyIterateBegin(PCL_LDBID_LOCAL, 1, 2, "iterate/");
+   fail_unless(iterator >= 0, "Failed to begin iteration");
+   while((ret = pclKeyIterateNext(iterator, items, 2, NULL, 0)) > 0)
+   {
+      numKeys += ret;
+   }
+   ck_assert_int_eq(numKeys, 3);
+   (void)pclKeyIterateEnd(iterator);
+}
+END_TEST
+
+
 /**
  * Test the key value  h a n d l e  interface using different logicalDB id's, users and seats
  * Each resource below has an entry in the resource configuration table where
@@ -754,6 +2010,43 @@ END_TEST
 
 
 
+/**
+ * Test the key filter of the default databases: a configurable default written at runtime is found
+ * after the filter of the database has been built, a key without any data is still reported as missing.
+ */
+START_TEST(test_DefaultKeyFilter)
+{
+   int ret = 0;
+   int shutdownReg = PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL;
+   unsigned char buffer[READ_SIZE] = {0};
+   const char* confDefault = "CONF_DEFAULT_ written at runtime";
+
+   DLT_LOG(gPcltDLTContext, DLT_LOG_INFO, DLT_STRING("PCL_TEST test_DefaultKeyFilter"));
+
+   // start with closed databases, the filters are built when the default databases are opened
+   pclDeinitLibrary();
+   (void)pclInitLibrary(gTheAppId, shutdownReg);
+
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "addressHandle/home_address", 1, 2, buffer, READ_SIZE);
+   ck_assert_int_eq(ret, EPERS_NOKEY);
+
+   ret = pclKeyWriteData(PCL_LDBID_LOCAL, "languageHandle/current_language", PCL_USER_DEFAULTDATA, 0,
+                         (unsigned char*)confDefault, (int)strlen(confDefault));
+   ck_assert_int_eq(ret, (int)strlen(confDefault));
+
+   // the user has no data of its own, the new configurable default is returned
+   memset(buffer, 0, READ_SIZE);
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "languageHandle/current_language", 3, 2, buffer, READ_SIZE);
+   ck_assert_int_eq(ret, (int)strlen(confDefault));
+   ck_assert_str_eq((char*)buffer, confDefault);
+
+   ret = pclKeyReadData(PCL_LDBID_LOCAL, "addressHandle/home_address", 1, 2, buffer, READ_SIZE);
+   ck_assert_int_eq(ret, EPERS_NOKEY);
+}
+END_TEST
+
+
+
 START_TEST(test_InitDeinit)
 {
    int shutdownReg = PCL_SHUTDOWN_TYPE_FAST | PCL_SHUTDOWN_TYPE_NORMAL;
@@ -1804,6 +3097,82 @@ static Suite * persistenceClientLib_suite()
    tcase_add_test(tc_persGetData, test_GetData);
    tcase_set_timeout(tc_persGetData, 3);
 
+   TCase * tc_persKeyBatch = tcase_create("KeyBatch");
+   tcase_add_test(tc_persKeyBatch, test_KeyBatch);
+   tcase_set_timeout(tc_persKeyBatch, 3);
+
+   TCase * tc_persKeyTransaction = tcase_create("KeyTransaction");
+   tcase_add_test(tc_persKeyTransaction, test_KeyTransaction);
+   tcase_set_timeout(tc_persKeyTransaction, 3);
+
+   TCase * tc_persKeyWriteAsync = tcase_create("KeyWriteAsync");
+   tcase_add_test(tc_persKeyWriteAsync, test_KeyWriteAsync);
+   tcase_set_timeout(tc_persKeyWriteAsync, 3);
+
+   TCase * tc_persKeyIterate = tcase_create("KeyIterate");
+   tcase_add_test(tc_persKeyIterate, test_KeyIterate);
+   tcase_set_timeout(tc_persKeyIterate, 3);
+
+   TCase * tc_persDbHandleEviction = tcase_create("DbHandleEviction");
+   tcase_add_test(tc_persDbHandleEviction, test_DbHandleEviction);
+   tcase_set_timeout(tc_persDbHandleEviction, 5);
+
+   TCase * tc_persKeyBatchDbHandles = tcase_create("KeyBatchDbHandles");
+   tcase_add_test(tc_persKeyBatchDbHandles, test_KeyBatchDbHandles);
+   tcase_set_timeout(tc_persKeyBatchDbHandles, 5);
+
+   TCase * tc_persKeySkipUnchanged = tcase_create("KeySkipUnchanged");
+   tcase_add_test(tc_persKeySkipUnchanged, test_KeySkipUnchanged);
+   tcase_set_timeout(tc_persKeySkipUnchanged, 5);
+
+   TCase * tc_persDbPrewarm = tcase_create("DbPrewarm");
+   tcase_add_test(tc_persDbPrewarm, test_DbPrewarm);
+   tcase_set_timeout(tc_persDbPrewarm, 5);
+
+   TCase * tc_persBootManifest = tcase_create("BootManifest");
+   tcase_add_test(tc_persBootManifest, test_BootManifest);
+   tcase_set_timeout(tc_persBootManifest, 5);
+
+   TCase * tc_persReadCache = tcase_create("ReadCache");
+   tcase_add_test(tc_persReadCache, test_ReadCache);
+   tcase_set_timeout(tc_persReadCache, 5);
+
+   TCase * tc_persRctIndex = tcase_create("RctIndex");
+   tcase_add_test(tc_persRctIndex, test_RctIndex);
+   tcase_set_timeout(tc_persRctIndex, 5);
+
+   TCase * tc_persRctIndexFile = tcase_create("RctIndexFile");
+   tcase_add_test(tc_persRctIndexFile, test_RctIndexFile);
+   tcase_set_timeout(tc_persRctIndexFile, 5);
+
+   TCase * tc_persTlsResolvedCache = tcase_create("TlsResolvedCache");
+   tcase_add_test(tc_persTlsResolvedCache, test_TlsResolvedCache);
+   tcase_set_timeout(tc_persTlsResolvedCache, 10);
+
+   TCase * tc_persNotificationQueue = tcase_create("NotificationQueue");
+   tcase_add_test(tc_persNotificationQueue, test_NotificationQueue);
+   tcase_set_timeout(tc_persNotificationQueue, 20);
+
+   TCase * tc_persNotifyCoalescing = tcase_create("NotifyCoalescing");
+   tcase_add_test(tc_persNotifyCoalescing, test_NotifyCoalescing);
+   tcase_set_timeout(tc_persNotifyCoalescing, 10);
+
+   TCase * tc_persNotifyBatchSignal = tcase_create("NotifyBatchSignal");
+   tcase_add_test(tc_persNotifyBatchSignal, test_NotifyBatchSignal);
+   tcase_set_timeout(tc_persNotifyBatchSignal, 10);
+
+   TCase * tc_persDbPathKeyTemplates = tcase_create("DbPathKeyTemplates");
+   tcase_add_test(tc_persDbPathKeyTemplates, test_DbPathKeyTemplates);
+   tcase_set_timeout(tc_persDbPathKeyTemplates, 5);
+
+   TCase * tc_persRctNegativeCache = tcase_create("RctNegativeCache");
+   tcase_add_test(tc_persRctNegativeCache, test_RctNegativeCache);
+   tcase_set_timeout(tc_persRctNegativeCache, 10);
+
+   TCase * tc_persRctManyGroups = tcase_create("RctManyGroups");
+   tcase_add_test(tc_persRctManyGroups, test_RctManyGroups);
+   tcase_set_timeout(tc_persRctManyGroups, 10);
+
    TCase * tc_persSetData = tcase_create("SetData");
    tcase_add_test(tc_persSetData, test_SetData);
    tcase_set_timeout(tc_persSetData, 3);
@@ -1844,6 +3213,10 @@ static Suite * persistenceClientLib_suite()
    tcase_add_test(tc_WriteConfDefault, test_WriteConfDefault);
    tcase_set_timeout(tc_WriteConfDefault, 3);
 
+   TCase * tc_DefaultKeyFilter = tcase_create("DefaultKeyFilter");
+   tcase_add_test(tc_DefaultKeyFilter, test_DefaultKeyFilter);
+   tcase_set_timeout(tc_DefaultKeyFilter, 3);
+
    TCase * tc_InitDeinit = tcase_create("InitDeinit");
    tcase_add_test(tc_InitDeinit, test_InitDeinit);
    tcase_set_timeout(tc_InitDeinit, 3);
@@ -1917,6 +3290,63 @@ static Suite * persistenceClientLib_suite()
    suite_add_tcase(s, tc_persGetData);
    tcase_add_checked_fixture(tc_persGetData, data_setup, data_teardown);
 
+   suite_add_tcase(s, tc_persKeyBatch);
+   tcase_add_checked_fixture(tc_persKeyBatch, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persKeyTransaction);
+   tcase_add_checked_fixture(tc_persKeyTransaction, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persKeyWriteAsync);
+   tcase_add_checked_fixture(tc_persKeyWriteAsync, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persKeyIterate);
+   tcase_add_checked_fixture(tc_persKeyIterate, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persDbHandleEviction);
+   tcase_add_checked_fixture(tc_persDbHandleEviction, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persKeyBatchDbHandles);
+   tcase_add_checked_fixture(tc_persKeyBatchDbHandles, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persKeySkipUnchanged);
+   tcase_add_checked_fixture(tc_persKeySkipUnchanged, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persDbPrewarm);
+   tcase_add_checked_fixture(tc_persDbPrewarm, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persBootManifest);
+   tcase_add_checked_fixture(tc_persBootManifest, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persReadCache);
+   tcase_add_checked_fixture(tc_persReadCache, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persRctIndex);
+   tcase_add_checked_fixture(tc_persRctIndex, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persRctIndexFile);
+   tcase_add_checked_fixture(tc_persRctIndexFile, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persTlsResolvedCache);
+   tcase_add_checked_fixture(tc_persTlsResolvedCache, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persNotificationQueue);
+   tcase_add_checked_fixture(tc_persNotificationQueue, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persNotifyCoalescing);
+   tcase_add_checked_fixture(tc_persNotifyCoalescing, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persNotifyBatchSignal);
+   tcase_add_checked_fixture(tc_persNotifyBatchSignal, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persDbPathKeyTemplates);
+   tcase_add_checked_fixture(tc_persDbPathKeyTemplates, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persRctNegativeCache);
+   tcase_add_checked_fixture(tc_persRctNegativeCache, data_setup, data_teardown);
+
+   suite_add_tcase(s, tc_persRctManyGroups);
+   tcase_add_checked_fixture(tc_persRctManyGroups, data_setup, data_teardown);
+
    suite_add_tcase(s, tc_persGetDataHandle);
    tcase_add_checked_fixture(tc_persGetDataHandle, data_setup, data_teardown);
 
@@ -1941,6 +3371,9 @@ static Suite * persistenceClientLib_suite()
    suite_add_tcase(s, tc_WriteConfDefault);
    tcase_add_checked_fixture(tc_WriteConfDefault, data_setup, data_teardown);
 
+   suite_add_tcase(s, tc_DefaultKeyFilter);
+   tcase_add_checked_fixture(tc_DefaultKeyFilter, data_setup, data_teardown);
+
    suite_add_tcase(s, tc_NegHandle);
    tcase_add_checked_fixture(tc_NegHandle, data_setup, data_teardown);
 
@@ -0,0 +1,251 @@
+/******************************************************************************
+ * This Source Code Form is subject to the terms of the
+ * Mozilla Public License, v. 2.0. If a  copy of the MPL was not distributed
+ * with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+******************************************************************************/
+/**
+ * @file           persistence_rct_compiler.c
+ * @ingroup        Persistence client library tools
+ * @brief          Compiles a resource configuration table into the index file the
+ *                 persistence client library maps read-only instead of reading the
+ *                 table resource by resource. The index must be compiled again after
+ *                 the table has been changed, a stale index is ignored by the library.
+ * @see
+ */
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+
+#include <dlt.h>
+#include <dlt_common.h>
+
+#include <persComRct.h>
+
+#include "persistence_client_library_rct_index.h"
+
+
+/// debug log and trace (DLT) setup, used by the index functions of the library
+DLT_DECLARE_CONTEXT(gPclDLTContext)
+
+#define STRING_SIZE    512
+
+
+void printAppManual()
+{
+   printf("\nPersistence RCT index compiler - Usage:\n");
+   printf("   persistence_rct_compiler -i <rct file> [-o <index file>] [-v]\n\n");
+   printf("   -i <rct file>   - the resource configuration table, e.g. /Data/mnt-wt/<app>/resource-table-cfg.itz\n");
+   printf("   -o <index file> - the index file, default is the rct file name followed by \"%s\"\n", gRctIndexSuffix);
+   printf("                     the library only uses the index if it is located next to the rct file\n");
+   printf("   -v              - print the resources of the index\n\n");
+}
+
+
+
+/**
+ * @brief read all resources of a resource configuration table and create the index
+ *
+ * @return the index or NULL on error
+ */
+PersRctIndex_s* compileIndex(const char* rctFilename, int verbose)
+{
+   PersRctIndex_s* index = NULL;
+   int handle = persComRctOpen(rctFilename, 0x0);   // don't create rct if not present
+
+   if(handle >= 0)
+   {
+      int listSize = persComRctGetSizeResourcesList(handle);
+      char* list = (listSize > 0) ? malloc((size_t)listSize + 1) : NULL;
+
+      if(list != NULL && persComRctGetResourcesList(handle, list, listSize) > 0)
+      {
+         unsigned int count = 0, numRead = 0;
+         const char** names = NULL;
+         PersistenceConfigurationKey_s* configs = NULL;
+         int pos = 0;
+
+         list[listSize] = '\0';
+         for(pos = 0; pos < listSize; pos += (int)strlen(&list[pos]) + 1)
+         {
+            count++;
+         }
+
+         names   = malloc(count * sizeof(const char*));
+         configs = malloc(count * sizeof(PersistenceConfigurationKey_s));
+         if(names != NULL && configs != NULL)
+         {
+            for(pos = 0; pos < listSize; pos += (int)strlen(&list[pos]) + 1)
+            {
+               if(list[pos] == '\0')
+               {
+                  continue;
+               }
+
+               if(persComRctRead(handle, &list[pos], &configs[numRead]) == (int)sizeof(PersistenceConfigurationKey_s))
+               {
+                  if(verbose == 1)
+                  {
+                     printf("RCT[%u] : \"%s\"\n", numRead, &list[pos]);
+                  }
+                  names[numRead++] = &list[pos];
+               }
+               else
+               {
+                  printf("Failed to read resource: \"%s\"\n", &list[pos]);
+               }
+            }
+
+            index = rct_index_create(names, configs, numRead);
+            if(index == NULL)
+            {
+               printf("Failed to create the index of %u resources\n", numRead);
+            }
+         }
+         free(names);
+         free(configs);
+      }
+      else
+      {
+         printf("Failed to read the resource list of: %s\n", rctFilename);
+      }
+
+      free(list);
+      persComRctClose(handle);
+   }
+   else
+   {
+      printf("Failed to open RCT: %s - error: %d\n", rctFilename, handle);
+   }
+
+   return index;
+}
+
+
+
+/**
+ * @brief write the index to a temporary file and rename it,
+ *        processes mapping the previous index keep their mapping
+ *
+ * @return 0 on success, -1 on error
+ */
+int writeIndex(const PersRctIndex_s* index, const char* indexFilename)
+{
+   char tmpFilename[STRING_SIZE] = {0};
+   int ret = -1;
+   int fd = -1;
+
+   snprintf(tmpFilename, STRING_SIZE, "%s.tmp", indexFilename);
+
+   fd = open(tmpFilename, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+   if(fd != -1)
+   {
+      const char* data = (const char*)index;
+      size_t written = 0;
+
+      while(written < index->size)
+      {
+         ssize_t rval = write(fd, data + written, index->size - written);
+         if(rval <= 0)
+         {
+            if(rval == -1 && errno == EINTR)
+            {
+               continue;
+            }
+            break;
+         }
+         written += (size_t)rval;
+      }
+
+      if(written == index->size && fsync(fd) == 0)
+      {
+         ret = 0;
+      }
+      close(fd);
+
+      if(ret == 0 && rename(tmpFilename, indexFilename) != 0)
+      {
+         ret = -1;
+      }
+      if(ret != 0)
+      {
+         printf("Failed to write index: %s - error: %s\n", indexFilename, strerror(errno));
+         (void)remove(tmpFilename);
+      }
+   }
+   else
+   {
+      printf("Failed to create index: %s - error: %s\n", tmpFilename, strerror(errno));
+   }
+
+   return ret;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+   int opt = 0, verbose = 0, ret = 0;
+   char rctFilename[STRING_SIZE] = {0};
+   char indexFilename[STRING_SIZE] = {0};
+
+   /// debug log and trace (DLT) setup
+   DLT_REGISTER_APP("PCLc","compiles the persistence resource configuration table index");
+
+   DLT_REGISTER_CONTEXT(gPclDLTContext,"PCLc","Context for the persistence resource configuration table index compiler");
+
+   while ((opt = getopt(argc, argv, "i:o:v")) != -1)
+   {
+      switch (opt)
+      {
+         case 'i':
+            strncpy(rctFilename, optarg, STRING_SIZE-1);
+            break;
+         case 'o':
+            strncpy(indexFilename, optarg, STRING_SIZE-1);
+            break;
+         case 'v':
+            verbose = 1;
+            break;
+         default: /* '?' */
+            ret = -1;
+      }
+   }
+
+   if(rctFilename[0] == '\0' || ret != 0)
+   {
+      printAppManual();
+      ret = -1;
+   }
+   else
+   {
+      PersRctIndex_s* index = NULL;
+
+      if(indexFilename[0] == '\0')
+      {
+         snprintf(indexFilename, STRING_SIZE, "%s%s", rctFilename, gRctIndexSuffix);
+      }
+
+      index = compileIndex(rctFilename, verbose);
+      if(index != NULL && rct_index_stamp(index, rctFilename) == 0 && writeIndex(index, indexFilename) == 0)
+      {
+         printf("Index: %s - resources: %u - size: %u bytes\n", indexFilename, index->numEntries, index->size);
+      }
+      else
+      {
+         ret = -1;
+      }
+      free(index);
+   }
+
+   // unregister debug log and trace
+   DLT_UNREGISTER_CONTEXT(gPclDLTContext);
+   DLT_UNREGISTER_APP();
+
+   dlt_free();
+
+   return ret;
+}